@@ -1,6 +1,7 @@
 import numpy as np
 from matplotlib import pyplot as plt
 from matplotlib.animation import FuncAnimation
+from sweep_trace import SweepTrace, CIRCLE_EVENT
 
 plt.style.use("bmh")
 plt.rc("font", family="Barlow", size=13)
@@ -21,66 +22,58 @@ def find_intersections(v1, v2, d):
     return intersections
 
 
-with open('dump', 'r') as file:
-    dump = file.read()
+# Written by `main --animate`. The edges are pairs of indices into the vertices.
+dump = np.load('dump.npz')
+sites = dump['sites']
+verts = dump['vertices']
+edges = dump['edges']
+v1 = verts[edges[:, 0]]
+v2 = verts[edges[:, 1]]
 
-sites = None
-verts = None
-v1 = None
-v2 = None
-exec(dump)
-# sites, verts, v1, v2
+# Also written by `main --animate`, one frame per event of the sweep
+trace = SweepTrace('sweep.trace')
+site_rows = {site_id: row for row, site_id in enumerate(trace.site_ids)}
 
 all_points = np.vstack([sites, verts])
 top_right = np.max(all_points, axis=0)
 bottom_left = np.min(all_points, axis=0)
 
-# print(top_right, bottom_left)
-
-frames = 150
-step = (top_right[1] - bottom_left[1])/frames
-# print(step)
+frames = len(trace)
 fig = plt.figure(figsize=(8, 8))
 h = 1024
 dx = (top_right[0] - bottom_left[0]) / (h - 1)
 def main(i):
     plt.cla()
     xs = np.linspace(bottom_left[0], top_right[0], h)
-    sweepline = top_right[1] - i * step
+    sweepline = trace.positions[i, 1]
 
     plt.scatter(sites[:, 0], sites[:, 1], s=30, c='#88f')
-    accumulator = np.full_like(xs, np.inf)
-
-    first = False
-    for site in sites:
-        if (site[1] < sweepline): continue
-        first = True
 
-        functional = (lambda x: point_directrix_parabola(x, site, sweepline))
-        result = functional(xs)
+    # The beach line is the lower envelope of the parabolas of the sites that still have an arc on it
+    accumulator = np.full_like(xs, np.inf)
+    arc_sites = trace.sites[[site_rows[site_id] for site_id in set(trace.beach_line_after(i))]]
+    for site in arc_sites:
+        if site[1] <= sweepline: continue
+        result = point_directrix_parabola(xs, site, sweepline)
         plt.plot(xs, result, c="#333", ls="--", lw="1")
-        accumulator = np.vstack([accumulator, result])
-
-    minimal = np.min(accumulator, axis=0)
+        accumulator = np.minimum(accumulator, result)
 
-    if first:
-        for start, end in zip(v1, v2):
-            ix = int((start[0] - bottom_left[0]) / dx)
-            if (start[1] < minimal[ix]): continue
-            plt.plot([start[0], end[0]], [start[1], end[1]], c="#b33", lw=2)
+    for start, end in zip(v1, v2):
+        ix = int((start[0] - bottom_left[0]) / dx)
+        if (start[1] < accumulator[ix]): continue
+        plt.plot([start[0], end[0]], [start[1], end[1]], c="#b33", lw=2)
 
-        for s in sites:
-            ix = int((s[0] - bottom_left[0]) / dx)
-            if (s[1] < minimal[ix]): continue
-            plt.scatter([s[0]], [s[1]], c='k')
+    plt.scatter(arc_sites[:, 0], arc_sites[:, 1], c='k')
 
-        for v in verts:
-            ix = int((v[0] - bottom_left[0]) / dx)
-            if (v[1] < minimal[ix]): continue
-            plt.scatter([v[0]], [v[1]], c='#911', s=40)
+    found = trace.vertices[:trace.num_vertices[i]]
+    plt.scatter(found[:, 0], found[:, 1], c='#911', s=40)
 
-        plt.plot(xs, minimal, c='k', lw=2)
+    if trace.kinds[i] == CIRCLE_EVENT:
+        center = trace.centers[i]
+        radius = center[1] - sweepline
+        plt.gca().add_patch(plt.Circle(center, radius, fill=False, ec='#2a2', lw=1.5))
 
+    plt.plot(xs, accumulator, c='k', lw=2)
 
     plt.axhline(sweepline, c='#22c', lw=2.5)
 
@@ -88,4 +81,4 @@ def main(i):
     plt.ylim(bottom_left[1], top_right[1])
 
 animation = FuncAnimation(fig, main, frames=frames, interval=1000/15, repeat=True)
-plt.show()
\ No newline at end of file
+plt.show()
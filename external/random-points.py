@@ -1,5 +1,11 @@
+import sys
 import numpy as np
 
 points = np.random.uniform(-7, 7, (20, 2))
-points_list = list(map(tuple, points))
-for p in points_list: print(p)
\ No newline at end of file
+
+# With a path, save the points as a .npy file that main reads directly
+if len(sys.argv) > 1:
+    np.save(sys.argv[1], points)
+else:
+    points_list = list(map(tuple, points))
+    for p in points_list: print(p)
@@ -0,0 +1,119 @@
+import struct
+import numpy as np
+
+# Reader for the sweep traces written by `main --trace` (and `main --animate`), see fortune/SweepTrace.hpp for the
+# layout. Every event the sweep takes off its queue is recorded, and the beach line can be replayed up to any of them.
+
+MAGIC = b"VVTRACE\0"
+VERSION = 1
+
+EVENT, VERTEX, BEACH_LINE, END = 1, 2, 3, 4
+SITE_EVENT, CIRCLE_EVENT, INVALIDATED_EVENT = 0, 1, 2
+
+
+class SweepTrace:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        self.pos = 0
+
+        if self._take(8) != MAGIC:
+            raise ValueError(f"Not a sweep trace: {path}")
+        version, flags, num_sites = self._unpack("<IIQ")
+        if version != VERSION or flags != 0:
+            raise ValueError(f"Unsupported sweep trace: {path}")
+
+        site_dtype = np.dtype([("x", "<f8"), ("y", "<f8"), ("id", "<i4")])
+        sites = np.frombuffer(self.data, site_dtype, num_sites, self.pos)
+        self.pos += site_dtype.itemsize * num_sites
+        # (x, y) rows, and the identifiers the beach line refers to
+        self.sites = np.column_stack([sites["x"], sites["y"]])
+        self.site_ids = sites["id"].copy()
+
+        # kind, (x, y) of the event, with the sweep line at y, and the circle center (nan for site events)
+        self.kinds = []
+        self.positions = []
+        self.centers = []
+        # Vertices offered up to and including each event
+        self.num_vertices = []
+        vertices = []
+        # Per event, None or (start, removed, inserted site identifiers)
+        self.splices = []
+
+        while True:
+            tag = self._take(1)[0]
+            if tag == EVENT:
+                kind = self._take(1)[0]
+                x, y = self._unpack("<dd")
+                center = self._unpack("<dd") if kind != SITE_EVENT else (np.nan, np.nan)
+                self.kinds.append(kind)
+                self.positions.append((x, y))
+                self.centers.append(center)
+                self.num_vertices.append(len(vertices))
+                self.splices.append(None)
+            elif tag == VERTEX:
+                x, y = self._unpack("<dd")
+                vertices.append((x, y, self._varint()))
+                self.num_vertices[-1] += 1
+            elif tag == BEACH_LINE:
+                start, removed, count = self._varint(), self._varint(), self._varint()
+                inserted = [self._zigzag() for _ in range(count)]
+                self.splices[-1] = (start, removed, inserted)
+            elif tag == END:
+                if self._varint() != len(self.kinds):
+                    raise ValueError(f"Wrong event count in sweep trace: {path}")
+                break
+            else:
+                raise ValueError(f"Unknown record in sweep trace: {path}")
+
+        self.kinds = np.array(self.kinds, dtype=np.uint8)
+        self.positions = np.array(self.positions, dtype=np.float64).reshape(-1, 2)
+        self.centers = np.array(self.centers, dtype=np.float64).reshape(-1, 2)
+        self.num_vertices = np.array(self.num_vertices, dtype=np.int64)
+        # (x, y) rows, and their labels
+        self.vertices = np.array([v[:2] for v in vertices], dtype=np.float64).reshape(-1, 2)
+        self.vertex_labels = np.array([v[2] for v in vertices], dtype=np.int64)
+
+        self._beach_line = []
+        self._replayed = -1
+        del self.data
+
+    def __len__(self):
+        return len(self.kinds)
+
+    def beach_line_after(self, event):
+        """Site identifiers of the arcs on the beach line right after the event, left to right"""
+        if not 0 <= event < len(self):
+            raise IndexError(event)
+        if self._replayed > event:
+            self._beach_line, self._replayed = [], -1
+        while self._replayed < event:
+            self._replayed += 1
+            splice = self.splices[self._replayed]
+            if splice is not None:
+                start, removed, inserted = splice
+                self._beach_line[start:start + removed] = inserted
+        return list(self._beach_line)
+
+    def _take(self, n):
+        if self.pos + n > len(self.data):
+            raise ValueError("Truncated sweep trace")
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def _unpack(self, fmt):
+        return struct.unpack(fmt, self._take(struct.calcsize(fmt)))
+
+    def _varint(self):
+        value, shift = 0, 0
+        while True:
+            byte = self._take(1)[0]
+            value |= (byte & 0x7f) << shift
+            if not byte & 0x80:
+                return value
+            shift += 7
+
+    def _zigzag(self):
+        value = self._varint()
+        return (value >> 1) ^ -(value & 1)
@@ -0,0 +1,125 @@
+import ctypes
+import os
+import numpy as np
+
+# In-process binding of libvoronoi.so (`make lib`) over ctypes, see include/api/voronoi.h for the C side. The sites
+# are passed by pointer and stride, so any float64 (n, 2) array or pair of columns goes in without a copy.
+
+OK, ERROR_INVALID_ARGUMENT, ERROR_COMPUTE, ERROR_BUFFER_TOO_SMALL, ERROR_NO_DIAGRAM = 0, 1, 2, 3, 4
+VORONOI, DELAUNAY = 0, 1
+
+_f64, _i32, _u8 = ctypes.POINTER(ctypes.c_double), ctypes.POINTER(ctypes.c_int32), ctypes.POINTER(ctypes.c_uint8)
+
+# Name, ctypes pointer, NumPy dtype and count field of each array, in the order of the C structs
+ARRAYS = [
+    ("vertexX", _f64, np.float64, "numVertices"),
+    ("vertexY", _f64, np.float64, "numVertices"),
+    ("vertexLabel", _i32, np.int32, "numVertices"),
+    ("vertexIncidentEdge", _i32, np.int32, "numVertices"),
+    ("vertexIsBoundary", _u8, np.uint8, "numVertices"),
+    ("edgeOrigin", _i32, np.int32, "numHalfEdges"),
+    ("edgeNext", _i32, np.int32, "numHalfEdges"),
+    ("edgePrev", _i32, np.int32, "numHalfEdges"),
+    ("edgeFace", _i32, np.int32, "numHalfEdges"),
+    ("edgeUnbounded", _u8, np.uint8, "numHalfEdges"),
+    ("faceLabel", _i32, np.int32, "numFaces"),
+    ("faceOuter", _i32, np.int32, "numFaces"),
+    ("faceInner", _i32, np.int32, "numFaces"),
+    ("faceUnbounded", _u8, np.uint8, "numFaces"),
+]
+COUNTS = [("numVertices", ctypes.c_int32), ("numHalfEdges", ctypes.c_int32), ("numFaces", ctypes.c_int32)]
+
+
+class DCELView(ctypes.Structure):
+    _fields_ = COUNTS + [(name, pointer) for name, pointer, _, _ in ARRAYS] + [
+        ("bottomLeftX", ctypes.c_double), ("bottomLeftY", ctypes.c_double),
+        ("topRightX", ctypes.c_double), ("topRightY", ctypes.c_double),
+    ]
+
+
+class DCELBuffers(ctypes.Structure):
+    _fields_ = COUNTS + [(name, pointer) for name, pointer, _, _ in ARRAYS]
+
+
+class VoronoiError(RuntimeError):
+    def __init__(self, code, message):
+        super().__init__(message)
+        self.code = code
+
+
+def _load(path):
+    lib = ctypes.CDLL(path)
+    lib.voronoiCreateContext.restype = ctypes.c_void_p
+    lib.voronoiDestroyContext.argtypes = [ctypes.c_void_p]
+    lib.voronoiComputeStrided.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int64,
+                                          ctypes.c_int64, ctypes.c_int64]
+    lib.voronoiGetDiagram.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(DCELView)]
+    lib.voronoiCopyDiagram.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(DCELBuffers)]
+    lib.voronoiLastError.argtypes = [ctypes.c_void_p]
+    lib.voronoiLastError.restype = ctypes.c_char_p
+    return lib
+
+
+class Voronoi:
+    """One context of the library. Not to be shared between threads."""
+
+    def __init__(self, library=os.path.join(os.path.dirname(__file__), "..", "libvoronoi.so")):
+        self.lib = _load(library)
+        self.context = self.lib.voronoiCreateContext()
+        if not self.context:
+            raise MemoryError("Cannot create a Voronoi context")
+
+    def close(self):
+        if self.context:
+            self.lib.voronoiDestroyContext(self.context)
+            self.context = None
+
+    def __del__(self):
+        self.close()
+
+    def compute(self, x, y=None):
+        """Sites as an (n, 2) array, or as separate x and y columns, of float64. Coincident sites raise VoronoiError."""
+        if y is None:
+            points = np.asarray(x)
+            x, y = points[:, 0], points[:, 1]
+        x, y = np.asarray(x), np.asarray(y)
+        if x.dtype != np.float64 or y.dtype != np.float64 or x.ndim != 1 or x.shape != y.shape:
+            raise ValueError("Sites must be float64 columns of the same length")
+        self._check(self.lib.voronoiComputeStrided(self.context, x.ctypes.data, y.ctypes.data, len(x),
+                                                   x.strides[0], y.strides[0]))
+
+    def view(self, diagram=VORONOI):
+        """Arrays of the diagram, read in place from the library. Only valid until the next compute()."""
+        view = DCELView()
+        self._check(self.lib.voronoiGetDiagram(self.context, diagram, ctypes.byref(view)))
+        arrays = {}
+        for name, _, dtype, count in ARRAYS:
+            size = getattr(view, count)
+            pointer = getattr(view, name)
+            arrays[name] = np.ctypeslib.as_array(pointer, (size,)) if size > 0 else np.empty(0, dtype)
+        return arrays
+
+    def copy(self, diagram=VORONOI, out=None):
+        """Arrays of the diagram, copied into the given dict of arrays, or into new ones"""
+        if out is None:
+            sizes = self.view(diagram)
+            out = {name: np.empty(len(sizes[name]), dtype) for name, _, dtype, _ in ARRAYS}
+        buffers = DCELBuffers()
+        # The smallest array of each kind bounds the capacity, and kinds without arrays are unbounded
+        capacities = {count: 2 ** 31 - 1 for count, _ in COUNTS}
+        for name, pointer, dtype, count in ARRAYS:
+            array = out.get(name)
+            if array is None:
+                continue
+            if array.dtype != dtype or not array.flags.c_contiguous or not array.flags.writeable:
+                raise ValueError(f"{name} must be a writeable contiguous {np.dtype(dtype).name} array")
+            setattr(buffers, name, array.ctypes.data_as(pointer))
+            capacities[count] = min(capacities[count], len(array))
+        for count, capacity in capacities.items():
+            setattr(buffers, count, capacity)
+        self._check(self.lib.voronoiCopyDiagram(self.context, diagram, ctypes.byref(buffers)))
+        return out
+
+    def _check(self, code):
+        if code != OK:
+            raise VoronoiError(code, self.lib.voronoiLastError(self.context).decode())
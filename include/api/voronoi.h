@@ -0,0 +1,146 @@
+#ifndef VORONOI_VIZ_VORONOI_H
+#define VORONOI_VIZ_VORONOI_H
+
+/*
+ * C interface of the headless shared library, libvoronoi.so (`make lib`), for calling the sweep in-process through
+ * FFI, from ctypes/cffi or cgo. Failures are never thrown, printed, or exited on: every call returns one of the
+ * VORONOI_* codes, and the message of the last failure is kept in the context.
+ *
+ * The sweep asserts its own invariants, and `make lib` keeps the asserts. Input that is known to break them, such as
+ * coincident sites, is rejected with VORONOI_ERROR_INVALID_ARGUMENT before sweeping, so an assert that still fails is
+ * a bug of the library, and aborts the process.
+ *
+ * Coordinates are read straight out of the caller's buffers, through a byte stride per axis, so both interleaved
+ * x, y pairs and separate arrays (or columns of a record array) work without repacking. Sites are numbered 1, 2, 3...
+ * in input order, and those numbers are the face labels of the Voronoi diagram and the vertex labels of the Delaunay
+ * triangulation.
+ *
+ * The diagrams come out as the struct-of-arrays DCEL of the library. The twin of half-edge i is i ^ 1, and -1 stands
+ * for a missing reference. They can be borrowed in place, or copied into buffers of the caller.
+ *
+ * A context reuses its buffers from one diagram to the next. Separate contexts can be used from separate threads,
+ * but a context must not be used from two threads at once.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define VORONOI_API __attribute__((visibility("default")))
+#else
+#define VORONOI_API
+#endif
+
+#define VORONOI_OK 0
+#define VORONOI_ERROR_INVALID_ARGUMENT 1
+/* The sweep threw on the input, or ran out of memory */
+#define VORONOI_ERROR_COMPUTE 2
+/* The buffers can't hold the diagram. The counts of the buffers were set to the sizes needed. */
+#define VORONOI_ERROR_BUFFER_TOO_SMALL 3
+/* Nothing has been computed yet, or the last computation failed */
+#define VORONOI_ERROR_NO_DIAGRAM 4
+
+#define VORONOI_DIAGRAM_VORONOI 0
+#define VORONOI_DIAGRAM_DELAUNAY 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct VoronoiContext VoronoiContext;
+
+/* Arrays of a diagram, owned by the context. They stay valid until the next computation or the context is destroyed. */
+typedef struct VoronoiDCELView {
+    int32_t numVertices;
+    int32_t numHalfEdges;
+    int32_t numFaces;
+
+    const double* vertexX;
+    const double* vertexY;
+    const int32_t* vertexLabel;
+    const int32_t* vertexIncidentEdge;
+    const uint8_t* vertexIsBoundary;
+
+    const int32_t* edgeOrigin;
+    const int32_t* edgeNext;
+    const int32_t* edgePrev;
+    const int32_t* edgeFace;
+    const uint8_t* edgeUnbounded;
+
+    const int32_t* faceLabel;
+    const int32_t* faceOuter;
+    const int32_t* faceInner;
+    const uint8_t* faceUnbounded;
+
+    /* Bounding box the diagram was clipped to */
+    double bottomLeftX;
+    double bottomLeftY;
+    double topRightX;
+    double topRightY;
+} VoronoiDCELView;
+
+/*
+ * Arrays of the caller to copy a diagram into. Arrays left NULL are skipped. On input the counts are the capacities
+ * of the arrays, in elements, and on output the sizes of the diagram.
+ */
+typedef struct VoronoiDCELBuffers {
+    int32_t numVertices;
+    int32_t numHalfEdges;
+    int32_t numFaces;
+
+    double* vertexX;
+    double* vertexY;
+    int32_t* vertexLabel;
+    int32_t* vertexIncidentEdge;
+    uint8_t* vertexIsBoundary;
+
+    int32_t* edgeOrigin;
+    int32_t* edgeNext;
+    int32_t* edgePrev;
+    int32_t* edgeFace;
+    uint8_t* edgeUnbounded;
+
+    int32_t* faceLabel;
+    int32_t* faceOuter;
+    int32_t* faceInner;
+    uint8_t* faceUnbounded;
+} VoronoiDCELBuffers;
+
+/* NULL if out of memory */
+VORONOI_API VoronoiContext* voronoiCreateContext(void);
+
+VORONOI_API void voronoiDestroyContext(VoronoiContext* context);
+
+/*
+ * Computes the Voronoi diagram and the Delaunay triangulation of count sites, the i-th of which is at the doubles
+ * x + i * xStride and y + i * yStride bytes. Strides can be negative, and need not be multiples of 8, like the
+ * strides of NumPy arrays. Needs at least 2 sites, all finite, and no two of them closer than 1e-7 on both axes.
+ */
+VORONOI_API int voronoiComputeStrided(
+    VoronoiContext* context,
+    const double* x,
+    const double* y,
+    int64_t count,
+    int64_t xStride,
+    int64_t yStride
+);
+
+/* Same as above, for count interleaved x, y pairs */
+VORONOI_API int voronoiComputeInterleaved(VoronoiContext* context, const double* xy, int64_t count);
+
+/* Borrows the arrays of one of the VORONOI_DIAGRAM_* diagrams of the last computation */
+VORONOI_API int voronoiGetDiagram(const VoronoiContext* context, int diagram, VoronoiDCELView* view);
+
+/* Copies one of the VORONOI_DIAGRAM_* diagrams of the last computation into the buffers */
+VORONOI_API int voronoiCopyDiagram(const VoronoiContext* context, int diagram, VoronoiDCELBuffers* buffers);
+
+/* Message of the last failure of a call on the context, or an empty string. Valid until the next call. */
+VORONOI_API const char* voronoiLastError(const VoronoiContext* context);
+
+#ifdef __cplusplus
+}
+
+void voronoiApiTest1();
+#endif
+
+#endif /* VORONOI_VIZ_VORONOI_H */
@@ -0,0 +1,12 @@
+#ifndef VORONOI_VIZ_BENCHMARKS_HPP
+#define VORONOI_VIZ_BENCHMARKS_HPP
+
+void runAllBenchmarks();
+
+// The sweep logs every event to stdout, which would dominate its timings. These redirect stdout to /dev/null around
+// the timed part of a benchmark.
+void muteStdout();
+
+void unmuteStdout();
+
+#endif
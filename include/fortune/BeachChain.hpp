@@ -34,6 +34,7 @@ public:
     Vec2* leftSite {nullptr};
     Vec2* rightSite {nullptr};
 
+    // Same lifetime as Vec2::toString()
     [[nodiscard]] const char* toString() const;
 
 };
@@ -42,10 +43,6 @@ class TreeValueFacade {
 public:
     VertexPair* breakpointEdge = nullptr;
     Event* circleEvent = nullptr;
-
-    static TreeValueFacade* breakpointPtr(VertexPair* ptr = nullptr);
-
-    static TreeValueFacade* arcPtr(Event* ptr = nullptr);
 };
 
 struct ChainComparator {
@@ -2,6 +2,7 @@
 #ifndef VORONOI_VIZ_EVENT_HPP
 #define VORONOI_VIZ_EVENT_HPP
 
+#include <cstdint>
 #include "BeachChain.hpp"
 #include "utils/LinkedSplayTree.hpp"
 
@@ -19,6 +20,9 @@ public:
 
     bool isInvalidated = false;
 
+    // Position in the side table of the event queue that created it
+    int32_t index = -1;
+
     explicit Event(Vec2 site)
         : pos(site),
           isSiteEvent(true),
@@ -37,10 +41,30 @@ public:
 };
 
 
+// Hot part of an event, stored by value in the event queue. Everything else, like the circle center and the arc, stays
+// in the queue's side table, at the given index.
+struct EventRecord {
+    double y;
+    double x;
+    bool isSiteEvent;
+    int32_t index;
+};
+
+
 struct EventComparator {
-    bool operator()(Event* a, Event* b) const;
+    bool operator()(const Event* a, const Event* b) const;
+
+    bool operator()(const Event &a, const Event &b) const;
+
+    bool operator()(const EventRecord &a, const EventRecord &b) const;
+
+    // Higher events first, then leftmost, then sites before circles
+    static bool precedes(double ay, double ax, bool aIsSite, double by, double bx, bool bIsSite);
 };
 
 
+void eventQueueBenchmark();
+
+
 #endif //VORONOI_VIZ_EVENT_HPP
 
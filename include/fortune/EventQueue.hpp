@@ -0,0 +1,53 @@
+#ifndef VORONOI_VIZ_EVENTQUEUE_HPP
+#define VORONOI_VIZ_EVENTQUEUE_HPP
+
+#include <deque>
+#include <vector>
+#include "Event.hpp"
+#include "utils/PriorityQueue.hpp"
+#include "utils/RadixHeap.hpp"
+
+void eventQueueTest1();
+
+// Event queue of the sweep. The sweep line only moves down, so events are mostly kept in a monotone radix heap keyed on
+// the bits of y. Events whose y is within NUMERICAL_TOLERANCE of the next one are moved into a small front heap, which
+// orders them by EventComparator, so ties are still broken on x and then site-before-circle.
+//
+// Both heaps hold EventRecords by value, so ordering never leaves the heap arrays. The events themselves are owned by
+// the queue, in a side table with stable addresses; they stay valid until the next clear().
+class EventQueue {
+public:
+    Event* createSiteEvent(Vec2 site);
+
+    Event* createCircleEvent(Vec2 circleBottom, Vec2 center, LinkedNode<BeachChain*, TreeValueFacade*>* arcNode);
+
+    // The event must have been created by this queue
+    void push(Event* event);
+
+    Event* peek();
+
+    Event* poll();
+
+    [[nodiscard]] bool empty() const;
+
+    [[nodiscard]] size_t size() const;
+
+    // Empties the queue, and destroys every event created since the last clear()
+    void clear();
+
+private:
+    std::deque<Event> events;
+
+    RadixHeap<EventRecord> far;
+    PriorityQueue<EventRecord, EventComparator> front;
+
+    // Records at or above this line belong to the front heap, while it is not empty
+    double windowBottom = 0;
+
+    static uint64_t key(const EventRecord &record);
+
+    // Opens a new front window if needed, and pulls every record of the radix heap that falls inside it
+    void fillFront();
+};
+
+#endif //VORONOI_VIZ_EVENTQUEUE_HPP
@@ -1,13 +1,17 @@
 #ifndef FORTUNE_HPP
 #define FORTUNE_HPP
 
+#include <deque>
 #include <vector>
 #include "utils/math/Vec2.hpp"
 #include "utils/PriorityQueue.hpp"
 #include "utils/LinkedSplayTree.hpp"
 #include "Event.hpp"
+#include "EventQueue.hpp"
 #include "BeachChain.hpp"
+#include "SweepPlanner.hpp"
 #include "geometry/DCEL.hpp"
+#include "utils/SiteBinary.hpp"
 
 typedef struct VanishingChains {
     LinkedNode<BeachChain*, TreeValueFacade*>* leftMerger;
@@ -17,15 +21,56 @@ typedef struct VanishingChains {
     bool cocircular;
 } VanishingChains;
 
+void fortuneSweeperTest1();
+
+void fortuneSweeperTest2();
+
+void fortuneSweeperTest3();
+
+void colinearFastPathTest1();
+
+void colinearFastPathTest2();
+
+void gridSweepBenchmark();
+
+class SweepTraceWriter;
+
+// Sweep engine. It keeps its own copy of the sites, and can be reused for many diagrams through reset(), which keeps
+// the capacity of the event queue and of the factory buffers.
 class FortuneSweeper {
 public:
-    const std::vector<Vec2> &sites;
+    std::vector<Vec2> sites;
 
     double sweepY;
+
+    // Events taken off the queue so far, including the ones handled along with another and the ones discarded in bulk
     int currentEventCounter = 0;
 
+    FortuneSweeper();
+
     explicit FortuneSweeper(const std::vector<Vec2> &sites);
 
+    ~FortuneSweeper();
+
+    FortuneSweeper(const FortuneSweeper &) = delete;
+
+    FortuneSweeper &operator=(const FortuneSweeper &) = delete;
+
+    // Throws std::invalid_argument if two sites share an identifier
+    void reset(const std::vector<Vec2> &newSites);
+
+    // Same as above, from a binary site file. Events and arcs point into the sweeper's own sites, so they are still
+    // copied out of the mapping; what is saved over text input is the parsing, not the copy.
+    void reset(const MappedSites &newSites);
+
+    // Takes effect from the next computeAll(). Sweepers start out with the default plan.
+    void setPlan(const SweepPlan &newPlan);
+
+    // Records the sweep of the current sites into the trace, from the next event on, or stops recording on nullptr.
+    // Attach it right after reset(). The trace is not owned, and its END is left to the caller. Recording walks the
+    // beach line after every event, which makes a traced sweep quadratic in the worst case.
+    void setTrace(SweepTraceWriter* newTrace);
+
     void stepNextEvent();
 
     DCEL* computeAll();
@@ -34,13 +79,50 @@ public:
 
     DCELFactory* factory;
 private:
-    PriorityQueue<Event*, EventComparator>* eventQueue;
+    EventQueue* eventQueue;
     LinkedSplayTree<BeachChain*, TreeValueFacade*, ChainComparator>* beachLine;
 
     Event* lastHandledEvent {nullptr};
 
+    SweepPlan plan;
+
+    SweepTraceWriter* trace {nullptr};
+
+    // Pool of the plan's thread count, when it is not the shared one
+    ThreadPool* ownedPool {nullptr};
+
+    // Buffers behind the VanishingChains of the circle event being handled, reused across events
+    std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> vanishingArcScratch;
+    std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> vanishingBpScratch;
+
+    // Beach line records of the current diagram. The tree links them without owning them, so they live here, with
+    // stable addresses, until restart() frees them all at once.
+    std::deque<BeachChain> chains;
+    std::deque<TreeValueFacade> chainValues;
+    std::deque<LinkedNode<BeachChain*, TreeValueFacade*>> chainNodes;
+
+    BeachChain* createArc(Vec2* focus);
+
+    BeachChain* createBreakpoint(Vec2* left, Vec2* right);
+
+    // Beach line node of the chain, with the edge traced by the chain if it is a breakpoint
+    LinkedNode<BeachChain*, TreeValueFacade*>* createNode(BeachChain* chain, VertexPair* breakpointEdge = nullptr);
+
+    // Clears the state of the previous diagram, and queues the site events of the current sites
+    void restart();
+
+    // Takes the next event off the queue, counts it, and records it in the trace. Every event goes through here.
+    Event* pollEvent();
+
     void handleSiteEvent(Event* event);
 
+    // Handles the first site, along with every other site sharing its y. Sites on that line can't intersect each
+    // other's arcs, so their beach line is built in one go instead of one site at a time. Returns the last site handled.
+    Event* handleTopSiteRun(Event* event);
+
+    // Creates the edge traced by the breakpoints between an arc and a new arc splitting it, and offers it to the factory
+    VertexPair* offerSplitEdge(Vec2* aboveFocus, Vec2* newFocus);
+
     // Returns the breakpoint running from the new Voronoi vertex
     LinkedNode<BeachChain*, TreeValueFacade*>*  handleCircleEvent(Event* event, bool skipEdgeCreation = false);
 
@@ -52,7 +134,11 @@ private:
 
     void beachLineToString(LinkedNode<BeachChain*, TreeValueFacade*>* node, int depth);
 
-    static VanishingChains getVanishingChains(
+    // Pops the invalidated circle events at the front of the queue
+    void discardInvalidatedEvents();
+
+    // The vectors in the result point to the scratch buffers of the sweeper, and are only valid until the next call
+    VanishingChains getVanishingChains(
         LinkedNode<BeachChain*, TreeValueFacade*>* arcNode,
         Vec2 eventPosition
     );
@@ -0,0 +1,159 @@
+#ifndef VORONOI_VIZ_SWEEPTRACE_HPP
+#define VORONOI_VIZ_SWEEPTRACE_HPP
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "utils/math/Vec2.hpp"
+#include "utils/OutputBuffer.hpp"
+#include "utils/LinkedSplayTree.hpp"
+#include "BeachChain.hpp"
+#include "Event.hpp"
+
+// Binary record of a sweep, one entry per event taken off the queue of FortuneSweeper, from which the state of the
+// beach line can be rebuilt at any event. Little-endian throughout, varints as written by OutputBuffer::putVarint:
+//
+//   header        magic "VVTRACE\0", uint32 version, uint32 flags (0), uint64 number of sites
+//   sites         float64 x, float64 y, int32 identifier, per site
+//   records       a tag byte, then:
+//     EVENT       uint8 kind, float64 x, float64 y of the event, and float64 x, y of the circle center for circle
+//                 events. The sweep line is at the y of the event.
+//     VERTEX      float64 x, float64 y, varint label of a Voronoi vertex offered by the event
+//     BEACH_LINE  varint start, varint removed count, varint inserted count, then the inserted arcs as zigzag varint
+//                 site identifiers: the arcs of the beach line, left to right, changed by the event
+//     END         varint number of events
+//
+// VERTEX and BEACH_LINE records belong to the EVENT before them. An event that leaves the beach line alone has no
+// BEACH_LINE record. Events handled in one step, such as the sites at the y of the first one, or a circle event that
+// coincides with a site, each get an EVENT, and what they did together belongs to the last of them. Invalidated
+// events dropped in bulk are recorded as well, as SWEEP_TRACE_INVALIDATED_EVENT.
+#define SWEEP_TRACE_MAGIC "VVTRACE"
+#define SWEEP_TRACE_VERSION 1
+
+#define SWEEP_TRACE_EVENT 1
+#define SWEEP_TRACE_VERTEX 2
+#define SWEEP_TRACE_BEACH_LINE 3
+#define SWEEP_TRACE_END 4
+
+#define SWEEP_TRACE_SITE_EVENT 0
+#define SWEEP_TRACE_CIRCLE_EVENT 1
+// A circle event whose arc was already gone by the time it came up, and which changed nothing
+#define SWEEP_TRACE_INVALIDATED_EVENT 2
+
+// Events between the copies of the beach line kept by SweepTrace, which bound the replay needed to reach any event
+#define SWEEP_TRACE_CHECKPOINT_INTERVAL 256
+
+void sweepTraceTest1();
+
+// Writes the trace of a sweep to a file, through FortuneSweeper::setTrace. The beach line is compared with its state
+// after the previous event, and only the arcs that changed are written. Splices are addressed by position, which the
+// beach line tree doesn't keep, so every event walks the whole beach line: a traced sweep is O(n) per event, and
+// quadratic overall on inputs with long beach lines. Meant for debugging and animation sized inputs, not for timing.
+// Throws std::runtime_error if the file can't be opened, or on write errors in close().
+class SweepTraceWriter {
+public:
+    explicit SweepTraceWriter(const std::string &path);
+
+    // Closes the file without the END record if close() wasn't called, which leaves a truncated trace
+    ~SweepTraceWriter();
+
+    SweepTraceWriter(const SweepTraceWriter &) = delete;
+
+    SweepTraceWriter &operator=(const SweepTraceWriter &) = delete;
+
+    // Writes the header. Called by the sweeper when the trace is attached.
+    void begin(const std::vector<Vec2> &sites);
+
+    void recordEvent(const Event* event);
+
+    void recordVertex(Vec2 position, int label);
+
+    // Diffs the arcs of the beach line, walked from its leftmost node, against the previous event. Linear in the
+    // length of the beach line, whatever the size of the change.
+    void recordBeachLine(LinkedNode<BeachChain*, TreeValueFacade*>* leftmost);
+
+    // Writes the END record, and closes the file
+    void close();
+
+private:
+    // An arc is the same as before only if it is the same chain of the same site. Chains are freed during the sweep,
+    // so the pointers of the previous beach line are compared, but never followed.
+    struct TracedArc {
+        const BeachChain* chain;
+        int32_t site;
+
+        bool operator==(const TracedArc &other) const {
+            return chain == other.chain && site == other.site;
+        }
+    };
+
+    std::string path;
+    FILE* file;
+    // Deleted, and so flushed, before the file is closed
+    OutputBuffer* out;
+    int64_t numEvents = 0;
+
+    std::vector<TracedArc> arcs;
+    std::vector<TracedArc> scratch;
+};
+
+struct SweepTraceEvent {
+    // One of the SWEEP_TRACE_*_EVENT kinds
+    uint8_t kind;
+
+    // Position of the event, with the sweep line at its y
+    Vec2 position;
+
+    // Only for circle events
+    Vec2 circleCenter;
+
+    // Number of vertices offered up to and including this event, so that the event offered the vertices from the
+    // count of the previous event up to this one
+    int32_t numVertices;
+};
+
+// Trace written by SweepTraceWriter, read and checked in full on construction. Throws std::runtime_error if the file
+// can't be read, or doesn't match the format.
+class SweepTrace {
+public:
+    explicit SweepTrace(const std::string &path);
+
+    std::vector<Vec2> sites;
+
+    std::vector<SweepTraceEvent> events;
+
+    // Offered vertices in order, with their label as the identifier
+    std::vector<Vec2> vertices;
+
+    // Site identifiers of the arcs on the beach line right after the event, left to right. Replays the changes from
+    // the closest checkpoint, or from the last event asked for when it is on the way. The result is only valid until
+    // the next call. Throws std::out_of_range for events outside the trace.
+    const std::vector<int32_t> &beachLineAfter(int event);
+
+private:
+    struct Splice {
+        int32_t start = 0;
+        int32_t removed = 0;
+        int32_t numInserted = 0;
+        // Into insertedSites
+        size_t firstInserted = 0;
+    };
+
+    // The change each event made to the beach line
+    std::vector<Splice> splices;
+    std::vector<int32_t> insertedSites;
+
+    // Beach line before every SWEEP_TRACE_CHECKPOINT_INTERVAL-th event
+    std::vector<std::vector<int32_t>> checkpoints;
+
+    std::vector<int32_t> beachLine;
+    int replayedEvent = -1;
+
+    void applySplice(std::vector<int32_t> &arcs, const Splice &splice) const;
+};
+
+// Whether the file starts with the trace magic
+bool isSweepTraceFile(const std::string &path);
+
+#endif //VORONOI_VIZ_SWEEPTRACE_HPP
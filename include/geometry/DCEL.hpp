@@ -2,23 +2,169 @@
 #ifndef VORONOI_VIZ_DCEL_HPP
 #define VORONOI_VIZ_DCEL_HPP
 
-#include <vector>
-#include <unordered_set>
+#include <cstdint>
+#include <deque>
+#include <string>
 #include <unordered_map>
-#include <set>
+#include <vector>
 #include "Vertex.hpp"
-#include "Face.hpp"
+#include "HalfEdge.hpp"
+#include "utils/ThreadPool.hpp"
+#include "utils/OutputBuffer.hpp"
+
+// Index used in place of a null reference
+#define DCEL_NULL_INDEX (-1)
+
+// Bound on the cell coordinates of the weld grid, well inside int64_t
+#define WELD_CELL_LIMIT (int64_t(1) << 62)
+
+void dcelFactoryTest1();
+
+class DCEL;
+
+class HalfEdgeRef;
+
+class FaceRef;
+
+// Lightweight read-only handles into the DCEL arrays. They are cheap to copy, and only valid while the DCEL lives.
+class VertexRef {
+public:
+    int32_t index;
+
+    VertexRef(const DCEL* dcel, int32_t index) : index(index), dcel(dcel) {}
+
+    [[nodiscard]] bool isNull() const;
+
+    [[nodiscard]] int label() const;
+
+    [[nodiscard]] Vec2 pos() const;
+
+    [[nodiscard]] bool isBoundary() const;
+
+    [[nodiscard]] HalfEdgeRef incidentEdge() const;
+
+    [[nodiscard]] std::string toString() const;
+
+private:
+    const DCEL* dcel;
+};
+
+class HalfEdgeRef {
+public:
+    int32_t index;
+
+    HalfEdgeRef(const DCEL* dcel, int32_t index) : index(index), dcel(dcel) {}
+
+    [[nodiscard]] bool isNull() const;
+
+    [[nodiscard]] VertexRef origin() const;
+
+    [[nodiscard]] VertexRef dest() const;
+
+    [[nodiscard]] HalfEdgeRef twin() const;
+
+    [[nodiscard]] HalfEdgeRef next() const;
+
+    [[nodiscard]] HalfEdgeRef prev() const;
+
+    [[nodiscard]] FaceRef incidentFace() const;
+
+    [[nodiscard]] bool unbounded() const;
+
+    [[nodiscard]] std::string toString() const;
+
+private:
+    const DCEL* dcel;
+};
+
+class FaceRef {
+public:
+    int32_t index;
+
+    FaceRef(const DCEL* dcel, int32_t index) : index(index), dcel(dcel) {}
+
+    [[nodiscard]] bool isNull() const;
+
+    [[nodiscard]] int label() const;
+
+    [[nodiscard]] HalfEdgeRef outer() const;
+
+    [[nodiscard]] HalfEdgeRef inner() const;
+
+    [[nodiscard]] bool unbounded() const;
+
+    [[nodiscard]] std::string toString() const;
+
+private:
+    const DCEL* dcel;
+};
+
+// Iterator adaptor over one of the DCEL arrays, yielding handles
+template<typename Ref>
+class DCELRange {
+public:
+    class iterator {
+    public:
+        iterator(const DCEL* dcel, int32_t index) : dcel(dcel), index(index) {}
+
+        Ref operator*() const { return Ref(dcel, index); }
+
+        iterator &operator++() {
+            index++;
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const { return index == other.index; }
+
+        bool operator!=(const iterator &other) const { return index != other.index; }
+
+    private:
+        const DCEL* dcel;
+        int32_t index;
+    };
+
+    DCELRange(const DCEL* dcel, int32_t size) : dcel(dcel), count(size) {}
+
+    [[nodiscard]] iterator begin() const { return iterator(dcel, 0); }
+
+    [[nodiscard]] iterator end() const { return iterator(dcel, count); }
+
+    [[nodiscard]] int32_t size() const { return count; }
+
+    Ref operator[](int32_t index) const { return Ref(dcel, index); }
+
+private:
+    const DCEL* dcel;
+    int32_t count;
+};
 
 class DCELFactory;
 
+// Struct-of-arrays DCEL. Every reference between records is an int32 index into these arrays, and half-edges are
+// always stored next to their twin, so that the twin of half-edge i is i ^ 1.
 class DCEL {
 public:
     friend class DCELFactory;
 
-    std::vector<Vertex*> vertices;
-    std::vector<HalfEdge*> halfEdges;
-    std::vector<Face*> faces;
-    std::vector<Vec2> sites;
+    // Vertex records
+    std::vector<double> vertexX;
+    std::vector<double> vertexY;
+    std::vector<int32_t> vertexLabel;
+    std::vector<int32_t> vertexIncidentEdge;
+    std::vector<uint8_t> vertexIsBoundary;
+
+    // Half-edge records. The destination of a half-edge is the origin of its twin.
+    std::vector<int32_t> edgeOrigin;
+    std::vector<int32_t> edgeNext;
+    std::vector<int32_t> edgePrev;
+    std::vector<int32_t> edgeFace;
+    std::vector<uint8_t> edgeUnbounded;
+
+    // Face records
+    std::vector<int32_t> faceLabel;
+    std::vector<int32_t> faceOuter;
+    std::vector<int32_t> faceInner;
+    std::vector<uint8_t> faceUnbounded;
 
     Vec2 bottomLeftBounds {Vec2(-DOUBLE_INFINITY, -DOUBLE_INFINITY)};
     Vec2 topRightBounds {Vec2(DOUBLE_INFINITY, DOUBLE_INFINITY)};
@@ -35,74 +181,228 @@ public:
 
     [[nodiscard]] int numFaces() const;
 
-    ~DCEL() {
-        for (auto v: vertices) delete v;
-        for (auto e: halfEdges) delete e;
-        for (auto f: faces) delete f;
-    }
+    [[nodiscard]] DCELRange<VertexRef> vertices() const;
+
+    [[nodiscard]] DCELRange<HalfEdgeRef> halfEdges() const;
+
+    [[nodiscard]] DCELRange<FaceRef> faces() const;
+
+    [[nodiscard]] static int32_t twin(int32_t edge);
+
+    [[nodiscard]] int32_t dest(int32_t edge) const;
+
+    [[nodiscard]] Vec2 vertexPos(int32_t vertex) const;
 
+    // First half-edge of the boundary cycle of a face. That is the outer component, or the inner one for the faces that
+    // reach the bounding box or infinity. DCEL_NULL_INDEX if the face has no edges.
+    [[nodiscard]] int32_t faceBoundaryEdge(int32_t face) const;
+
+    // Empties every array, but keeps their capacity for the next diagram
+    void clear();
+
+    void reserve(int vertices, int halfEdges, int faces);
 
     [[nodiscard]] double getCenteredX(double x) const;
 
     [[nodiscard]] double getCenteredY(double y) const;
 
-    void printOutputVoronoiStyle();
+    void printOutputVoronoiStyle() const;
+
+    void printOutputDelaunayStyle() const;
+
+    // Same as VertexRef::toString()
+    void putVertexName(OutputBuffer &out, int32_t vertex) const;
 
-    void printOutputDelaunayStyle();
+    // Same as HalfEdgeRef::toString(), or nil for a null edge
+    void putEdgeName(OutputBuffer &out, int32_t edge) const;
+
+    // Same as the print functions, through a buffered writer
+    void writeOutputVoronoiStyle(OutputBuffer &out) const;
+
+    void writeOutputDelaunayStyle(OutputBuffer &out) const;
 
 private:
-    Vertex* insertVertex(int label, Vec2 position);
+    int32_t insertVertex(int label, Vec2 position, bool isBoundary = false);
 
-    Vertex* insertVertex(Vec2 position);
+    // Inserts a half-edge and its twin, returning the index of the first one
+    int32_t insertEdge(int32_t origin, int32_t dest);
 
-    Vertex* insert(Vertex* vertex);
+    int32_t insertFace(int label, bool unbounded = false);
 
-    HalfEdge* insert(HalfEdge* edge);
+    void offerFaceComponent(int32_t face, int32_t edge);
 
-    Face* insert(Face* face);
+    void chainNext(int32_t edge, int32_t nextEdge);
+};
+
+// Walks the boundary of each face of a DCEL as a closed ring. The DCEL has no edges along the bounding box, so the
+// next pointers of a cell that reaches the box run back along its rays instead; the ring follows the box instead,
+// counterclockwise through its corners, up to the next ray of the same cell. Only the boundary vertices are indexed.
+class FaceRings {
+public:
+    explicit FaceRings(const DCEL* dcel);
+
+    // Calls fn(vertex) for each vertex around a face, counterclockwise for faces left of their half-edges, without
+    // repeating the first one at the end
+    template<typename Fn>
+    void forEachVertex(int32_t face, Fn fn) const {
+        int32_t start = dcel->faceBoundaryEdge(face);
+        int32_t edge = start;
+        int limit = dcel->numHalfEdges() + static_cast<int>(perimeter.size());
+        for (int steps = 0; edge != DCEL_NULL_INDEX && steps < limit; steps++) {
+            fn(dcel->edgeOrigin[edge]);
+            int32_t dest = dcel->dest(edge);
+            int32_t next = dcel->edgeNext[edge];
+            if (dcel->vertexIsBoundary[dest] && (next == DCEL::twin(edge) || dcel->edgeFace[next] != face)) {
+                // Go around the box to the next boundary vertex with an edge of this face, through the corners
+                fn(dest);
+                next = DCEL_NULL_INDEX;
+                size_t position = perimeterPosition(dest);
+                for (size_t k = 1; k <= perimeter.size() && next == DCEL_NULL_INDEX; k++) {
+                    int32_t vertex = perimeter[(position + k) % perimeter.size()];
+                    next = outgoingEdge(vertex, face);
+                    if (next == DCEL_NULL_INDEX) fn(vertex);
+                }
+            }
+            edge = next;
+            if (edge == start) break;
+        }
+    }
+
+    // Number of vertices forEachVertex() visits
+    [[nodiscard]] int32_t ringSize(int32_t face) const;
+
+private:
+    const DCEL* dcel;
 
-    HalfEdge* insertEdge(Vertex* v1, Vertex* v2);
+    // Boundary vertices counterclockwise around the box from its bottom left corner, and their distance along it
+    std::vector<int32_t> perimeter;
+    std::vector<double> perimeterDistance;
+
+    [[nodiscard]] double distanceAlongBox(int32_t vertex) const;
+
+    [[nodiscard]] size_t perimeterPosition(int32_t vertex) const;
+
+    // A half-edge out of the vertex on the boundary of the face, or DCEL_NULL_INDEX
+    [[nodiscard]] int32_t outgoingEdge(int32_t vertex, int32_t face) const;
 };
 
+// Builds the DCEL out of the vertices and edges offered during the sweep. A factory can be reused for many diagrams
+// through reset(), which keeps the capacity of every internal buffer. The DCELs it returns are owned by the factory,
+// and stay valid until the next reset().
 class DCELFactory {
 public:
-    explicit DCELFactory(const std::vector<Vec2> &sites);;
+    DCELFactory() = default;
+
+    explicit DCELFactory(const std::vector<Vec2> &sites);
+
+    ~DCELFactory();
+
+    DCELFactory(const DCELFactory &) = delete;
+
+    DCELFactory &operator=(const DCELFactory &) = delete;
 
-    void offerVertex(Vertex* vertex);
+    // Throws std::invalid_argument if two sites share an identifier
+    void reset(const std::vector<Vec2> &sites);
+
+    // Sweep-time records, owned by the factory, and valid until the next reset()
+    Vertex* createVertex(int label, Vec2 position);
+
+    VertexPair* createPair();
+
+    // Vertices within NUMERICAL_TOLERANCE of an earlier one are welded into it: the offered vertex is left unused, and
+    // the earlier one is returned in its place. Otherwise, the offered vertex is returned.
+    Vertex* offerVertex(Vertex* vertex);
 
     void offerPair(VertexPair* vertexPair);
 
     int numVertices();
 
-    DCEL* createDCEL(const std::vector<Vec2> &sites);
+    DCEL* createDCEL();
 
-    static DCEL* consolidateDCEL(DCEL* geometry);
+    // Builds the diagram of sites that all lie on one line straight from the sites, bypassing the sweep. Returns
+    // nullptr if that is not possible (fewer than two sites, coincident sites, or records already offered).
+    DCEL* createColinearDCEL();
+
+    static DCEL* consolidateDCEL(DCEL* geometry, ThreadPool &pool = ThreadPool::shared());
+
+    // Pool used to build the DCELs, not owned by the factory. nullptr, the default, stands for the shared pool.
+    void setThreadPool(ThreadPool* newPool);
 
     DCEL* buildDualGraph();
 
 private:
-    DCEL* dcel {};
+    DCEL* dcel {new DCEL()};
+    DCEL* dualGraph {new DCEL()};
+
+    ThreadPool* pool {nullptr};
 
-    const std::vector<Vec2> &sites;
+    std::vector<Vec2> sites {};
 
     Vec2 bottomLeft = Vec2(DOUBLE_INFINITY, DOUBLE_INFINITY);
     Vec2 topRight = Vec2(-DOUBLE_INFINITY, -DOUBLE_INFINITY);
 
     int numBoundaryVertices = 0;
 
-    Vertex* bl = nullptr;
-    Vertex* br = nullptr;
-    Vertex* tr = nullptr;
-    Vertex* tl = nullptr;
+    int32_t bl = DCEL_NULL_INDEX;
+    int32_t br = DCEL_NULL_INDEX;
+    int32_t tr = DCEL_NULL_INDEX;
+    int32_t tl = DCEL_NULL_INDEX;
+
+    // Append-only records in offer order. Voronoi vertices are labelled by creation order, so the vertex with label L
+    // is vertices[L - 1], and it also lands at index L - 1 of the DCEL's vertex arrays.
+    std::vector<Vertex*> vertices {};
+    std::vector<VertexPair*> vertexPairs {};
+
+    // Storage behind createVertex() and createPair(), with stable addresses
+    std::deque<Vertex> vertexStore {};
+    std::deque<VertexPair> pairStore {};
+
+    // Spatial hash of the offered vertices, from a grid cell of side NUMERICAL_TOLERANCE to the vertex indices in it
+    std::unordered_multimap<uint64_t, int32_t> weldGrid {};
+
+    // Both the Voronoi cell and the Delaunay vertex of a site are stored at its position in the sites vector. When the
+    // identifiers are 1, 2, 3... in order, that position is the identifier minus one. Otherwise it is looked up in
+    // siteIndices, (identifier, position) pairs sorted by identifier, which stays at n entries however large or
+    // sparse the identifiers are.
+    bool sequentialSites = true;
+    std::vector<std::pair<int32_t, int32_t>> siteIndices {};
+
+    // Scratch buffers of createDCEL, kept between runs
+    struct PendingEdge {
+        VertexPair* pair;
+        int32_t origin;
+        int32_t dest;
+        int originRay;
+        int destRay;
+    };
+
+    std::vector<PendingEdge> pendingEdges {};
+    std::vector<Vec2> rayOrigins {};
+    std::vector<Vec2> rayDirections {};
+    std::vector<Vec2> rayExits {};
+
+    [[nodiscard]] bool isOfferedVertex(const Vertex* vertex) const;
+
+    [[nodiscard]] int32_t siteIndex(const Vec2* site) const;
+
+    int32_t getOrCreateBoundaryVertex(Vec2 intersect);
+
+    int32_t vertexIndex(const Vertex* vertex) const;
+
+    [[nodiscard]] ThreadPool &threadPool() const;
+
+    // Cell of a coordinate in the weld grid, clamped to [-WELD_CELL_LIMIT, WELD_CELL_LIMIT]
+    static int64_t weldCell(double coordinate);
+
+    static uint64_t weldCellKey(int64_t cellX, int64_t cellY);
 
-    std::unordered_set<Vertex*> vertices {};
-    std::unordered_set<VertexPair*> vertexPairs {};
-    std::unordered_map<int, Face*> cells {};
+    void fitBoundsToSites();
 
-    // Dual graph stuff
-    std::vector<HalfEdge*> fwdEdges;
+    // Equalizes and pads the bounds, then inserts the four corners of the bounding box
+    void insertBoundingBox();
 
-    Vertex* getOrCreateBoundaryVertex(Vec2 origin, double angle);
+    // Inserts an edge between the cells of two sites, given by face index, on the correct sides
+    void insertSeparatingEdge(int32_t origin, int32_t dest, int32_t faceA, int32_t faceB);
 };
 
 #endif //VORONOI_VIZ_DCEL_HPP
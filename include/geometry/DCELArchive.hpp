@@ -0,0 +1,88 @@
+#ifndef VORONOI_VIZ_DCELARCHIVE_HPP
+#define VORONOI_VIZ_DCELARCHIVE_HPP
+
+#include <string>
+#include <cstdint>
+#include "geometry/DCEL.hpp"
+#include "utils/OutputBuffer.hpp"
+
+// Compact archive of DCELs, for keeping many diagrams on disk. A file is a sequence of records, one per DCEL, each
+// being a fixed header, the fields of DCELArchiveHeader in order and little-endian, followed by varint streams:
+//
+//   vertices    per vertex: x and y quantised to the grid of the header, label, incident edge
+//               then the boundary flags, 8 to a byte
+//   half-edges  per half-edge: origin, next, face, and prev only with DCEL_ARCHIVE_PREV
+//               then the unbounded flags, 8 to a byte
+//   faces       per face: label, outer edge, inner edge
+//               then the unbounded flags, 8 to a byte
+//
+// Every number is the zigzag LEB128 varint of its difference from a nearby one: the same field of the previous
+// element, the twin for origins, and the half-edge itself for next and prev. The topology is kept exactly, and
+// coordinates to within half a grid step. Without DCEL_ARCHIVE_PREV, prev is rebuilt as the inverse of next.
+#define DCEL_ARCHIVE_MAGIC "VVDCELZ"
+#define DCEL_ARCHIVE_VERSION 1
+#define DCEL_ARCHIVE_HEADER_SIZE 112
+
+// Bits per quantised coordinate, across the larger side of the vertex bounds. 32 bits keep a few more digits than
+// the text output prints for any diagram whose size is within a few orders of magnitude of its coordinates.
+#define DCEL_ARCHIVE_DEFAULT_BITS 32
+#define DCEL_ARCHIVE_MAX_BITS 52
+
+// The DCEL was consolidated
+#define DCEL_ARCHIVE_CONSOLIDATED 0x1
+
+// The prev array is stored, because it isn't the inverse of next
+#define DCEL_ARCHIVE_PREV 0x2
+
+void dcelArchiveTest1();
+
+void dcelArchiveBenchmark();
+
+struct DCELArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    int32_t numVertices;
+    int32_t numHalfEdges;
+    int32_t numFaces;
+    uint32_t coordinateBits;
+
+    // Vertex (i, j) on the grid is at (originX + i * step, originY + j * step)
+    double originX;
+    double originY;
+    double step;
+
+    double bottomLeftX;
+    double bottomLeftY;
+    double topRightX;
+    double topRightY;
+    double majorAxis;
+    double centroidX;
+    double centroidY;
+};
+
+// Appends a record of the DCEL. Throws std::invalid_argument for a bit count outside [1, DCEL_ARCHIVE_MAX_BITS] or
+// vertices that aren't finite.
+void writeDCELArchive(OutputBuffer &out, const DCEL* dcel, int coordinateBits = DCEL_ARCHIVE_DEFAULT_BITS);
+
+// Reads the record at the start of [begin, end) into the DCEL, replacing what it held but keeping the capacity of
+// its arrays. Returns the end of the record. Throws std::runtime_error if the record is malformed or truncated, or
+// refers to records that don't exist.
+const char* readDCELArchive(const char* begin, const char* end, DCEL &dcel);
+
+// Writes a diagram, and its dual unless it is null, as an archive file. Throws std::runtime_error on write errors.
+void saveDiagramArchive(
+    const std::string &path,
+    const DCEL* voronoi,
+    const DCEL* delaunay,
+    int coordinateBits = DCEL_ARCHIVE_DEFAULT_BITS
+);
+
+// Reads back what saveDiagramArchive wrote, and returns whether the file had the dual. Throws std::runtime_error if
+// the file can't be mapped or read.
+bool loadDiagramArchive(const std::string &path, DCEL &voronoi, DCEL &delaunay);
+
+// Whether the file starts with the archive magic
+bool isDCELArchiveFile(const std::string &path);
+
+#endif //VORONOI_VIZ_DCELARCHIVE_HPP
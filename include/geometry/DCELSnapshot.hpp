@@ -0,0 +1,132 @@
+#ifndef VORONOI_VIZ_DCELSNAPSHOT_HPP
+#define VORONOI_VIZ_DCELSNAPSHOT_HPP
+
+#include <string>
+#include <cstdint>
+#include "geometry/DCEL.hpp"
+#include "utils/files.hpp"
+
+// Immutable image of a DCEL, laid out so that a memory mapping of the file can be queried in place. Little-endian
+// throughout, a fixed header followed by the same arrays as the DCEL:
+//
+//   vertexX, vertexY                        float64 per vertex
+//   vertexLabel, vertexIncidentEdge         int32 per vertex
+//   vertexIsBoundary                        uint8 per vertex
+//   edgeOrigin, edgeNext, edgePrev, edgeFace  int32 per half-edge
+//   edgeUnbounded                           uint8 per half-edge
+//   faceLabel, faceOuter, faceInner         int32 per face
+//   faceUnbounded                           uint8 per face
+//
+// The header holds the byte offset of each array from the start of the file. Arrays start at multiples of
+// DCEL_SNAPSHOT_ALIGNMENT, so they can be read through typed pointers straight off the mapping, and nothing in the
+// file is a pointer. A snapshot is written once, then any number of processes can map it and share its pages. As the
+// arrays are used in place, the snapshot code only compiles for little-endian hosts, whose own order that is.
+#define DCEL_SNAPSHOT_MAGIC "VVDCELM"
+#define DCEL_SNAPSHOT_VERSION 1
+#define DCEL_SNAPSHOT_HEADER_SIZE 208
+#define DCEL_SNAPSHOT_ALIGNMENT 8
+
+// The DCEL was consolidated
+#define DCEL_SNAPSHOT_CONSOLIDATED 0x1
+
+void dcelSnapshotTest1();
+
+void dcelSnapshotBenchmark();
+
+struct DCELSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    int32_t numVertices;
+    int32_t numHalfEdges;
+    int32_t numFaces;
+    uint32_t reserved;
+
+    double bottomLeftX;
+    double bottomLeftY;
+    double topRightX;
+    double topRightY;
+    double majorAxis;
+    double centroidX;
+    double centroidY;
+
+    uint64_t vertexXOffset;
+    uint64_t vertexYOffset;
+    uint64_t vertexLabelOffset;
+    uint64_t vertexIncidentEdgeOffset;
+    uint64_t vertexIsBoundaryOffset;
+    uint64_t edgeOriginOffset;
+    uint64_t edgeNextOffset;
+    uint64_t edgePrevOffset;
+    uint64_t edgeFaceOffset;
+    uint64_t edgeUnboundedOffset;
+    uint64_t faceLabelOffset;
+    uint64_t faceOuterOffset;
+    uint64_t faceInnerOffset;
+    uint64_t faceUnboundedOffset;
+
+    // Size of the whole file
+    uint64_t fileSize;
+};
+
+// Read-only DCEL over the memory mapping of a snapshot, with the arrays under the same names as in DCEL. Opening one
+// only checks the header, and that every array lies inside the file, so it takes the same time for any size of
+// diagram; pages are read in as the arrays are touched. Indices in the arrays are trusted to be in range, as they are
+// in files written by writeDCELSnapshot. Throws std::runtime_error if the file can't be mapped, or if its header
+// doesn't match the format.
+class MappedDCEL {
+public:
+    explicit MappedDCEL(const std::string &path);
+
+    const double* vertexX = nullptr;
+    const double* vertexY = nullptr;
+    const int32_t* vertexLabel = nullptr;
+    const int32_t* vertexIncidentEdge = nullptr;
+    const uint8_t* vertexIsBoundary = nullptr;
+
+    const int32_t* edgeOrigin = nullptr;
+    const int32_t* edgeNext = nullptr;
+    const int32_t* edgePrev = nullptr;
+    const int32_t* edgeFace = nullptr;
+    const uint8_t* edgeUnbounded = nullptr;
+
+    const int32_t* faceLabel = nullptr;
+    const int32_t* faceOuter = nullptr;
+    const int32_t* faceInner = nullptr;
+    const uint8_t* faceUnbounded = nullptr;
+
+    Vec2 bottomLeftBounds {Vec2(0, 0)};
+    Vec2 topRightBounds {Vec2(0, 0)};
+    double majorAxis = 0;
+    Vec2 centroid {Vec2(0, 0)};
+
+    bool consolidated = false;
+
+    [[nodiscard]] int numVertices() const;
+
+    [[nodiscard]] int numHalfEdges() const;
+
+    [[nodiscard]] int numFaces() const;
+
+    [[nodiscard]] static int32_t twin(int32_t edge);
+
+    [[nodiscard]] int32_t dest(int32_t edge) const;
+
+    // Copies the snapshot into a DCEL, replacing what it held but keeping the capacity of its arrays
+    void copyTo(DCEL &dcel) const;
+
+private:
+    MappedFile file;
+    DCELSnapshotHeader header {};
+
+    // Pointer to the array at the offset, after checking that count elements of the given size fit in the file
+    const char* array(uint64_t offset, int32_t count, size_t elementSize) const;
+};
+
+// Writes the DCEL as a snapshot. Throws std::runtime_error on write errors.
+void writeDCELSnapshot(const std::string &path, const DCEL* dcel);
+
+// Whether the file starts with the snapshot magic
+bool isDCELSnapshotFile(const std::string &path);
+
+#endif //VORONOI_VIZ_DCELSNAPSHOT_HPP
@@ -0,0 +1,54 @@
+#ifndef VORONOI_VIZ_GEOMETRYWRITERS_HPP
+#define VORONOI_VIZ_GEOMETRYWRITERS_HPP
+
+#include <string>
+#include <vector>
+#include "geometry/DCEL.hpp"
+#include "utils/OutputBuffer.hpp"
+
+// Streaming writers from a DCEL to standard formats. They walk the DCEL arrays and write through an OutputBuffer, so
+// memory stays bounded by the buffer whatever the size of the output. Counts that a header needs are found by an
+// extra walk first, rather than by holding anything back. Coordinates are written with the shortest digits that
+// read back exactly.
+
+void geometryWritersTest1();
+
+// The GeoJSON, SVG, PLY and CSV writers, read back and checked against the diagram and each other
+void geometryWritersTest2();
+
+// The DCEL text writers against the printf output they replaced, over diagrams from the sweep
+void dcelOutputTest1();
+
+void dcelOutputBenchmark();
+
+// Voronoi cells as a FeatureCollection of Polygons, each with the identifier of its site as the "site" property.
+// Rings are counterclockwise and closed, as RFC 7946 asks.
+void writeCellsGeoJSON(OutputBuffer &out, const DCEL* voronoi);
+
+// Voronoi cells as a single little-endian WKB MultiPolygon, with one ring per polygon, in face order
+void writeCellsWKB(OutputBuffer &out, const DCEL* voronoi);
+
+// Voronoi cells and sites as an SVG image of the bounding box, with y pointing up
+void writeDiagramSVG(OutputBuffer &out, const std::vector<Vec2> &sites, const DCEL* voronoi);
+
+// The bounded faces of a Delaunay triangulation as a triangle mesh at z = 0. Faces of cocircular sites are split into
+// a fan of triangles.
+void writeMeshOFF(OutputBuffer &out, const DCEL* delaunay);
+
+void writeMeshPLY(OutputBuffer &out, const DCEL* delaunay);
+
+// One row per edge, with the names of its vertices, their coordinates, and the site identifiers of the faces on
+// either side, empty where there is no face
+void writeEdgesCSV(OutputBuffer &out, const DCEL* dcel);
+
+// Picks the writer from the extension of the path: .geojson, .wkb, .svg and .csv write the Voronoi diagram, .off and
+// .ply the Delaunay triangulation, .dcel both as a DCEL archive, and .dcelm the Voronoi diagram as a DCEL snapshot.
+// Throws std::runtime_error on unknown extensions and write errors.
+void exportDiagram(
+    const std::string &path,
+    const std::vector<Vec2> &sites,
+    const DCEL* voronoi,
+    const DCEL* delaunay
+);
+
+#endif //VORONOI_VIZ_GEOMETRYWRITERS_HPP
@@ -3,52 +3,19 @@
 
 #include <limits>
 #include "Vertex.hpp"
-#include "Face.hpp"
 #include "utils/math/mathematics.hpp"
 
-class Face;
-
 class Vertex;
 
-class HalfEdge {
-public:
-    Vertex* origin;
-    Vertex* dest;
-    double angle;
-    HalfEdge* twin {nullptr};
-    HalfEdge* next {nullptr};
-    HalfEdge* prev {nullptr};
-    Face* incidentFace {nullptr};
-    bool unbounded = false;
-
-    HalfEdge() : origin {nullptr}, dest {nullptr}, angle(QUIET_NAN) {}
-
-    HalfEdge(Vertex* origin, Vertex* dest);
-
-    [[nodiscard]] const char* toString() const;
-
-    [[nodiscard]] HalfEdge* generateTwin() const;
-
-    void bindTwins(HalfEdge* other);
-
-    void chainNext(HalfEdge* other);
-
-    void chainPrev(HalfEdge* other);
-};
-
-struct HalfEdgeAngleComparator {
-    bool operator()(const HalfEdge* lhs, const HalfEdge* rhs) const {
-        return lhs->angle < rhs->angle;
-    }
-};
-
+// Sweep-time record of a Voronoi edge, before it is turned into a pair of half-edges in the DCEL
 struct VertexPair {
     Vertex* v1 = nullptr;
     Vertex* v2 = nullptr;
     Vec2* incidentSiteA;
     Vec2* incidentSiteB;
 
-    double angle {QUIET_NAN};
+    // Unnormalized direction of the edge, pointing from v1 towards v2 (or towards infinity if v2 is unknown)
+    Vec2 direction {Vec2(0, 0)};
 
     void offerVertex(Vertex* vertex);
 };
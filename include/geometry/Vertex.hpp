@@ -3,15 +3,12 @@
 
 #include <string>
 #include "utils/math/Vec2.hpp"
-#include "HalfEdge.hpp"
-
-class HalfEdge;
 
+// Sweep-time vertex, handed to the DCELFactory which copies it into the DCEL's vertex arrays
 class Vertex {
 public:
     int label;
     Vec2 pos;
-    HalfEdge* incidentEdge;
     bool isBoundary = false;
 
     [[nodiscard]] double x() const;
@@ -20,17 +17,13 @@ public:
 
     Vertex(int label, Vec2 v) :
         label(label),
-        pos(v),
-        incidentEdge(nullptr) {};
+        pos(v) {};
 
     explicit Vertex(Vec2 v) :
         label(-1),
-        pos(v),
-        incidentEdge(nullptr) {};
+        pos(v) {};
 
     [[nodiscard]] std::string toString() const;
-
-    static Vertex* boundary(Vec2 v, int label = -1);
 };
 
 #endif //VORONOI_VIZ_VERTEX_HPP
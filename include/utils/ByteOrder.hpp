@@ -0,0 +1,33 @@
+#ifndef VORONOI_VIZ_BYTEORDER_HPP
+#define VORONOI_VIZ_BYTEORDER_HPP
+
+#include <algorithm>
+#include <cstring>
+
+// The binary formats are all little-endian. Compilers that don't say are taken to target little-endian hosts, as
+// every MSVC target is.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define HOST_LITTLE_ENDIAN 0
+#else
+#define HOST_LITTLE_ENDIAN 1
+#endif
+
+// The bytes of a number, least significant first, whatever the order of the host. On a little-endian host this is a
+// plain copy.
+template<typename T>
+void storeLittleEndian(char* bytes, T value) {
+    memcpy(bytes, &value, sizeof(T));
+    if (!HOST_LITTLE_ENDIAN) std::reverse(bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+T loadLittleEndian(const char* bytes) {
+    char ordered[sizeof(T)];
+    memcpy(ordered, bytes, sizeof(T));
+    if (!HOST_LITTLE_ENDIAN) std::reverse(ordered, ordered + sizeof(T));
+    T value;
+    memcpy(&value, ordered, sizeof(T));
+    return value;
+}
+
+#endif //VORONOI_VIZ_BYTEORDER_HPP
@@ -0,0 +1,45 @@
+#ifndef VORONOI_VIZ_BYTEREADER_HPP
+#define VORONOI_VIZ_BYTEREADER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include "utils/ByteOrder.hpp"
+
+// Cursor over the bytes of a binary format, the reading side of OutputBuffer's putBinary and putVarint. Every read is
+// checked against the end, and throws std::runtime_error naming the format rather than reading past it.
+class ByteReader {
+public:
+    // The name of the format goes into the error messages, like "DCEL archive"
+    ByteReader(const char* begin, const char* end, const char* format);
+
+    const char* position;
+
+    [[nodiscard]] size_t remaining() const;
+
+    uint64_t varint();
+
+    int64_t signedVarint();
+
+    // A value written by OutputBuffer::putBinary
+    template<typename T>
+    T get() {
+        require(sizeof(T));
+        T value = loadLittleEndian<T>(position);
+        position += sizeof(T);
+        return value;
+    }
+
+    // Throws unless there are at least this many bytes left
+    void require(size_t length) const;
+
+    // Throws std::runtime_error with the reason, and the name of the format
+    [[noreturn]] void fail(const std::string &reason) const;
+
+private:
+    const char* end;
+    const char* format;
+};
+
+#endif //VORONOI_VIZ_BYTEREADER_HPP
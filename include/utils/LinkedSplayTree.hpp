@@ -4,11 +4,18 @@
 #include <iostream>
 #include <sstream>
 #include <functional>
+#include <vector>
 
 void linkedSplayTreeTest1();
 
 void linkedSplayTreeTest2_3();
 
+void linkedSplayTreeTest4();
+
+void linkedSplayTreeTest5();
+
+void linkedSplayTreeBenchmark();
+
 template<typename K, typename V = std::less<K>>
 class LinkedNode {
 public:
@@ -119,8 +126,12 @@ public:
 
     explicit LinkedSplayTree(Comparator comparator) : root(nullptr), compare(comparator) {}
 
+    // The tree never frees its nodes. Those created by add() are left to the caller, as are the ones it inserts.
     LinkedNode<K, V>* add(K key, V value, bool doSplay = true);
 
+    // Same as add(), with a node the caller created and keeps ownership of, so nodes can come out of a pool
+    LinkedNode<K, V>* insert(LinkedNode<K, V>* newNode, bool doSplay = true);
+
     LinkedNode<K, V>* get(K key);
 
     LinkedNode<K, V>* search(K key) const;
@@ -142,6 +153,20 @@ public:
     void replace(LinkedNode<K, V>* x, LinkedNode<K, V>* y);
 
     LinkedNode<K, V>* join(LinkedNode<K, V>* left, LinkedNode<K, V>* right);
+
+    // Replaces the whole tree with a balanced one over the given nodes, which must already be in order, and threads
+    // their prev/next links, in O(n). With evenNodesAsLeaves and an odd number of nodes, every node at an even position
+    // ends up as a leaf, which is the shape of a beach line of alternating arcs and breakpoints.
+    void buildBalanced(const std::vector<LinkedNode<K, V>*> &nodes, bool evenNodesAsLeaves = false);
+
+    // Cuts the contiguous in-order run [first, last] out of the tree with two splays, and returns the root of the cut
+    // subtree. The cut nodes keep their links to each other and to the nodes that bounded the run.
+    LinkedNode<K, V>* splitRange(LinkedNode<K, V>* first, LinkedNode<K, V>* last);
+
+    // Puts a single new node in place of the run [first, last], and returns the root of the cut subtree strictly
+    // between first and last. Only first, last and their ancestors are rotated, so nodes outside of the run never
+    // gain children; the beach line relies on this to keep its arcs as leaves.
+    LinkedNode<K, V>* replaceRange(LinkedNode<K, V>* first, LinkedNode<K, V>* last, LinkedNode<K, V>* replacement);
 };
 
 
@@ -238,13 +263,17 @@ void LinkedSplayTree<K, V, Comparator>::splay(LinkedNode<K, V>* node, LinkedNode
 
 template<typename K, typename V, typename Comparator>
 LinkedNode<K, V>* LinkedSplayTree<K, V, Comparator>::add(K key, V value, bool doSplay) {
-    auto* newNode = new LinkedNode<K, V>(key, value);
+    return insert(new LinkedNode<K, V>(key, value), doSplay);
+}
+
+template<typename K, typename V, typename Comparator>
+LinkedNode<K, V>* LinkedSplayTree<K, V, Comparator>::insert(LinkedNode<K, V>* newNode, bool doSplay) {
     LinkedNode<K, V>* y = nullptr;
     LinkedNode<K, V>* x = this->root;
 
     while (x) {
         y = x;
-        if (compare(key, x->key)) {
+        if (compare(newNode->key, x->key)) {
             x = x->leftChild;  // brain note: DSV
         } else {
             x = x->rightChild;
@@ -306,6 +335,104 @@ LinkedNode<K, V>* LinkedSplayTree<K, V, Comparator>::join(LinkedNode<K, V>* left
 }
 
 
+template<typename K, typename V, typename Comparator>
+void LinkedSplayTree<K, V, Comparator>::buildBalanced(
+    const std::vector<LinkedNode<K, V>*> &nodes,
+    bool evenNodesAsLeaves
+) {
+    int n = static_cast<int>(nodes.size());
+    for (int i = 0; i < n; i++) {
+        nodes[i]->prev = i > 0 ? nodes[i - 1] : nullptr;
+        nodes[i]->next = i + 1 < n ? nodes[i + 1] : nullptr;
+    }
+
+    // Roots every subrange [lo, hi) at its middle node. Picking an odd offset from lo keeps both halves of odd length,
+    // starting at an even position, so even positions are only ever reached as single-node ranges.
+    std::function<LinkedNode<K, V>*(int, int)> build = [&](int lo, int hi) -> LinkedNode<K, V>* {
+        if (lo >= hi) return nullptr;
+        int mid = lo + (hi - lo) / 2;
+        if (evenNodesAsLeaves && hi - lo > 1 && (mid - lo) % 2 == 0) mid--;
+
+        LinkedNode<K, V>* node = nodes[mid];
+        node->setLeftChild(build(lo, mid));
+        node->setRightChild(build(mid + 1, hi));
+        return node;
+    };
+
+    root = build(0, n);
+    if (root != nullptr) root->parent = nullptr;
+}
+
+
+template<typename K, typename V, typename Comparator>
+LinkedNode<K, V>* LinkedSplayTree<K, V, Comparator>::splitRange(LinkedNode<K, V>* first, LinkedNode<K, V>* last) {
+    LinkedNode<K, V>* before = first->prev;
+    LinkedNode<K, V>* after = last->next;
+
+    // With the predecessor at the root and the successor as its right child, the run is exactly the successor's left
+    // subtree. Without one of them, it is the corresponding subtree of the other one.
+    LinkedNode<K, V>* range;
+    if (before != nullptr) {
+        splay(before);
+        if (after != nullptr) {
+            splay(after, before);
+            range = after->leftChild;
+            after->leftChild = nullptr;
+        } else {
+            range = before->rightChild;
+            before->rightChild = nullptr;
+        }
+    } else if (after != nullptr) {
+        splay(after);
+        range = after->leftChild;
+        after->leftChild = nullptr;
+    } else {
+        range = root;
+        root = nullptr;
+    }
+
+    if (range != nullptr) range->parent = nullptr;
+    if (before != nullptr) before->next = after;
+    if (after != nullptr) after->prev = before;
+    return range;
+}
+
+
+template<typename K, typename V, typename Comparator>
+LinkedNode<K, V>* LinkedSplayTree<K, V, Comparator>::replaceRange(
+    LinkedNode<K, V>* first,
+    LinkedNode<K, V>* last,
+    LinkedNode<K, V>* replacement
+) {
+    LinkedNode<K, V>* before = first->prev;
+    LinkedNode<K, V>* after = last->next;
+
+    // With first at the root and last as its right child, everything strictly between them is last's left subtree
+    LinkedNode<K, V>* interior = nullptr;
+    splay(first);
+    if (first != last) {
+        splay(last, first);
+        interior = last->leftChild;
+        if (interior != nullptr) interior->parent = nullptr;
+    }
+
+    // The replacement takes over what is left on both sides
+    replacement->setLeftChild(first->leftChild);
+    replacement->setRightChild(last->rightChild);
+    replacement->parent = nullptr;
+    root = replacement;
+
+    first->leftChild = nullptr;
+    first->rightChild = nullptr;
+    last->leftChild = nullptr;
+    last->rightChild = nullptr;
+
+    replacement->linkPrev(before);
+    replacement->linkNext(after);
+    return interior;
+}
+
+
 template<typename K, typename V, typename Comparator>
 void LinkedSplayTree<K, V, Comparator>::remove(K key) {
     LinkedNode<K, V>* node = search(key);
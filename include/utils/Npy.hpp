@@ -0,0 +1,127 @@
+#ifndef VORONOI_VIZ_NPY_HPP
+#define VORONOI_VIZ_NPY_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include "utils/math/Vec2.hpp"
+#include "utils/files.hpp"
+#include "geometry/DCEL.hpp"
+
+// NumPy .npy arrays, and .npz archives of them, as written by np.save and np.savez. Only little-endian, C-ordered
+// arrays of float32, float64, int32 and int64 are supported, and .npz members must be stored uncompressed, which is
+// what np.savez does (but not np.savez_compressed).
+#define NPY_MAGIC "\x93NUMPY"
+#define NPY_MAGIC_LENGTH 6
+
+// Headers are padded so that the data of a .npy file starts at a multiple of this
+#define NPY_HEADER_ALIGNMENT 64
+
+void npyTest1();
+
+void npyTest2();
+
+// View of the data of an array, which stays in the file mapping it was read from. Elements are read with memcpy,
+// since the members of an archive are not aligned.
+struct NpyArray {
+    // 'f' or 'i'
+    char kind = 'f';
+    int itemSize = 8;
+    std::vector<size_t> shape;
+    const char* data = nullptr;
+
+    [[nodiscard]] size_t numElements() const;
+
+    // Element i of the flattened array
+    [[nodiscard]] double getDouble(size_t i) const;
+
+    [[nodiscard]] int64_t getInt(size_t i) const;
+};
+
+// Parses the .npy header at the start of [begin, end) and points the array at its data. Throws std::runtime_error if
+// the header is malformed, unsupported, or describes more data than there is.
+NpyArray parseNpy(const char* begin, const char* end);
+
+// A memory-mapped .npy file, or .npz archive, and the arrays in it. Throws std::runtime_error if the file can't be
+// mapped or read.
+class NumpyFile {
+public:
+    explicit NumpyFile(const std::string &path);
+
+    // Returns nullptr if there is no such array. A .npy file holds a single array, named "".
+    [[nodiscard]] const NpyArray* find(const std::string &name) const;
+
+private:
+    MappedFile file;
+    std::vector<std::string> names;
+    std::vector<NpyArray> arrays;
+
+    void readArchive(const std::string &path);
+};
+
+// Whether the file starts like a .npy file or a zip archive
+bool isNumpyFile(const std::string &path);
+
+// Writes .npz archives one array at a time, without compression, then the zip directory on close()
+class NpzWriter {
+public:
+    // Throws std::runtime_error if the file can't be opened
+    explicit NpzWriter(const std::string &path);
+
+    ~NpzWriter();
+
+    NpzWriter(const NpzWriter &) = delete;
+
+    NpzWriter &operator=(const NpzWriter &) = delete;
+
+    // Adds name.npy to the archive. descr is the NumPy type string, e.g. "<f8", and data holds the elements in C order.
+    void add(const std::string &name, const char* descr, const std::vector<size_t> &shape, const void* data);
+
+    // Writes the directory and closes the file. Throws std::runtime_error on write errors.
+    void close();
+
+private:
+    struct Entry {
+        std::string name;
+        uint32_t crc;
+        uint32_t size;
+        uint32_t offset;
+    };
+
+    FILE* out;
+    std::string path;
+    std::vector<Entry> entries;
+    uint64_t written = 0;
+    bool failed = false;
+
+    void write(const void* bytes, size_t length);
+};
+
+// Writes an array as a .npy file
+void writeNpy(const std::string &path, const char* descr, const std::vector<size_t> &shape, const void* data);
+
+// Reads sites from an (n, 2) array of floats or ints: a .npy file, or the "sites" array of a .npz archive. Sites are
+// numbered 1, 2, 3... unless the archive also has an (n,) "ids" array. Throws std::runtime_error on identifiers
+// outside [0, 2^31 - 1].
+std::vector<Vec2> readSitesNumpy(const std::string &path);
+
+// Writes the sites as an (n, 2) float64 .npy file
+void writeSitesNpy(const std::string &path, const std::vector<Vec2> &sites);
+
+// Writes a diagram and its dual to a .npz archive, with the arrays:
+//   sites                  (n, 2) float64, and site_ids (n,) int32
+//   vertices               (V, 2) float64
+//   edges                  (E, 2) int32, the origin and destination vertex of each pair of twin half-edges
+//   face_offsets           (F + 1,) int32, where face f is face_vertices[face_offsets[f]:face_offsets[f + 1]]
+//   face_vertices          int32 vertex indices around each face, counterclockwise, including box corners
+//   face_labels            (F,) int32, the site identifier of each face
+// and the same for the dual, prefixed with delaunay_, unless it is null. Throws std::runtime_error on write errors.
+void writeDiagramNpz(
+    const std::string &path,
+    const std::vector<Vec2> &sites,
+    const DCEL* voronoi,
+    const DCEL* delaunay
+);
+
+#endif //VORONOI_VIZ_NPY_HPP
@@ -0,0 +1,84 @@
+#ifndef VORONOI_VIZ_OUTPUTBUFFER_HPP
+#define VORONOI_VIZ_OUTPUTBUFFER_HPP
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include "utils/ByteOrder.hpp"
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+// Longest output of a single put call that goes through the buffer. A fixed double like 1e308 takes ~320 characters.
+#define OUTPUT_BUFFER_MAX_ITEM 512
+
+// Longest encoding of a 64-bit varint
+#define VARINT_MAX_BYTES 10
+
+void outputBufferTest1();
+
+// Text writer over a FILE*, which formats numbers with std::to_chars into a fixed buffer, and hands it to fwrite in
+// blocks. Nothing is allocated per call. The output goes through the FILE* itself, so it stays in order with printf
+// calls on the same stream as long as the buffer is flushed in between. It is flushed on destruction.
+class OutputBuffer {
+public:
+    explicit OutputBuffer(FILE* out = stdout);
+
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer &) = delete;
+
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    void put(char c) {
+        if (used == OUTPUT_BUFFER_SIZE) drain();
+        buffer[used++] = c;
+    }
+
+    void put(const char* text) {
+        put(text, strlen(text));
+    }
+
+    void put(const char* text, size_t length);
+
+    void putInt(int64_t value);
+
+    // Same digits as printf("%f")
+    void putFixed(double value);
+
+    // Shortest digits that read back as the same double
+    void putShortest(double value);
+
+    // "(x, y)", the same as Vec2::toString()
+    void putPoint(double x, double y);
+
+    // LEB128: 7 bits to a byte, least significant first, with the top bit set on every byte but the last
+    void putVarint(uint64_t value);
+
+    // Zigzag varint, which keeps small values of either sign short: 0, -1, 1, -2... go out as 0, 1, 2, 3...
+    void putSignedVarint(int64_t value);
+
+    // Bytes of a number, little-endian whatever the host
+    template<typename T>
+    void putBinary(T value) {
+        char bytes[sizeof(T)];
+        storeLittleEndian(bytes, value);
+        put(bytes, sizeof(T));
+    }
+
+    // Whether every write so far has gone through
+    [[nodiscard]] bool good() const;
+
+    // Hands the buffer to the FILE*, and flushes that too
+    void flush();
+
+private:
+    FILE* out;
+    size_t used = 0;
+    bool failed = false;
+    char buffer[OUTPUT_BUFFER_SIZE];
+
+    // Hands the buffer to the FILE*
+    void drain();
+};
+
+#endif //VORONOI_VIZ_OUTPUTBUFFER_HPP
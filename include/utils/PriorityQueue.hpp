@@ -4,9 +4,8 @@
 #include <algorithm>
 #include <vector>
 #include <stdexcept>
-#include <vector>
-#include <stdexcept>
 #include <functional>
+#include <utility>
 
 void priorityQueueTest1();
 
@@ -24,115 +23,196 @@ void priorityQueueTest7();
 
 void priorityQueueTest8();
 
-template<typename E, typename Comparator = std::less<E>>
+void priorityQueueTest9();
+
+// Implicit d-ary min-heap (with respect to the comparator). A wider heap is shallower, so sifting down touches fewer
+// levels, at the cost of more comparisons per level; 4 is a good default for pointer-sized elements.
+template<typename E, typename Comparator = std::less<E>, int Arity = 4>
 class PriorityQueue {
+    static_assert(Arity >= 2, "PriorityQueue arity must be at least 2");
+
 private:
     Comparator compare;
 
-    void heapifyUp(int index);
-
-    void heapifyDown(int index);
+    void heapifyUp(size_t index);
 
-    static int parent(int index);
+    void heapifyDown(size_t index);
 
-    static int left(int index);
+    static size_t parent(size_t index);
 
-    static int right(int index);
+    static size_t firstChild(size_t index);
 
 public:
     PriorityQueue() : compare(Comparator()) {};
 
     explicit PriorityQueue(Comparator comparator) : compare(comparator) {};
 
+    // Bulk build in O(n)
+    explicit PriorityQueue(std::vector<E> elements, Comparator comparator = Comparator());
+
+    void push(const E &element);
+
+    void push(E &&element);
+
+    template<typename... Args>
+    void emplace(Args &&... args);
+
     void add(E element);
 
-    E peek();
+    // Replaces the contents with the given elements, and restores the heap order in O(n)
+    void build(std::vector<E> elements);
+
+    const E &peek() const;
 
     E poll();
 
     [[nodiscard]] bool empty() const;
 
+    [[nodiscard]] size_t size() const;
+
+    void reserve(size_t capacity);
+
+    void clear();
+
     std::vector<E> heap;
 };
 
 
-template<typename E, typename Comparator>
-void PriorityQueue<E, Comparator>::heapifyUp(int index) {
-    while (index != 0 && compare(heap[index], heap[parent(index)])) {
-        std::swap(heap[parent(index)], heap[index]);
-        index = parent(index);
+template<typename E, typename Comparator, int Arity>
+PriorityQueue<E, Comparator, Arity>::PriorityQueue(std::vector<E> elements, Comparator comparator)
+    : compare(comparator) {
+    build(std::move(elements));
+}
+
+
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::heapifyUp(size_t index) {
+    // Move the element into a hole that travels up, instead of swapping at every level
+    E element = std::move(heap[index]);
+    while (index != 0) {
+        size_t p = parent(index);
+        if (!compare(element, heap[p])) break;
+        heap[index] = std::move(heap[p]);
+        index = p;
     }
+    heap[index] = std::move(element);
 }
 
 
-template<typename E, typename Comparator>
-void PriorityQueue<E, Comparator>::heapifyDown(int index) {
-    int argmin = index;
-    int leftChild = left(index);
-    int rightChild = right(index);
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::heapifyDown(size_t index) {
+    size_t n = heap.size();
+    E element = std::move(heap[index]);
 
-    if (leftChild < static_cast<int>(heap.size())
-        && compare(heap[leftChild], heap[argmin]))
-        argmin = leftChild;
-    if (rightChild < static_cast<int>(heap.size())
-        && compare(heap[rightChild], heap[argmin]))
-        argmin = rightChild;
+    while (true) {
+        size_t first = firstChild(index);
+        if (first >= n) break;
 
-    if (argmin == index) return;
+        // Find the smallest of the (up to) Arity children
+        size_t last = std::min(first + Arity, n);
+        size_t argmin = first;
+        for (size_t c = first + 1; c < last; c++) {
+            if (compare(heap[c], heap[argmin])) argmin = c;
+        }
 
-    std::swap(heap[index], heap[argmin]);
-    heapifyDown(argmin);
+        if (!compare(heap[argmin], element)) break;
+        heap[index] = std::move(heap[argmin]);
+        index = argmin;
+    }
+    heap[index] = std::move(element);
 }
 
 
-template<typename E, typename Comparator>
-int PriorityQueue<E, Comparator>::parent(int index) {
-    return (index - 1) / 2;
+template<typename E, typename Comparator, int Arity>
+size_t PriorityQueue<E, Comparator, Arity>::parent(size_t index) {
+    return (index - 1) / Arity;
 }
 
 
-template<typename E, typename Comparator>
-int PriorityQueue<E, Comparator>::left(int index) {
-    return 2 * index + 1;
+template<typename E, typename Comparator, int Arity>
+size_t PriorityQueue<E, Comparator, Arity>::firstChild(size_t index) {
+    return Arity * index + 1;
 }
 
 
-template<typename E, typename Comparator>
-int PriorityQueue<E, Comparator>::right(int index) {
-    return 2 * index + 2;
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::push(const E &element) {
+    heap.push_back(element);
+    heapifyUp(heap.size() - 1);
 }
 
 
-template<typename E, typename Comparator>
-void PriorityQueue<E, Comparator>::add(E element) {
-    heap.push_back(element);
-    int index = static_cast<int>(heap.size()) - 1;
-    heapifyUp(index);
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::push(E &&element) {
+    heap.push_back(std::move(element));
+    heapifyUp(heap.size() - 1);
 }
 
 
-template<typename E, typename Comparator>
-E PriorityQueue<E, Comparator>::peek() {
+template<typename E, typename Comparator, int Arity>
+template<typename... Args>
+void PriorityQueue<E, Comparator, Arity>::emplace(Args &&... args) {
+    heap.emplace_back(std::forward<Args>(args)...);
+    heapifyUp(heap.size() - 1);
+}
+
+
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::add(E element) {
+    push(std::move(element));
+}
+
+
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::build(std::vector<E> elements) {
+    heap = std::move(elements);
+    if (heap.size() < 2) return;
+
+    // Floyd's construction: sift down every internal node, from the last one up to the root
+    for (size_t i = parent(heap.size() - 1) + 1; i-- > 0;) heapifyDown(i);
+}
+
+
+template<typename E, typename Comparator, int Arity>
+const E &PriorityQueue<E, Comparator, Arity>::peek() const {
     if (heap.empty()) throw std::out_of_range("PriorityQueue is empty");
     return heap[0];
 }
 
 
-template<typename E, typename Comparator>
-E PriorityQueue<E, Comparator>::poll() {
+template<typename E, typename Comparator, int Arity>
+E PriorityQueue<E, Comparator, Arity>::poll() {
     if (heap.empty()) throw std::out_of_range("PriorityQueue is empty");
 
-    E min = heap[0];
-    heap[0] = heap.back();
+    E min = std::move(heap[0]);
+    if (heap.size() > 1) heap[0] = std::move(heap.back());
     heap.pop_back();
     if (!heap.empty()) heapifyDown(0);
     return min;
 }
 
 
-template<typename E, typename Comparator>
-bool PriorityQueue<E, Comparator>::empty() const {
+template<typename E, typename Comparator, int Arity>
+bool PriorityQueue<E, Comparator, Arity>::empty() const {
     return heap.empty();
 }
 
+
+template<typename E, typename Comparator, int Arity>
+size_t PriorityQueue<E, Comparator, Arity>::size() const {
+    return heap.size();
+}
+
+
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::reserve(size_t capacity) {
+    heap.reserve(capacity);
+}
+
+
+template<typename E, typename Comparator, int Arity>
+void PriorityQueue<E, Comparator, Arity>::clear() {
+    heap.clear();
+}
+
 #endif
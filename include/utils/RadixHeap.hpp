@@ -0,0 +1,140 @@
+#ifndef VORONOI_VIZ_RADIXHEAP_HPP
+#define VORONOI_VIZ_RADIXHEAP_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+void radixHeapTest1();
+
+void radixHeapTest2();
+
+// Maps a double to an unsigned key with the same ordering, so that a < b iff orderPreservingBits(a) <
+// orderPreservingBits(b). Positive numbers get their sign bit set, and negative numbers are flipped entirely.
+inline uint64_t orderPreservingBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x8000000000000000ULL) ? ~bits : bits | 0x8000000000000000ULL;
+}
+
+// Monotone min-heap on 64-bit keys. A pushed key must never be smaller than the last key polled, which lets elements
+// sit in one of 65 buckets, by the highest bit at which their key differs from that last key. Each element is moved
+// down at most 64 times over its lifetime, and there are no comparisons between elements.
+template<typename E>
+class RadixHeap {
+public:
+    void push(uint64_t key, const E &element);
+
+    // Key of the minimum element
+    uint64_t peekKey();
+
+    const E &peek();
+
+    E poll();
+
+    // Last key polled, which is a lower bound for every key that can still be pushed
+    [[nodiscard]] uint64_t lastKey() const;
+
+    [[nodiscard]] bool empty() const;
+
+    [[nodiscard]] size_t size() const;
+
+    void clear();
+
+private:
+    std::vector<std::pair<uint64_t, E>> buckets[65];
+    uint64_t last = 0;
+    size_t count = 0;
+
+    [[nodiscard]] int bucketIndex(uint64_t key) const;
+
+    // Makes sure that bucket 0 holds the minimum elements
+    void redistribute();
+};
+
+
+template<typename E>
+int RadixHeap<E>::bucketIndex(uint64_t key) const {
+    return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+}
+
+
+template<typename E>
+void RadixHeap<E>::push(uint64_t key, const E &element) {
+    if (key < last) throw std::invalid_argument("RadixHeap key is smaller than the last polled key");
+    buckets[bucketIndex(key)].emplace_back(key, element);
+    count++;
+}
+
+
+template<typename E>
+void RadixHeap<E>::redistribute() {
+    if (!buckets[0].empty()) return;
+    if (count == 0) throw std::out_of_range("RadixHeap is empty");
+
+    int i = 1;
+    while (buckets[i].empty()) i++;
+
+    // The minimum of the first non-empty bucket becomes the new last key. Every other element in that bucket agrees
+    // with it above bit i - 1, so they all move to lower buckets.
+    uint64_t minKey = buckets[i][0].first;
+    for (const auto &entry: buckets[i]) if (entry.first < minKey) minKey = entry.first;
+
+    last = minKey;
+    for (auto &entry: buckets[i]) buckets[bucketIndex(entry.first)].push_back(std::move(entry));
+    buckets[i].clear();
+}
+
+
+template<typename E>
+uint64_t RadixHeap<E>::peekKey() {
+    redistribute();
+    return last;
+}
+
+
+template<typename E>
+const E &RadixHeap<E>::peek() {
+    redistribute();
+    return buckets[0].back().second;
+}
+
+
+template<typename E>
+E RadixHeap<E>::poll() {
+    redistribute();
+    E element = std::move(buckets[0].back().second);
+    buckets[0].pop_back();
+    count--;
+    return element;
+}
+
+
+template<typename E>
+uint64_t RadixHeap<E>::lastKey() const {
+    return last;
+}
+
+
+template<typename E>
+bool RadixHeap<E>::empty() const {
+    return count == 0;
+}
+
+
+template<typename E>
+size_t RadixHeap<E>::size() const {
+    return count;
+}
+
+
+template<typename E>
+void RadixHeap<E>::clear() {
+    for (auto &bucket: buckets) bucket.clear();
+    last = 0;
+    count = 0;
+}
+
+#endif //VORONOI_VIZ_RADIXHEAP_HPP
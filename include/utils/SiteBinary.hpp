@@ -0,0 +1,81 @@
+#ifndef VORONOI_VIZ_SITEBINARY_HPP
+#define VORONOI_VIZ_SITEBINARY_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "utils/math/Vec2.hpp"
+#include "utils/files.hpp"
+
+// Binary site format, little-endian throughout, whatever the order of the host that writes or reads it:
+//
+//   offset  size  field
+//   0       8     magic, "VVSITES" followed by a NUL byte
+//   8       4     uint32 version, currently 1
+//   12      4     uint32 flags, a combination of the SITE_BINARY_* bits below
+//   16      8     uint64 number of sites n
+//   24            x coordinates, n float64 (or n float32 with SITE_BINARY_FLOAT32)
+//                 y coordinates, same layout
+//                 identifiers, n int32, only with SITE_BINARY_IDS
+//
+// Every array starts aligned to the size of its elements, so a mapping of the file can be read in place. Without
+// SITE_BINARY_IDS, sites are numbered 1, 2, 3... in file order like the text format. Identifiers must be unique and
+// non-negative, and coordinates finite.
+#define SITE_BINARY_MAGIC "VVSITES"
+#define SITE_BINARY_VERSION 1
+#define SITE_BINARY_HEADER_SIZE 24
+
+// Coordinates are stored as float32 instead of float64
+#define SITE_BINARY_FLOAT32 0x1
+
+// An identifier array follows the coordinates
+#define SITE_BINARY_IDS 0x2
+
+void siteBinaryTest1();
+
+void siteBinaryBenchmark();
+
+struct SiteBinaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t numSites;
+};
+
+// Read-only view of a binary site file, straight over its memory mapping. Throws std::runtime_error if the file can't
+// be mapped, if its header or size don't match the format, or if a site breaks the rules above. Checking the sites
+// reads every one of them once, and sorts a copy of the identifiers when they aren't 1, 2, 3...
+class MappedSites {
+public:
+    explicit MappedSites(const std::string &path);
+
+    [[nodiscard]] int size() const;
+
+    [[nodiscard]] double x(int i) const;
+
+    [[nodiscard]] double y(int i) const;
+
+    [[nodiscard]] int identifier(int i) const;
+
+    [[nodiscard]] bool singlePrecision() const;
+
+private:
+    MappedFile file;
+    int numSites = 0;
+    uint32_t flags = 0;
+    const char* xs = nullptr;
+    const char* ys = nullptr;
+    const char* ids = nullptr;
+};
+
+// Whether the file starts with the binary magic, as opposed to being a text site file
+bool isSiteBinaryFile(const std::string &path);
+
+// Writes sites in the binary format. The identifier array is only written if the identifiers are not 1, 2, 3...
+// Single precision rounds the coordinates to the nearest float32. Throws std::runtime_error on write errors.
+void writeSiteBinary(const std::string &path, const std::vector<Vec2> &sites, bool singlePrecision = false);
+
+// Converts a text site file, in any format parseSites accepts, to the binary format. Returns the number of sites.
+int convertSitesToBinary(const std::string &textPath, const std::string &binaryPath, bool singlePrecision = false);
+
+#endif //VORONOI_VIZ_SITEBINARY_HPP
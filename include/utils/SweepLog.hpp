@@ -0,0 +1,16 @@
+#ifndef VORONOI_VIZ_SWEEPLOG_HPP
+#define VORONOI_VIZ_SWEEPLOG_HPP
+
+#include <cstdio>
+
+// The sweep narrates every event on stdout. Builds that embed it in another process, like the shared library, define
+// VORONOI_NO_SWEEP_LOG, which compiles the narration out. The arguments are still type-checked, but not evaluated.
+#ifdef VORONOI_NO_SWEEP_LOG
+#define SWEEP_LOG_ENABLED 0
+#define SWEEP_LOG(...) do { if (false) printf(__VA_ARGS__); } while (false)
+#else
+#define SWEEP_LOG_ENABLED 1
+#define SWEEP_LOG(...) printf(__VA_ARGS__)
+#endif
+
+#endif //VORONOI_VIZ_SWEEPLOG_HPP
@@ -0,0 +1,83 @@
+#ifndef VORONOI_VIZ_THREADPOOL_HPP
+#define VORONOI_VIZ_THREADPOOL_HPP
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+void threadPoolTest1();
+
+void threadPoolTest2();
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int numThreads = defaultThreadCount());
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Number of threads that work can be spread over, including the calling thread
+    [[nodiscard]] int size() const;
+
+    // Splits [0, n) into contiguous chunks of at least minChunk elements, and runs fn(begin, end, chunkIndex) on
+    // each of them concurrently. Chunk 0 runs on the calling thread, and this call blocks until every chunk is done.
+    // Chunks are numbered left to right, so per-chunk outputs can be merged back in a deterministic order.
+    // If chunks throw, the first exception is rethrown here, once every chunk is done.
+    void parallelFor(int n, const std::function<void(int, int, int)> &fn, int minChunk = 1);
+
+    // Number of chunks parallelFor(n, ..., minChunk) would split its range into
+    [[nodiscard]] int numChunks(int n, int minChunk = 1) const;
+
+    static int defaultThreadCount();
+
+    // Process-wide pool, lazily started on first use
+    static ThreadPool &shared();
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+
+// Sorts [first, last) by sorting one chunk per thread, then merging the sorted chunks pairwise.
+// Equivalent to std::stable_sort when the comparator is a strict total order on the elements.
+template<typename RandomIt, typename Compare>
+void parallelSort(RandomIt first, RandomIt last, Compare comp, ThreadPool &pool, int minChunk = 4096) {
+    int n = static_cast<int>(last - first);
+    int chunks = pool.numChunks(n, minChunk);
+    if (chunks <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // Each chunk only writes its own start, so that neighbours never write the same bound
+    std::vector<int> bounds(chunks + 1);
+    bounds[chunks] = n;
+    pool.parallelFor(n, [&](int begin, int end, int chunk) {
+        std::sort(first + begin, first + end, comp);
+        bounds[chunk] = begin;
+    }, minChunk);
+
+    // Merge neighbouring runs until a single one remains
+    for (int width = 1; width < chunks; width *= 2) {
+        for (int i = 0; i + width < chunks; i += 2 * width) {
+            int mid = bounds[i + width];
+            int end = bounds[std::min(i + 2 * width, chunks)];
+            std::inplace_merge(first + bounds[i], first + mid, first + end, comp);
+        }
+    }
+}
+
+#endif //VORONOI_VIZ_THREADPOOL_HPP
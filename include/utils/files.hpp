@@ -3,11 +3,75 @@
 
 #include <string>
 #include <vector>
+#include <stdexcept>
 #include "utils/math/Vec2.hpp"
+#include "utils/ThreadPool.hpp"
+
+// Smallest piece of text worth parsing on its own thread
+#define PARALLEL_PARSE_MIN_CHUNK_BYTES (1 << 20)
+
+void siteParserTest1();
+
+void siteParserTest2();
+
+void siteParserBenchmark();
 
 const char* readFile(const std::string &filePath);
 
-std::vector<Vec2> parseSites(const std::string &filepath);
+// Read-only memory mapping of a whole file, unmapped on destruction. Throws std::runtime_error if the file can't be
+// opened or mapped. An empty file maps to an empty range.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] const char* data() const;
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    int fd = -1;
+    void* mapping = nullptr;
+    size_t length = 0;
+};
+
+// Malformed site input, with the 1-based line it was found on
+class SiteParseError : public std::runtime_error {
+public:
+    int line;
+
+    // The message, without the line
+    std::string reason;
+
+    SiteParseError(int line, const std::string &reason);
+};
+
+// Parses the sites of a text file, numbering them 1, 2, 3... in file order. Accepted formats, which can be mixed:
+//   (x, y) (x, y) ...    any number of parenthesized pairs per line
+//   x y                  one whitespace-separated pair per line
+//   x,y                  one comma-separated pair per line, after an optional header line
+// No record spans a line break. Large files are parsed in chunks over the pool.
+// Throws SiteParseError on malformed input, and std::runtime_error if the file can't be read.
+std::vector<Vec2> parseSites(const std::string &filepath, ThreadPool &pool = ThreadPool::shared());
+
+// Parses the sites in [begin, end), appending them to sites. Identifiers continue from sites.size() + 1, and
+// firstLine is the line number of begin, for error messages. A header line is only skipped if allowHeader is set.
+void parseSiteText(
+    const char* begin,
+    const char* end,
+    std::vector<Vec2> &sites,
+    int firstLine = 1,
+    bool allowHeader = true
+);
+
+// Same as parseSiteText, but splits the text at line breaks into one chunk per thread, of at least
+// PARALLEL_PARSE_MIN_CHUNK_BYTES each. The result, identifiers included, is the same as a sequential parse.
+void parseSiteTextParallel(const char* begin, const char* end, std::vector<Vec2> &sites, ThreadPool &pool);
 
 
 #endif //VORONOI_VIZ_FILES_HPP
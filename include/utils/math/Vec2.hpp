@@ -7,6 +7,10 @@
 
 #define VEC2_PLACEHOLDER (1.234567e8f)
 
+// toString() results are kept in a ring of this many buffers per thread, and are overwritten after as many more calls
+#define VEC2_STRING_BUFFERS 8
+#define VEC2_STRING_SIZE 128
+
 class Vec2 {
 public:
     double x;
@@ -36,6 +40,7 @@ public:
 
     [[nodiscard]] Vec2 normalized() const;
 
+    // Not to be freed, and only valid for the next VEC2_STRING_BUFFERS calls on the thread
     [[nodiscard]] const char* toString() const;
 
     static Vec2 infinity();
@@ -1,8 +1,11 @@
 #ifndef VORONOI_VIZ_MATHEMATICS_HPP
 #define VORONOI_VIZ_MATHEMATICS_HPP
 
+#include <array>
 #include <stdexcept>
+#include <vector>
 #include <limits>
+#include <utility>
 #include "Vec2.hpp"
 
 #define NUMERICAL_TOLERANCE 1e-7
@@ -19,7 +22,7 @@ Vec2 computeCircleCenter(const Vec2 &a, const Vec2 &b, const Vec2 &c);
 
 double pointDirectrixParabola(double x, Vec2 focus, double directrix);
 
-double pointDirectrixGradient(double x, Vec2 focus, double directrix);
+Vec2 pointDirectrixTangent(double x, Vec2 focus, double directrix);
 
 double pointDirectrixIntersectionX(
     const Vec2 &leftParabolaFocus,
@@ -27,7 +30,16 @@ double pointDirectrixIntersectionX(
     double directrix
 );
 
-double perpendicularBisectorSlope(const Vec2 &leftSite, const Vec2 &rightSite);
+Vec2 perpendicularBisectorDirection(const Vec2 &leftSite, const Vec2 &rightSite);
+
+Vec2 rightwardDirection(double run, double rise);
+
+double pseudoAngle(const Vec2 &direction);
+
+bool allColinear(const std::vector<Vec2> &points);
+
+// Positions of two points that are softEquals, lowest first, or {-1, -1} if there are none
+std::pair<int, int> findCoincidentPoints(const std::vector<Vec2> &points);
 
 bool softEquals(double x, double y, double tolerance = NUMERICAL_TOLERANCE);
 
@@ -45,10 +57,12 @@ std::array<float, 16> orthographicProjection(
     float near, float far
 );
 
-Vec2 rayIntersectBox(Vec2 pos, double angle, Vec2 bottomLeft, Vec2 topRight);
-
-double normalizeRadians(double angle);
-
-double addRadians(double angle1, double angle2);
+void clipRaysToBox(
+    const std::vector<Vec2> &origins,
+    const std::vector<Vec2> &directions,
+    Vec2 bottomLeft,
+    Vec2 topRight,
+    std::vector<Vec2> &exits
+);
 
 #endif //VORONOI_VIZ_MATHEMATICS_HPP
@@ -1,6 +1,6 @@
 #!/bin/bash
 
-rm -f dump
+rm -f dump.npz sweep.trace
 
 if [ $# -ne 1 ]; then
     echo "Usage: $0 <path>"
@@ -16,4 +16,4 @@ fi
 
 python external/animation.py
 
-rm -f dump
\ No newline at end of file
+rm -f dump.npz sweep.trace
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "api/voronoi.h"
+#include "fortune/Fortune.hpp"
+#include "fortune/SweepPlanner.hpp"
+#include "geometry/DCEL.hpp"
+
+struct VoronoiContext {
+    FortuneSweeper sweeper;
+
+    // Sites of the current diagram, reused as the buffer of the next one
+    std::vector<Vec2> sites;
+
+    // Owned by the factory of the sweeper, which keeps them between computations
+    const DCEL* voronoi = nullptr;
+    const DCEL* delaunay = nullptr;
+
+    // Also set by the const calls
+    mutable std::string lastError;
+};
+
+
+// Sets the message of the context, and returns the code
+static int fail(const VoronoiContext* context, int code, const std::string &message) {
+    context->lastError = message;
+    return code;
+}
+
+static const DCEL* diagramOf(const VoronoiContext* context, int diagram) {
+    if (diagram == VORONOI_DIAGRAM_VORONOI) return context->voronoi;
+    if (diagram == VORONOI_DIAGRAM_DELAUNAY) return context->delaunay;
+    return nullptr;
+}
+
+// Copies the array of the diagram unless the buffer is null
+template<typename T>
+static void copyArray(T* buffer, const std::vector<T> &array) {
+    if (buffer != nullptr && !array.empty()) memcpy(buffer, array.data(), array.size() * sizeof(T));
+}
+
+
+VoronoiContext* voronoiCreateContext() {
+    return new(std::nothrow) VoronoiContext();
+}
+
+void voronoiDestroyContext(VoronoiContext* context) {
+    delete context;
+}
+
+int voronoiComputeStrided(
+    VoronoiContext* context,
+    const double* x,
+    const double* y,
+    int64_t count,
+    int64_t xStride,
+    int64_t yStride
+) {
+    if (context == nullptr) return VORONOI_ERROR_INVALID_ARGUMENT;
+    context->voronoi = nullptr;
+    context->delaunay = nullptr;
+    context->lastError.clear();
+    if (x == nullptr || y == nullptr) return fail(context, VORONOI_ERROR_INVALID_ARGUMENT, "Null coordinate buffer");
+    if (count < 2 || count > INT32_MAX) {
+        return fail(context, VORONOI_ERROR_INVALID_ARGUMENT, "Need between 2 and 2^31 - 1 sites");
+    }
+
+    try {
+        // The strides are in bytes, so the doubles may sit anywhere, and are copied out rather than dereferenced
+        auto* xBytes = reinterpret_cast<const char*>(x);
+        auto* yBytes = reinterpret_cast<const char*>(y);
+        context->sites.clear();
+        context->sites.reserve(count);
+        for (int64_t i = 0; i < count; i++) {
+            double siteX;
+            double siteY;
+            memcpy(&siteX, xBytes + i * xStride, sizeof(double));
+            memcpy(&siteY, yBytes + i * yStride, sizeof(double));
+            if (!std::isfinite(siteX) || !std::isfinite(siteY)) {
+                std::string site = std::to_string(i + 1);
+                return fail(context, VORONOI_ERROR_INVALID_ARGUMENT, "Site " + site + " is not finite");
+            }
+            context->sites.emplace_back(siteX, siteY, static_cast<int>(i + 1));
+        }
+
+        // The sweep asserts on coincident sites, rather than failing in a way that could be caught
+        InputProfile profile = profileInput(context->sites);
+        if (profile.coincidentSite >= 0) {
+            std::string site = std::to_string(profile.coincidentSite + 1);
+            std::string other = std::to_string(profile.coincidentWith + 1);
+            return fail(context, VORONOI_ERROR_INVALID_ARGUMENT, "Sites " + site + " and " + other + " coincide");
+        }
+
+        FortuneSweeper &sweeper = context->sweeper;
+        sweeper.reset(context->sites);
+        sweeper.setPlan(planSweep(profile));
+        context->voronoi = sweeper.computeAll();
+        context->delaunay = sweeper.factory->buildDualGraph();
+    } catch (std::bad_alloc &) {
+        context->voronoi = nullptr;
+        return fail(context, VORONOI_ERROR_COMPUTE, "Out of memory");
+    } catch (std::exception &e) {
+        context->voronoi = nullptr;
+        return fail(context, VORONOI_ERROR_COMPUTE, e.what());
+    }
+    return VORONOI_OK;
+}
+
+int voronoiComputeInterleaved(VoronoiContext* context, const double* xy, int64_t count) {
+    auto stride = static_cast<int64_t>(2 * sizeof(double));
+    return voronoiComputeStrided(context, xy, xy == nullptr ? nullptr : xy + 1, count, stride, stride);
+}
+
+int voronoiGetDiagram(const VoronoiContext* context, int diagram, VoronoiDCELView* view) {
+    if (context == nullptr) return VORONOI_ERROR_INVALID_ARGUMENT;
+    if (view == nullptr || (diagram != VORONOI_DIAGRAM_VORONOI && diagram != VORONOI_DIAGRAM_DELAUNAY)) {
+        return fail(context, VORONOI_ERROR_INVALID_ARGUMENT, "Invalid diagram or view");
+    }
+    const DCEL* dcel = diagramOf(context, diagram);
+    if (dcel == nullptr) return fail(context, VORONOI_ERROR_NO_DIAGRAM, "No diagram has been computed");
+
+    view->numVertices = dcel->numVertices();
+    view->numHalfEdges = dcel->numHalfEdges();
+    view->numFaces = dcel->numFaces();
+
+    view->vertexX = dcel->vertexX.data();
+    view->vertexY = dcel->vertexY.data();
+    view->vertexLabel = dcel->vertexLabel.data();
+    view->vertexIncidentEdge = dcel->vertexIncidentEdge.data();
+    view->vertexIsBoundary = dcel->vertexIsBoundary.data();
+
+    view->edgeOrigin = dcel->edgeOrigin.data();
+    view->edgeNext = dcel->edgeNext.data();
+    view->edgePrev = dcel->edgePrev.data();
+    view->edgeFace = dcel->edgeFace.data();
+    view->edgeUnbounded = dcel->edgeUnbounded.data();
+
+    view->faceLabel = dcel->faceLabel.data();
+    view->faceOuter = dcel->faceOuter.data();
+    view->faceInner = dcel->faceInner.data();
+    view->faceUnbounded = dcel->faceUnbounded.data();
+
+    view->bottomLeftX = dcel->bottomLeftBounds.x;
+    view->bottomLeftY = dcel->bottomLeftBounds.y;
+    view->topRightX = dcel->topRightBounds.x;
+    view->topRightY = dcel->topRightBounds.y;
+    return VORONOI_OK;
+}
+
+int voronoiCopyDiagram(const VoronoiContext* context, int diagram, VoronoiDCELBuffers* buffers) {
+    if (context == nullptr) return VORONOI_ERROR_INVALID_ARGUMENT;
+    if (buffers == nullptr || (diagram != VORONOI_DIAGRAM_VORONOI && diagram != VORONOI_DIAGRAM_DELAUNAY)) {
+        return fail(context, VORONOI_ERROR_INVALID_ARGUMENT, "Invalid diagram or buffers");
+    }
+    const DCEL* dcel = diagramOf(context, diagram);
+    if (dcel == nullptr) return fail(context, VORONOI_ERROR_NO_DIAGRAM, "No diagram has been computed");
+
+    // Nothing is written unless everything fits
+    bool fits = buffers->numVertices >= dcel->numVertices()
+                && buffers->numHalfEdges >= dcel->numHalfEdges()
+                && buffers->numFaces >= dcel->numFaces();
+    buffers->numVertices = dcel->numVertices();
+    buffers->numHalfEdges = dcel->numHalfEdges();
+    buffers->numFaces = dcel->numFaces();
+    if (!fits) return fail(context, VORONOI_ERROR_BUFFER_TOO_SMALL, "Buffers too small for the diagram");
+
+    copyArray(buffers->vertexX, dcel->vertexX);
+    copyArray(buffers->vertexY, dcel->vertexY);
+    copyArray(buffers->vertexLabel, dcel->vertexLabel);
+    copyArray(buffers->vertexIncidentEdge, dcel->vertexIncidentEdge);
+    copyArray(buffers->vertexIsBoundary, dcel->vertexIsBoundary);
+
+    copyArray(buffers->edgeOrigin, dcel->edgeOrigin);
+    copyArray(buffers->edgeNext, dcel->edgeNext);
+    copyArray(buffers->edgePrev, dcel->edgePrev);
+    copyArray(buffers->edgeFace, dcel->edgeFace);
+    copyArray(buffers->edgeUnbounded, dcel->edgeUnbounded);
+
+    copyArray(buffers->faceLabel, dcel->faceLabel);
+    copyArray(buffers->faceOuter, dcel->faceOuter);
+    copyArray(buffers->faceInner, dcel->faceInner);
+    copyArray(buffers->faceUnbounded, dcel->faceUnbounded);
+    return VORONOI_OK;
+}
+
+const char* voronoiLastError(const VoronoiContext* context) {
+    if (context == nullptr) return "Null context";
+    return context->lastError.c_str();
+}
+
+
+void voronoiApiTest1() {
+    std::cout << "Testing the C API, case 1" << std::endl;
+
+    // A 6x6 lattice, as interleaved pairs, and as the columns of a record array with a weight in between
+    struct Record {
+        double x;
+        double weight;
+        double y;
+    };
+    std::vector<double> pairs;
+    std::vector<Record> records;
+    std::vector<Vec2> sites;
+    for (int i = 0; i < 36; i++) {
+        pairs.push_back(i / 6);
+        pairs.push_back(i % 6);
+        records.push_back({static_cast<double>(i / 6), 1.0, static_cast<double>(i % 6)});
+        sites.emplace_back(i / 6, i % 6, i + 1);
+    }
+    FortuneSweeper reference(sites);
+    DCEL* expected = reference.computeAll();
+
+    VoronoiContext* context = voronoiCreateContext();
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_VORONOI, nullptr) == VORONOI_ERROR_INVALID_ARGUMENT);
+    VoronoiDCELView view {};
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_VORONOI, &view) == VORONOI_ERROR_NO_DIAGRAM);
+
+    assert(voronoiComputeInterleaved(context, pairs.data(), 36) == VORONOI_OK);
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_VORONOI, &view) == VORONOI_OK);
+    assert(view.numVertices == expected->numVertices() && view.numFaces == 36);
+    assert(std::vector<double>(view.vertexX, view.vertexX + view.numVertices) == expected->vertexX);
+    assert(std::vector<int32_t>(view.edgeNext, view.edgeNext + view.numHalfEdges) == expected->edgeNext);
+
+    // The same diagram from the strided columns, copied out, after a failed attempt with too little room
+    int64_t stride = sizeof(Record);
+    assert(voronoiComputeStrided(context, &records[0].x, &records[0].y, 36, stride, stride) == VORONOI_OK);
+    std::vector<double> vertexX(1);
+    std::vector<int32_t> edgeNext(1);
+    VoronoiDCELBuffers buffers {};
+    buffers.numVertices = 1;
+    buffers.numHalfEdges = 1;
+    buffers.vertexX = vertexX.data();
+    buffers.edgeNext = edgeNext.data();
+    assert(voronoiCopyDiagram(context, VORONOI_DIAGRAM_VORONOI, &buffers) == VORONOI_ERROR_BUFFER_TOO_SMALL);
+    assert(buffers.numVertices == expected->numVertices() && buffers.numHalfEdges == expected->numHalfEdges());
+    vertexX.resize(buffers.numVertices);
+    edgeNext.resize(buffers.numHalfEdges);
+    buffers.vertexX = vertexX.data();
+    buffers.edgeNext = edgeNext.data();
+    assert(voronoiCopyDiagram(context, VORONOI_DIAGRAM_VORONOI, &buffers) == VORONOI_OK);
+    assert(vertexX == expected->vertexX && edgeNext == expected->edgeNext);
+
+    // The triangulation has a vertex per site, labelled by input position
+    VoronoiDCELView triangulation {};
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_DELAUNAY, &triangulation) == VORONOI_OK);
+    assert(triangulation.numVertices == 36 && triangulation.vertexLabel[7] == 8);
+    assert(triangulation.vertexX[7] == 1 && triangulation.vertexY[7] == 1);
+
+    // Bad input fails without a diagram, and says why
+    records[3].y = NAN;
+    assert(voronoiComputeStrided(context, &records[0].x, &records[0].y, 36, stride, stride)
+           == VORONOI_ERROR_INVALID_ARGUMENT);
+    assert(strlen(voronoiLastError(context)) > 0);
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_VORONOI, &view) == VORONOI_ERROR_NO_DIAGRAM);
+
+    // Coincident sites, which the sweep would assert on, are turned away before it starts
+    std::vector<double> coincident = {0, 0, 1, 1, 1, 1, 2, 0.5};
+    assert(voronoiComputeInterleaved(context, coincident.data(), 4) == VORONOI_ERROR_INVALID_ARGUMENT);
+    assert(std::string(voronoiLastError(context)) == "Sites 2 and 3 coincide");
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_DELAUNAY, &view) == VORONOI_ERROR_NO_DIAGRAM);
+    coincident = {0, 0, 0, 0, 1, 1};
+    assert(voronoiComputeInterleaved(context, coincident.data(), 3) == VORONOI_ERROR_INVALID_ARGUMENT);
+    assert(std::string(voronoiLastError(context)) == "Sites 1 and 2 coincide");
+    coincident = {1, 1, 0, 0, 1 + 1e-8, 1 - 1e-8};
+    assert(voronoiComputeInterleaved(context, coincident.data(), 3) == VORONOI_ERROR_INVALID_ARGUMENT);
+    assert(std::string(voronoiLastError(context)) == "Sites 1 and 3 coincide");
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_VORONOI, &view) == VORONOI_ERROR_NO_DIAGRAM);
+
+    // The context still works after the failures
+    assert(voronoiComputeInterleaved(context, pairs.data(), 36) == VORONOI_OK);
+    assert(voronoiGetDiagram(context, VORONOI_DIAGRAM_VORONOI, &view) == VORONOI_OK && view.numFaces == 36);
+
+    voronoiDestroyContext(context);
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <cstdio>
+#include <unistd.h>
+#include "benchmarks.hpp"
+#include "fortune/Fortune.hpp"
+#include "fortune/SweepPlanner.hpp"
+#include "utils/LinkedSplayTree.hpp"
+#include "geometry/CompactVoronoi.hpp"
+#include "utils/files.hpp"
+#include "geometry/DCEL.hpp"
+#include "geometry/GeometryWriters.hpp"
+#include "geometry/DCELArchive.hpp"
+#include "geometry/DCELSnapshot.hpp"
+#include "utils/SiteBinary.hpp"
+
+
+void runAllBenchmarks() {
+    std::cout << "-- Running benchmarks --\n" << std::endl;
+
+    siteParserBenchmark();
+    siteBinaryBenchmark();
+    dcelOutputBenchmark();
+    dcelArchiveBenchmark();
+    dcelSnapshotBenchmark();
+    eventQueueBenchmark();
+    linkedSplayTreeBenchmark();
+    gridSweepBenchmark();
+    sweepPlannerBenchmark();
+    compactVoronoiBenchmark();
+
+    std::cout << "\n-- Benchmarks finished --\n" << std::endl;
+}
+
+
+static int savedStdout = -1;
+
+void muteStdout() {
+    if (savedStdout >= 0) return;
+    fflush(stdout);
+    savedStdout = dup(fileno(stdout));
+    if (freopen("/dev/null", "w", stdout) == nullptr) {
+        close(savedStdout);
+        savedStdout = -1;
+    }
+}
+
+void unmuteStdout() {
+    if (savedStdout < 0) return;
+    fflush(stdout);
+    dup2(savedStdout, fileno(stdout));
+    close(savedStdout);
+    savedStdout = -1;
+}
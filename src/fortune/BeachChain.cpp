@@ -1,5 +1,6 @@
 #include <cassert>
 #include <cmath>
+#include <cstdio>
 #include "fortune/BeachChain.hpp"
 
 
@@ -19,7 +20,11 @@ double BeachChain::fieldOrdering(double t) const {
 }
 
 const char* BeachChain::toString() const {
-    char* result = new char[64];  // %d can only be <11 bytes
+    // Same ring of buffers as Vec2::toString()
+    static thread_local char buffers[VEC2_STRING_BUFFERS][VEC2_STRING_SIZE];
+    static thread_local int next = 0;
+    char* result = buffers[next];
+    next = (next + 1) % VEC2_STRING_BUFFERS;
 
     if (isArc) sprintf(result, "Arc[%d]", focus->identifier);
     else sprintf(result, "BP[%d,%d]", leftSite->identifier, rightSite->identifier);
@@ -28,14 +33,6 @@ const char* BeachChain::toString() const {
 }
 
 
-TreeValueFacade* TreeValueFacade::breakpointPtr(VertexPair* ptr) {
-    return new TreeValueFacade({ptr, nullptr});
-}
-
-TreeValueFacade* TreeValueFacade::arcPtr(Event* ptr) {
-    return new TreeValueFacade({nullptr, ptr});
-}
-
 bool ChainComparator::operator()(BeachChain* a, BeachChain* b) const {
     assert(a->sweepY == b->sweepY);
     double orderingParameter = *a->sweepY;
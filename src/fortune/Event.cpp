@@ -1,5 +1,9 @@
 #include <cassert>
+#include <chrono>
+#include <random>
 #include "fortune/Event.hpp"
+#include "fortune/EventQueue.hpp"
+#include "utils/SweepLog.hpp"
 
 double Event::x() const {
     return pos.x;
@@ -9,13 +13,125 @@ double Event::y() const {
     return pos.y;
 }
 
-bool EventComparator::operator()(Event* a, Event* b) const {
-    if (std::abs(a->pos.y - b->pos.y) > NUMERICAL_TOLERANCE) return a->pos.y > b->pos.y;
-    if (std::abs(a->pos.x - b->pos.x) > NUMERICAL_TOLERANCE) return a->pos.x < b->pos.x;
+bool EventComparator::precedes(double ay, double ax, bool aIsSite, double by, double bx, bool bIsSite) {
+    if (std::abs(ay - by) > NUMERICAL_TOLERANCE) return ay > by;
+    if (std::abs(ax - bx) > NUMERICAL_TOLERANCE) return ax < bx;
 
-    if (b->isSiteEvent && a->isSiteEvent) {
-        printf("Duplicate vertices found\n");
+    if (bIsSite && aIsSite) {
+        SWEEP_LOG("Duplicate vertices found\n");
     }
 
-    return a->isSiteEvent;
+    return aIsSite;
+}
+
+bool EventComparator::operator()(const Event* a, const Event* b) const {
+    return precedes(a->pos.y, a->pos.x, a->isSiteEvent, b->pos.y, b->pos.x, b->isSiteEvent);
+}
+
+bool EventComparator::operator()(const Event &a, const Event &b) const {
+    return (*this)(&a, &b);
+}
+
+bool EventComparator::operator()(const EventRecord &a, const EventRecord &b) const {
+    return precedes(a.y, a.x, a.isSiteEvent, b.y, b.x, b.isSiteEvent);
+}
+
+
+template<int Arity>
+using PointerEventHeap = PriorityQueue<Event*, EventComparator, Arity>;
+
+template<int Arity>
+using ValueEventHeap = PriorityQueue<Event, EventComparator, Arity>;
+
+
+static const Event &deref(const Event* event) { return *event; }
+
+static const Event &deref(const Event &event) { return event; }
+
+
+// Sweep-like workload: heapify n site events, then drain the queue while pushing a circle event below the sweep line
+// on every other poll. Returns the elapsed time in milliseconds.
+template<typename E, typename Queue>
+static double timeEventQueue(const std::vector<Vec2> &sites, const std::vector<double> &drops, double &checksum) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<E> initial;
+    initial.reserve(2 * sites.size());
+    for (const Vec2 &site: sites) {
+        if constexpr (std::is_pointer_v<E>) initial.push_back(new Event(site));
+        else initial.emplace_back(site);
+    }
+
+    Queue queue;
+    queue.build(std::move(initial));
+    size_t polls = 0;
+    while (!queue.empty()) {
+        E event = queue.poll();
+        const Event &e = deref(event);
+        checksum += e.y();
+
+        if (polls % 2 == 0 && polls / 2 < drops.size()) {
+            Vec2 bottom = Vec2(e.x(), e.y() - drops[polls / 2]);
+            if constexpr (std::is_pointer_v<E>) queue.push(new Event(bottom, bottom, nullptr));
+            else queue.emplace(bottom, bottom, nullptr);
+        }
+        polls++;
+
+        if constexpr (std::is_pointer_v<E>) delete event;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+// Same workload on the sweep's event queue, which owns the events and orders records by value
+static double timeSweepEventQueue(const std::vector<Vec2> &sites, const std::vector<double> &drops, double &checksum) {
+    auto start = std::chrono::steady_clock::now();
+
+    EventQueue queue;
+    for (const Vec2 &site: sites) queue.push(queue.createSiteEvent(site));
+
+    size_t polls = 0;
+    while (!queue.empty()) {
+        Event* e = queue.poll();
+        checksum += e->y();
+
+        if (polls % 2 == 0 && polls / 2 < drops.size()) {
+            Vec2 bottom = Vec2(e->x(), e->y() - drops[polls / 2]);
+            queue.push(queue.createCircleEvent(bottom, bottom, nullptr));
+        }
+        polls++;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+void eventQueueBenchmark() {
+    std::cout << "Benchmarking event queues" << std::endl;
+
+    std::mt19937 rng(1337);
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    std::exponential_distribution<double> drop(0.1);
+
+    for (int n: {1000, 100000, 1000000}) {
+        std::vector<Vec2> sites;
+        sites.reserve(n);
+        for (int i = 0; i < n; i++) sites.emplace_back(coordinate(rng), coordinate(rng));
+        std::vector<double> drops(n);
+        for (double &d: drops) d = drop(rng);
+
+        double checksum = 0;
+        printf("n = %d\n", n);
+        printf("    Event*, arity 2: %10.3f ms\n", timeEventQueue<Event*, PointerEventHeap<2>>(sites, drops, checksum));
+        printf("    Event*, arity 4: %10.3f ms\n", timeEventQueue<Event*, PointerEventHeap<4>>(sites, drops, checksum));
+        printf("    Event*, arity 8: %10.3f ms\n", timeEventQueue<Event*, PointerEventHeap<8>>(sites, drops, checksum));
+        printf("    EventQueue:      %10.3f ms\n", timeSweepEventQueue(sites, drops, checksum));
+        printf("    Event,  arity 2: %10.3f ms\n", timeEventQueue<Event, ValueEventHeap<2>>(sites, drops, checksum));
+        printf("    Event,  arity 4: %10.3f ms\n", timeEventQueue<Event, ValueEventHeap<4>>(sites, drops, checksum));
+        printf("    Event,  arity 8: %10.3f ms\n", timeEventQueue<Event, ValueEventHeap<8>>(sites, drops, checksum));
+        printf("    (checksum %f)\n", checksum);
+    }
 }
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <set>
+#include "fortune/EventQueue.hpp"
+
+uint64_t EventQueue::key(const EventRecord &record) {
+    // Higher events come first
+    return ~orderPreservingBits(record.y);
+}
+
+
+Event* EventQueue::createSiteEvent(Vec2 site) {
+    Event &event = events.emplace_back(site);
+    event.index = static_cast<int32_t>(events.size() - 1);
+    return &event;
+}
+
+
+Event* EventQueue::createCircleEvent(
+    Vec2 circleBottom,
+    Vec2 center,
+    LinkedNode<BeachChain*, TreeValueFacade*>* arcNode
+) {
+    Event &event = events.emplace_back(circleBottom, center, arcNode);
+    event.index = static_cast<int32_t>(events.size() - 1);
+    return &event;
+}
+
+
+void EventQueue::push(Event* event) {
+    assert(event->index >= 0 && &events[event->index] == event);
+    EventRecord record = {event->y(), event->x(), event->isSiteEvent, event->index};
+    uint64_t k = key(record);
+
+    // Events above the last one handed out by the radix heap (by rounding) can't go back into it
+    if ((!front.empty() && record.y >= windowBottom) || k < far.lastKey()) {
+        if (front.empty()) windowBottom = record.y - NUMERICAL_TOLERANCE;
+        front.push(record);
+        return;
+    }
+
+    far.push(k, record);
+}
+
+
+void EventQueue::fillFront() {
+    if (front.empty()) {
+        if (far.empty()) return;
+        EventRecord top = far.poll();
+        windowBottom = top.y - NUMERICAL_TOLERANCE;
+        front.push(top);
+    }
+
+    while (!far.empty() && far.peek().y >= windowBottom) front.push(far.poll());
+}
+
+
+Event* EventQueue::peek() {
+    fillFront();
+    return &events[front.peek().index];
+}
+
+
+Event* EventQueue::poll() {
+    fillFront();
+    return &events[front.poll().index];
+}
+
+
+bool EventQueue::empty() const {
+    return front.empty() && far.empty();
+}
+
+
+size_t EventQueue::size() const {
+    return front.size() + far.size();
+}
+
+
+void EventQueue::clear() {
+    front.clear();
+    far.clear();
+    events.clear();
+    windowBottom = 0;
+}
+
+
+void eventQueueTest1() {
+    std::cout << "Testing EventQueue, case 1" << std::endl;
+
+    // Integer coordinates, so that ties are exact and both queues must agree on the full order
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> coordinate(-20, 20);
+    EventQueue queue;
+    PriorityQueue<Event*, EventComparator> reference;
+    std::set<std::pair<int, int>> seen;
+    while (reference.size() < 200) {
+        int x = coordinate(rng);
+        int y = coordinate(rng);
+        if (!seen.insert({x, y}).second) continue;
+        Event* site = queue.createSiteEvent(Vec2(x, y));
+        queue.push(site);
+        reference.push(site);
+    }
+    assert(queue.size() == 200);
+
+    int circles = 0;
+    while (!queue.empty()) {
+        Event* a = queue.poll();
+        Event* b = reference.poll();
+        assert(a->pos.y == b->pos.y && a->pos.x == b->pos.x && a->isSiteEvent == b->isSiteEvent);
+
+        // Circle events at or below the sweep line, sometimes exactly on it
+        if (a->isSiteEvent && circles++ < 200) {
+            Vec2 bottom = Vec2(coordinate(rng), a->pos.y - std::uniform_int_distribution<int>(0, 3)(rng));
+            Event* circle = queue.createCircleEvent(bottom, bottom, nullptr);
+            queue.push(circle);
+            reference.push(circle);
+        }
+    }
+    assert(reference.empty());
+}
@@ -1,59 +1,239 @@
+#include <algorithm>
 #include <cmath>
 #include <cassert>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <map>
+#include <unistd.h>
 #include "fortune/Fortune.hpp"
+#include "fortune/SweepTrace.hpp"
+#include "utils/SweepLog.hpp"
+#include "benchmarks.hpp"
 
 
-FortuneSweeper::FortuneSweeper(const std::vector<Vec2> &sites) : sites(sites) {
-    EventComparator eventComp;
+FortuneSweeper::FortuneSweeper() : sweepY(DOUBLE_INFINITY) {
     ChainComparator chainComp;
-    this->eventQueue = new PriorityQueue<Event*, EventComparator>(eventComp);
+    this->eventQueue = new EventQueue();
     this->beachLine = new LinkedSplayTree<BeachChain*, TreeValueFacade*, ChainComparator>(chainComp);
-    this->factory = new DCELFactory(sites);
+    this->factory = new DCELFactory();
+}
+
+
+FortuneSweeper::FortuneSweeper(const std::vector<Vec2> &sites) : FortuneSweeper() {
+    reset(sites);
+}
+
+
+FortuneSweeper::~FortuneSweeper() {
+    delete eventQueue;
+    delete beachLine;
+    delete factory;
+    delete ownedPool;
+}
+
+
+void FortuneSweeper::reset(const std::vector<Vec2> &newSites) {
+    sites.assign(newSites.begin(), newSites.end());
+    restart();
+}
+
+
+void FortuneSweeper::reset(const MappedSites &newSites) {
+    // Events and arcs point at the sites, so they are copied into the sweeper, one pass over the mapping with no
+    // parsing in between
+    sites.clear();
+    sites.reserve(newSites.size());
+    for (int i = 0; i < newSites.size(); i++) sites.emplace_back(newSites.x(i), newSites.y(i), newSites.identifier(i));
+    restart();
+}
+
 
-    // Populate the event queue with site events
-    for (const Vec2 &site: sites) eventQueue->add(new Event(site));
+void FortuneSweeper::restart() {
+    currentEventCounter = 0;
+    lastHandledEvent = nullptr;
+    beachLine->root = nullptr;
+    chainNodes.clear();
+    chainValues.clear();
+    chains.clear();
+    factory->reset(sites);
+
+    // Populate the event queue with site events. This also frees the events of the previous diagram.
+    eventQueue->clear();
+    for (const Vec2 &site: sites) eventQueue->push(eventQueue->createSiteEvent(site));
     this->sweepY = eventQueue->peek()->y();
 }
 
 
+BeachChain* FortuneSweeper::createArc(Vec2* focus) {
+    return &chains.emplace_back(&sweepY, focus);
+}
+
+
+BeachChain* FortuneSweeper::createBreakpoint(Vec2* left, Vec2* right) {
+    return &chains.emplace_back(&sweepY, left, right);
+}
+
+
+LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::createNode(BeachChain* chain, VertexPair* breakpointEdge) {
+    TreeValueFacade* value = &chainValues.emplace_back();
+    value->breakpointEdge = breakpointEdge;
+    return &chainNodes.emplace_back(chain, value);
+}
+
+
+void FortuneSweeper::setPlan(const SweepPlan &newPlan) {
+    plan = newPlan;
+
+    // The pool of the previous plan is kept as long as it has the right size
+    bool ownPool = plan.numThreads > 0 && plan.numThreads != ThreadPool::shared().size();
+    if (ownedPool != nullptr && (!ownPool || ownedPool->size() != plan.numThreads)) {
+        delete ownedPool;
+        ownedPool = nullptr;
+    }
+    if (ownPool && ownedPool == nullptr) ownedPool = new ThreadPool(plan.numThreads);
+    factory->setThreadPool(ownedPool);
+}
+
+
+void FortuneSweeper::setTrace(SweepTraceWriter* newTrace) {
+    trace = newTrace;
+    if (trace != nullptr) trace->begin(sites);
+}
+
+
 void FortuneSweeper::stepNextEvent() {
     if (eventQueue->empty()) throw std::out_of_range("Event queue is empty; all events already handled.");
 
 
-    Event* event = eventQueue->poll();
-    currentEventCounter++;
+    Event* event = pollEvent();
     sweepY = event->y();
 
-    printf("\n-------- ");
-    printf("Event #%d (%s)", currentEventCounter, event->isSiteEvent ? "site" : "circle");
-    printf(" --------\n");
-    printf("Sweep line position: %f\n", sweepY);
-    printf("Starting Beach Line:");
+    SWEEP_LOG("\n-------- ");
+    SWEEP_LOG("Event #%d (%s)", currentEventCounter, event->isSiteEvent ? "site" : "circle");
+    SWEEP_LOG(" --------\n");
+    SWEEP_LOG("Sweep line position: %f\n", sweepY);
+    SWEEP_LOG("Starting Beach Line:");
     printBeachLine();
 
-    if (event->isSiteEvent) handleSiteEvent(event);
+    if (event->isSiteEvent && beachLine->root == nullptr) event = handleTopSiteRun(event);
+    else if (event->isSiteEvent) handleSiteEvent(event);
     else handleCircleEvent(event);
 
     lastHandledEvent = event;
+    if (trace != nullptr) trace->recordBeachLine(beachLine->root == nullptr ? nullptr : beachLine->root->leftmost());
 }
 
 
 DCEL* FortuneSweeper::finalize() {
-    printf("Finished Fortune sweep, building DCEL...\n");
-    return factory->createDCEL(sites);
+    SWEEP_LOG("Finished Fortune sweep, building DCEL...\n");
+    return factory->createDCEL();
+}
+
+void FortuneSweeper::discardInvalidatedEvents() {
+    while (!eventQueue->empty()) {
+        Event* event = eventQueue->peek();
+        if (event->isSiteEvent || !event->isInvalidated) return;
+        pollEvent();
+    }
+}
+
+Event* FortuneSweeper::pollEvent() {
+    Event* event = eventQueue->poll();
+    currentEventCounter++;
+    if (trace != nullptr) trace->recordEvent(event);
+    return event;
 }
 
 DCEL* FortuneSweeper::computeAll() {
-    while (!eventQueue->empty()) stepNextEvent();
+    // Colinear sites only have parallel bisectors, which the factory can lay out directly, without any events
+    if (plan.colinearFastPath && currentEventCounter == 0 && (plan.colinearKnown || allColinear(sites))) {
+        DCEL* dcel = factory->createColinearDCEL();
+        if (dcel != nullptr) {
+            eventQueue->clear();
+            return dcel;
+        }
+    }
+
+    // Every event of a cocircular chain is consumed by whichever of them fires first, and the rest are left behind as
+    // invalidated events at the same position. On lattices that is most of the queue, so they are dropped in bulk,
+    // without going through a full step each.
+    while (true) {
+        discardInvalidatedEvents();
+        if (eventQueue->empty()) break;
+        stepNextEvent();
+    }
 
     return finalize();
 }
 
+VertexPair* FortuneSweeper::offerSplitEdge(Vec2* aboveFocus, Vec2* newFocus) {
+    VertexPair* newEdge = factory->createPair();
+
+    // Add new outer records into the factory
+    Vec2 bpProxyOriginVec(
+        newFocus->x,
+        pointDirectrixParabola(newFocus->x, *aboveFocus, sweepY)
+    );
+
+    if (bpProxyOriginVec.isInfinite) {
+        assert(softEquals(aboveFocus->y, newFocus->y));
+        // Degeneracy case: Multiple events at the same y, so the arc above is still a vertical ray
+        bpProxyOriginVec.x = (newFocus->x + aboveFocus->x) / 2.0;
+    }
+
+    Vertex* bpEdgeProxyOrigin = factory->createVertex(0, bpProxyOriginVec);
+    newEdge->offerVertex(bpEdgeProxyOrigin);
+    newEdge->direction = pointDirectrixTangent(newFocus->x, *aboveFocus, sweepY);
+    newEdge->incidentSiteA = aboveFocus;
+    newEdge->incidentSiteB = newFocus;
+    factory->offerPair(newEdge);
+    return newEdge;
+}
+
+
+Event* FortuneSweeper::handleTopSiteRun(Event* event) {
+    // Gather the other sites on the same line
+    std::vector<Event*> run = {event};
+    while (!eventQueue->empty()
+           && eventQueue->peek()->isSiteEvent
+           && softEquals(eventQueue->peek()->y(), event->y())) {
+        run.push_back(pollEvent());
+    }
+
+    bool distinct = true;
+    for (size_t i = 1; i < run.size(); i++) distinct &= !softEquals(run[i - 1]->x(), run[i]->x());
+
+    if (run.size() == 1 || !distinct) {
+        for (Event* site: run) handleSiteEvent(site);
+        return run.back();
+    }
+
+    SWEEP_LOG("Building beach line from a run of %d sites at the top\n", static_cast<int>(run.size()));
+
+    // Arcs from left to right, each pair separated by a breakpoint tracing their (vertical) bisector
+    std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> nodes;
+    nodes.reserve(2 * run.size() - 1);
+    for (size_t i = 0; i < run.size(); i++) {
+        if (i > 0) {
+            VertexPair* edge = offerSplitEdge(&run[i - 1]->pos, &run[i]->pos);
+            nodes.push_back(createNode(createBreakpoint(&run[i - 1]->pos, &run[i]->pos), edge));
+        }
+
+        nodes.push_back(createNode(createArc(&run[i]->pos)));
+    }
+
+    // Colinear sites have no circle events, so the beach line is all there is to set up
+    beachLine->buildBalanced(nodes, true);
+    return run.back();
+}
+
+
 void FortuneSweeper::handleSiteEvent(Event* event) {
     assert(event->isSiteEvent);
     // Extract the site point from the event
-    auto* newArc = new BeachChain(&sweepY, &event->pos);
-    printf("Handling event for %s... ", newArc->toString());
+    BeachChain* newArc = createArc(&event->pos);
+    SWEEP_LOG("Handling event for %s... ", newArc->toString());
 
     // Find the arc directly above the new site point
     LinkedNode<BeachChain*, TreeValueFacade*>* arcAboveNode = beachLine->root;
@@ -69,13 +249,12 @@ void FortuneSweeper::handleSiteEvent(Event* event) {
                 return;
             }
 
-            printf("\nWARNING: Site below breakpoint, coinciding with a (co)circular event!.\n"
-                   "Resolving that circle event first...\n\n");
-            auto* merged = handleCircleEvent(eventQueue->poll());
+            SWEEP_LOG("\nWARNING: Site below breakpoint, coinciding with a (co)circular event!.\n"
+                      "Resolving that circle event first...\n\n");
+            auto* merged = handleCircleEvent(pollEvent());
 
             if (merged == nullptr) {
-                printf("Unhandled special case, exiting");
-                exit(1);
+                throw std::runtime_error("Unhandled degenerate site event");
             }
 
             handleSiteAtBottomDegen(event, newArc, merged);
@@ -89,33 +268,33 @@ void FortuneSweeper::handleSiteEvent(Event* event) {
     // If no arc is found directly above, it means this is the first site
     if (!arcAboveNode) {
         assert(beachLine->root == nullptr);
-        beachLine->add(newArc, TreeValueFacade::arcPtr());
-        printf("first arc found, moving on.\n");
+        beachLine->insert(createNode(newArc));
+        SWEEP_LOG("first arc found, moving on.\n");
         return;  // Early return; no further action needed if this is the first site
     }
 
     BeachChain* arcAbove = arcAboveNode->key;
 
     assert(arcAbove->isArc);
-    printf("arc above is %s, focus at %s\n", arcAbove->toString(), arcAbove->focus->toString());
+    SWEEP_LOG("arc above is %s, focus at %s\n", arcAbove->toString(), arcAbove->focus->toString());
 
     // Remove the node
     beachLine->removeNode(arcAboveNode, false);
 
     // Create new arcs from the split of the old arc
-    auto* leftArc = new BeachChain(&sweepY, arcAbove->focus);
-    auto* rightArc = new BeachChain(&sweepY, arcAbove->focus);
+    BeachChain* leftArc = createArc(arcAbove->focus);
+    BeachChain* rightArc = createArc(arcAbove->focus);
 
     // Create two new breakpoints
-    auto* leftBreakpoint = new BeachChain(&sweepY, leftArc->focus, newArc->focus);
-    auto* rightBreakpoint = new BeachChain(&sweepY, newArc->focus, rightArc->focus);
+    BeachChain* leftBreakpoint = createBreakpoint(leftArc->focus, newArc->focus);
+    BeachChain* rightBreakpoint = createBreakpoint(newArc->focus, rightArc->focus);
 
-    // Add the two breakpoint nodes into the tree
-    auto* newEdge = new VertexPair();
+    // Start the edge traced out by the new breakpoints
+    VertexPair* newEdge = offerSplitEdge(arcAbove->focus, newArc->focus);
 
-    LinkedNode<BeachChain*, TreeValueFacade*>* leftBpNode = beachLine->add(
-        leftBreakpoint,
-        TreeValueFacade::breakpointPtr(newEdge),
+    // Add the two breakpoint nodes into the tree
+    LinkedNode<BeachChain*, TreeValueFacade*>* leftBpNode = beachLine->insert(
+        createNode(leftBreakpoint, newEdge),
         false
     );
     assert(leftBpNode->parent == nullptr || !leftBpNode->parent->key->isArc);
@@ -123,43 +302,19 @@ void FortuneSweeper::handleSiteEvent(Event* event) {
     LinkedNode<BeachChain*, TreeValueFacade*>* rightBpNode = nullptr;
     bool arcAboveSameLevelDegen = softEquals(arcAbove->focus->y, event->pos.y);
     if (!arcAboveSameLevelDegen) {
-        rightBpNode = beachLine->add(
-            rightBreakpoint,
-            TreeValueFacade::breakpointPtr(newEdge),
-            false
-        );
+        rightBpNode = beachLine->insert(createNode(rightBreakpoint, newEdge), false);
         assert(rightBpNode->parent == nullptr || !rightBpNode->parent->key->isArc);
     }
 
-    // Add new outer records into the factory
-    Vec2 bpProxyOriginVec(
-        event->pos.x,
-        pointDirectrixParabola(event->pos.x, *arcAbove->focus, sweepY)
-    );
-
-    if (bpProxyOriginVec.isInfinite) {
-        assert(arcAboveSameLevelDegen);
-        // Degeneracy case: Multiple events at the same x, AND arc above has the same focus.x
-        bpProxyOriginVec.x = (newArc->focus->x + arcAbove->focus->x) / 2.0;
-    }
-
-    double angle = atan(pointDirectrixGradient(event->pos.x, *arcAbove->focus, sweepY));
-    auto* bpEdgeProxyOrigin = new Vertex(0, bpProxyOriginVec);
-    newEdge->offerVertex(bpEdgeProxyOrigin);
-    newEdge->angle = angle;
-    newEdge->incidentSiteA = arcAbove->focus;
-    newEdge->incidentSiteB = newArc->focus;
-    factory->offerPair(newEdge);
-
     LinkedNode<BeachChain*, TreeValueFacade*>* leftArcNode;
     LinkedNode<BeachChain*, TreeValueFacade*>* rightArcNode;
     if (rightBpNode != nullptr) {
         // Standard case
 
         // Create three new nodes corresponding to the three arcs
-        auto* newArcNode = new LinkedNode<BeachChain*, TreeValueFacade*>(newArc, TreeValueFacade::arcPtr());
-        leftArcNode = new LinkedNode<BeachChain*, TreeValueFacade*>(leftArc, TreeValueFacade::arcPtr());
-        rightArcNode = new LinkedNode<BeachChain*, TreeValueFacade*>(rightArc, TreeValueFacade::arcPtr());
+        LinkedNode<BeachChain*, TreeValueFacade*>* newArcNode = createNode(newArc);
+        leftArcNode = createNode(leftArc);
+        rightArcNode = createNode(rightArc);
 
         // Set up the subtree structure
         assert(leftBpNode->leftChild == nullptr);
@@ -186,14 +341,8 @@ void FortuneSweeper::handleSiteEvent(Event* event) {
         assert(leftBpNode->leftChild == nullptr);
         // Create three new nodes corresponding to the three arcs
         bool newIsLeft = event->pos.x < arcAbove->focus->x;
-        leftArcNode = new LinkedNode<BeachChain*, TreeValueFacade*>(
-            newIsLeft ? newArc : leftArc,
-            TreeValueFacade::arcPtr()
-        );
-        rightArcNode = new LinkedNode<BeachChain*, TreeValueFacade*>(
-            newIsLeft ? rightArc : newArc,
-            TreeValueFacade::arcPtr()
-        );
+        leftArcNode = createNode(newIsLeft ? newArc : leftArc);
+        rightArcNode = createNode(newIsLeft ? rightArc : newArc);
 
         leftBpNode->setLeftChild(leftArcNode);
         leftBpNode->setRightChild(rightArcNode);
@@ -211,8 +360,6 @@ void FortuneSweeper::handleSiteEvent(Event* event) {
     // Try to reduce tree depth
     beachLine->splay(rightBpNode);
 
-    delete arcAbove;
-
     // Check for potential circle eventQueue caused by these new arcs
     Event* circEvent1 = checkAndCreateCircleEvent(leftArcNode);
     Event* circEvent2 = checkAndCreateCircleEvent(rightArcNode);
@@ -221,7 +368,7 @@ void FortuneSweeper::handleSiteEvent(Event* event) {
 
 LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::handleCircleEvent(Event* event, bool skipEdgeCreation) {
     if (event->isInvalidated) {
-        printf("Event has already been invalidated, exiting\n");
+        SWEEP_LOG("Event has already been invalidated, exiting\n");
         return nullptr;
     }
 
@@ -239,7 +386,7 @@ LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::handleCircleEvent(Eve
     assert(arcNode->prev != nullptr);
     assert(arcNode->next != nullptr);
 
-    printf("Handling circle event for %s\n", arc->toString());
+    SWEEP_LOG("Handling circle event for %s\n", arc->toString());
 
     // Henceforth, arcs will be referred to as "vanishing" if they will disappear after this (co)circle event
     // These arcs are bounded on two sides by two breakpoints, which will eventually be found and assigned to
@@ -250,31 +397,30 @@ LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::handleCircleEvent(Eve
 
     LinkedNode<BeachChain*, TreeValueFacade*>* leftMerger = vanishing.leftMerger;
     LinkedNode<BeachChain*, TreeValueFacade*>* rightMerger = vanishing.rightMerger;
-    std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> vanishingArcNodes = *vanishing.vanishingArcNodes;
-    std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> vanishingBpNodes = *vanishing.vanishingBpNodes;
+    const std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> &vanishingArcNodes = *vanishing.vanishingArcNodes;
+    const std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> &vanishingBpNodes = *vanishing.vanishingBpNodes;
 
     // Everything should be fine here
 
     // Add the center of the circle as a new Voronoi vertex
     if (event->circleCenter.isInfinite) return nullptr;
-    auto* newVoronoiVertex = new Vertex(factory->numVertices() + 1, event->circleCenter);
-    factory->offerVertex(newVoronoiVertex);
+    Vertex* newVoronoiVertex = factory->offerVertex(
+        factory->createVertex(factory->numVertices() + 1, event->circleCenter)
+    );
+    if (trace != nullptr) trace->recordVertex(newVoronoiVertex->pos, newVoronoiVertex->label);
 
     // Connect every merging breakpoints' edges to it
-    std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*> breakpoints(vanishingBpNodes);
-    breakpoints.push_back(leftMerger);
-    breakpoints.push_back(rightMerger);
-    for (auto &bn: breakpoints) {
+    auto connectBreakpoint = [&](LinkedNode<BeachChain*, TreeValueFacade*>* bn) {
         VertexPair* breakpointEdge = bn->value->breakpointEdge;
 
         if (breakpointEdge == nullptr) {
             // This means this breakpoint did not come from a standard site event nor a circle event,
             // but rather a handleSiteAtBottomDegen case. We add a new outer for it here.
-            double angle = atan(perpendicularBisectorSlope(*bn->key->leftSite, *bn->key->rightSite));
+            Vec2 direction = perpendicularBisectorDirection(*bn->key->leftSite, *bn->key->rightSite);
 
-            auto* newEdge = new VertexPair();
+            VertexPair* newEdge = factory->createPair();
             newEdge->offerVertex(newVoronoiVertex);
-            newEdge->angle = angle > 0 ? angle - M_PI : angle;
+            newEdge->direction = direction.y > 0 ? direction * -1 : direction;
             newEdge->incidentSiteA = bn->key->leftSite;
             newEdge->incidentSiteB = bn->key->rightSite;
 
@@ -284,7 +430,10 @@ LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::handleCircleEvent(Eve
         } else {
             breakpointEdge->offerVertex(newVoronoiVertex);
         }
-    }
+    };
+    for (auto &bn: vanishingBpNodes) connectBreakpoint(bn);
+    connectBreakpoint(leftMerger);
+    connectBreakpoint(rightMerger);
 
     LinkedNode<BeachChain*, TreeValueFacade*>* mergedBpNode = nullptr;
     if (!skipEdgeCreation) {
@@ -295,13 +444,11 @@ LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::handleCircleEvent(Eve
         // Then, we need kill the breakpoints and connect the disappearing arc's neighbors in the beach line
 
         // First, create the merged node
-        auto* mergedBreakpoint = new BeachChain(&sweepY, leftBp->leftSite, rightBp->rightSite);
-        mergedBpNode = new LinkedNode<BeachChain*, TreeValueFacade*>(
-            mergedBreakpoint,
-            TreeValueFacade::breakpointPtr(new VertexPair({newVoronoiVertex, nullptr}))
-        );
-        // Compute the angle of the line
-        double angle = atan(perpendicularBisectorSlope(*leftBp->leftSite, *rightBp->rightSite));
+        VertexPair* mergedEdge = factory->createPair();
+        mergedEdge->v1 = newVoronoiVertex;
+        mergedBpNode = createNode(createBreakpoint(leftBp->leftSite, rightBp->rightSite), mergedEdge);
+        // Compute the direction of the line
+        Vec2 direction = perpendicularBisectorDirection(*leftBp->leftSite, *rightBp->rightSite);
 
         // Decide on which ray to take based on the orientation of the vertices
         Vec2 L = *leftBp->leftSite;
@@ -309,51 +456,20 @@ LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::handleCircleEvent(Eve
         Vec2 R = *rightBp->rightSite;
 
         if (L.x > R.x) {
-            printf("Orientation check: This event is oriented counterclockwise\n");
-            mergedBpNode->value->breakpointEdge->angle = angle < 0 ? angle + M_PI : angle;
+            SWEEP_LOG("Orientation check: This event is oriented counterclockwise\n");
+            mergedBpNode->value->breakpointEdge->direction = direction.y < 0 ? direction * -1 : direction;
         } else {
-            printf("Orientation check: This event is oriented clockwise\n");
-            mergedBpNode->value->breakpointEdge->angle = angle > 0 ? angle - M_PI : angle;
+            SWEEP_LOG("Orientation check: This event is oriented clockwise\n");
+            mergedBpNode->value->breakpointEdge->direction = direction.y > 0 ? direction * -1 : direction;
         }
 
         mergedBpNode->value->breakpointEdge->incidentSiteA = leftBp->leftSite;
         mergedBpNode->value->breakpointEdge->incidentSiteB = rightBp->rightSite;
         factory->offerPair(mergedBpNode->value->breakpointEdge);
 
-        // Handle linked list operations for the new merged breakpoint node
-        mergedBpNode->linkPrev(leftMerger->prev);
-        mergedBpNode->linkNext(rightMerger->next);
-
-        // Delete every node involved in the event EXCEPT for the two merging breakpoints, which is removed later
-        // Start with leaves, which are vanishing arcs
-        for (auto &an: vanishingArcNodes) beachLine->removeNode(an, false);
-
-        // Then, delete every vanishing breakpoint
-        for (auto &bn: vanishingBpNodes) beachLine->removeNode(bn, false);
-
-        // Pull the two merging breakpoints to be near the root
-        beachLine->splay(leftMerger);
-        beachLine->splay(rightMerger);
-        // Delete them from the beach line
-        LinkedNode<BeachChain*, TreeValueFacade*>* subtreeParent;
-        // "<" (when not circular)
-        assert(rightMerger->leftChild == leftMerger);
-        assert(leftMerger->rightChild == nullptr);
-        subtreeParent = rightMerger->parent;
-        mergedBpNode->setLeftChild(leftMerger->leftChild);
-        mergedBpNode->setRightChild(rightMerger->rightChild);
-
-        // ">"
-        //    assert(leftMerger->right == rightMerger);
-        //    assert(rightMerger->left == arcNode);
-        //    subtreeParent = leftMerger->parent;
-        //    mergedBpNode->setLeftChild(leftMerger->left);
-        //    mergedBpNode->setRightChild(rightMerger->right);
-
-        if (subtreeParent == nullptr) beachLine->root = mergedBpNode;
-        else if (subtreeParent->leftChild == leftMerger) subtreeParent->setLeftChild(mergedBpNode);
-        else if (subtreeParent->rightChild == leftMerger) subtreeParent->setRightChild(mergedBpNode);
-        else { assert(false); }
+        // Every node from the left merger to the right merger vanishes in this event. They form a contiguous run of
+        // the beach line, so they are cut out together, and the merged breakpoint takes their place.
+        beachLine->replaceRange(leftMerger, rightMerger, mergedBpNode);
 
         assert(!leftBp->isArc && !rightBp->isArc);
     }
@@ -382,10 +498,6 @@ LinkedNode<BeachChain*, TreeValueFacade*>* FortuneSweeper::handleCircleEvent(Eve
     offerCircleEventPair(circEvent1, circEvent2);
 
     return mergedBpNode;
-
-    // Clean up the removed arc
-//    delete arc;
-//    delete arcNode;
 }
 
 Event* FortuneSweeper::checkAndCreateCircleEvent(LinkedNode<BeachChain*, TreeValueFacade*>* arcNode) const {
@@ -402,15 +514,15 @@ Event* FortuneSweeper::checkAndCreateCircleEvent(LinkedNode<BeachChain*, TreeVal
     Vec2 c = *arcNode->next->key->rightSite;
 
 
-    printf("Considering possible circle event of <p%d, p%d, p%d>...\n",
-           a.identifier, b.identifier, c.identifier
+    SWEEP_LOG("Considering possible circle event of <p%d, p%d, p%d>...\n",
+              a.identifier, b.identifier, c.identifier
     );
 
     if (!(a.identifier != b.identifier && b.identifier != c.identifier && a.identifier != c.identifier)) return nullptr;
 
     // Check if b is a vertex of a converging circle with a and c
     if (computeDeterminantTest(a, b, c) >= 0) {  // Points must be oriented clockwise
-        printf("Triplet is not oriented clockwise, discarding.\n");
+        SWEEP_LOG("Triplet is not oriented clockwise, discarding.\n");
         return nullptr;
     }
 
@@ -422,22 +534,22 @@ Event* FortuneSweeper::checkAndCreateCircleEvent(LinkedNode<BeachChain*, TreeVal
 
     // Only consider this event if it is below the sweep line
     if (circleEventY + NUMERICAL_TOLERANCE > sweepY) {
-        printf("Triplet has circumcenter %f above the sweep line, discarding.\n", circleEventY);
+        SWEEP_LOG("Triplet has circumcenter %f above the sweep line, discarding.\n", circleEventY);
         return nullptr;
     }
 
     // Check if the arc itself already has a circle event
     Event* prevCircleEvent = arcNode->value->circleEvent;
     if (prevCircleEvent != nullptr) {
-        printf("Arc has previous circle event that resolves at (%f, %f)\n", prevCircleEvent->x(),
-               prevCircleEvent->y());
+        SWEEP_LOG("Arc has previous circle event that resolves at (%f, %f)\n", prevCircleEvent->x(),
+                  prevCircleEvent->y());
         assert(!prevCircleEvent->isSiteEvent);
         if (prevCircleEvent->y() < circleEventY) return nullptr;
         else prevCircleEvent->isInvalidated = true;
     }
 
     // Two-way reference between the node and the event
-    auto* circleEvent = new Event({center.x, circleEventY}, center, arcNode);
+    Event* circleEvent = eventQueue->createCircleEvent({center.x, circleEventY}, center, arcNode);
     for (auto &v: sites) {
         double dist = center.distanceTo(v);
         if (radius - dist > NUMERICAL_TOLERANCE) return nullptr;
@@ -454,7 +566,7 @@ void FortuneSweeper::handleSiteAtBottomDegen(
     BeachChain* newArc,
     LinkedNode<BeachChain*, TreeValueFacade*>* bpAboveNode
 ) {
-    printf(
+    SWEEP_LOG(
         "\nDegeneracy: site %s below breakpoint %s.\n",
         event->pos.toString(),
         bpAboveNode->key->toString()
@@ -488,22 +600,11 @@ void FortuneSweeper::handleSiteAtBottomDegen(
     assert(rightSubtree->leftmost() == rightArcNode);
 
     // Make a proxy node for the "pseudo" circle event
-    auto* newArcNode = new LinkedNode<BeachChain*, TreeValueFacade*>(
-        newArc,
-        TreeValueFacade::arcPtr()
-    );
+    LinkedNode<BeachChain*, TreeValueFacade*>* newArcNode = createNode(newArc);
 
     // Create two new breakpoints
-    auto* leftBreakpoint = new BeachChain(&sweepY, leftArcNode->key->focus, newArc->focus);
-    auto* rightBreakpoint = new BeachChain(&sweepY, newArc->focus, rightArcNode->key->focus);
-    auto* leftBpNode = new LinkedNode<BeachChain*, TreeValueFacade*>(
-        leftBreakpoint,
-        TreeValueFacade::breakpointPtr()
-    );
-    auto* rightBpNode = new LinkedNode<BeachChain*, TreeValueFacade*>(
-        rightBreakpoint,
-        TreeValueFacade::breakpointPtr()
-    );
+    auto* leftBpNode = createNode(createBreakpoint(leftArcNode->key->focus, newArc->focus));
+    auto* rightBpNode = createNode(createBreakpoint(newArc->focus, rightArcNode->key->focus));
 
     // Linked list operations
     leftArcNode->linkNext(leftBpNode);
@@ -538,14 +639,14 @@ void FortuneSweeper::handleSiteAtBottomDegen(
     assert(softEquals(circleEventY, sweepY));
 
     // Two-way reference between the node and the event
-    auto* circleEvent = new Event({center.x, circleEventY}, center, newArcNode);
+    Event* circleEvent = eventQueue->createCircleEvent({center.x, circleEventY}, center, newArcNode);
     newArcNode->value->circleEvent = circleEvent;
 
     // Finally, resolve the event immediately
-    eventQueue->add(circleEvent);
-    printf("Handled degenerate site event, current beach line:");
+    eventQueue->push(circleEvent);
+    SWEEP_LOG("Handled degenerate site event, current beach line:");
     printBeachLine();
-    printf("Added pseudo-circle event to queue, resolving now...\n\n");
+    SWEEP_LOG("Added pseudo-circle event to queue, resolving now...\n\n");
 
     handleCircleEvent(circleEvent, true);
 
@@ -573,35 +674,36 @@ void FortuneSweeper::offerCircleEventPair(Event* circEvent1, Event* circEvent2)
 
     if (addEvent1) {
         assert(circEvent1 != nullptr);
-        eventQueue->add(circEvent1);
-        printf("Added circle event for %s, resolves at %s\n",
-               circEvent1->arcNode->key->toString(),
-               circEvent1->pos.toString()
+        eventQueue->push(circEvent1);
+        SWEEP_LOG("Added circle event for %s, resolves at %s\n",
+                  circEvent1->arcNode->key->toString(),
+                  circEvent1->pos.toString()
         );
     }
     if (addEvent2) {
         assert(circEvent2 != nullptr);
-        eventQueue->add(circEvent2);
-        printf("Added circle event for %s, resolves at %s\n",
-               circEvent2->arcNode->key->toString(),
-               circEvent2->pos.toString()
+        eventQueue->push(circEvent2);
+        SWEEP_LOG("Added circle event for %s, resolves at %s\n",
+                  circEvent2->arcNode->key->toString(),
+                  circEvent2->pos.toString()
         );
     }
 }
 
 void FortuneSweeper::printBeachLine() {
-    printf("\n\n");
+    if (!SWEEP_LOG_ENABLED) return;
+    SWEEP_LOG("\n\n");
     beachLineToString(beachLine->root, 0);
 }
 
 void FortuneSweeper::beachLineToString(LinkedNode<BeachChain*, TreeValueFacade*>* node, int depth) {
-    for (int i = 0; i < depth; i++) printf("|\t");
+    for (int i = 0; i < depth; i++) SWEEP_LOG("|\t");
     if (node == nullptr) {
-        printf("--\n");
+        SWEEP_LOG("--\n");
         return;
     }
 
-    printf(
+    SWEEP_LOG(
         "%s // P: %s, N: %s\n",
         node->key->toString(),
         node->prev ? node->prev->key->toString() : "--",
@@ -621,12 +723,14 @@ FortuneSweeper::getVanishingChains(LinkedNode<BeachChain*, TreeValueFacade*>* ar
     // Temporarily holders for left and right breakpoints, preparing for the traversal in the next while loop
     LinkedNode<BeachChain*, TreeValueFacade*>* leftMerger = arcNode->prev;
     LinkedNode<BeachChain*, TreeValueFacade*>* rightMerger = arcNode->next;
-    printf("Checking possible cocircular sites\n");
+    SWEEP_LOG("Checking possible cocircular sites\n");
 
     // Grab every circle event that also occurs here
     // Traverse left and right of the current chain to find all vanishing/merging arcs/breakpoints
-    auto* vanishingArcNodes = new std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*>();
-    auto* vanishingBpNodes = new std::vector<LinkedNode<BeachChain*, TreeValueFacade*>*>();
+    auto* vanishingArcNodes = &vanishingArcScratch;
+    auto* vanishingBpNodes = &vanishingBpScratch;
+    vanishingArcNodes->clear();
+    vanishingBpNodes->clear();
     vanishingArcNodes->push_back(arcNode);
     // Traverse the chains left until we hit the merging breakpoint
     while (true) {
@@ -655,7 +759,7 @@ FortuneSweeper::getVanishingChains(LinkedNode<BeachChain*, TreeValueFacade*>* ar
         vanishingBpNodes->push_back(leftMerger->next);
         vanishingArcNodes->push_back(leftMerger);
 
-        printf(
+        SWEEP_LOG(
             "Left-side: Found cocircular site at %s, whose arc is %s.\n",
             leftMerger->key->focus->toString(), leftMerger->key->toString()
         );
@@ -680,7 +784,7 @@ FortuneSweeper::getVanishingChains(LinkedNode<BeachChain*, TreeValueFacade*>* ar
 
         vanishingBpNodes->push_back(rightMerger->prev);
         vanishingArcNodes->push_back(rightMerger);
-        printf(
+        SWEEP_LOG(
             "Right-side: Found cocircular site at %s, whose arc is %s.\n",
             rightMerger->key->focus->toString(), rightMerger->key->toString()
         );
@@ -724,3 +828,220 @@ FortuneSweeper::getVanishingChains(LinkedNode<BeachChain*, TreeValueFacade*>* ar
     };
 }
 
+void fortuneSweeperTest1() {
+    std::cout << "Testing FortuneSweeper, case 1" << std::endl;
+
+    // Identifiers only name the cells: large, sparse, unordered ones give the same diagram as 1, 2, 3...
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> coordinate(-10, 10);
+    std::vector<Vec2> sites;
+    std::vector<Vec2> renamed;
+    for (int i = 0; i < 200; i++) {
+        double x = coordinate(rng);
+        double y = coordinate(rng);
+        sites.emplace_back(x, y, i + 1);
+        renamed.emplace_back(x, y, 2000000000 - 7919 * ((i * 37) % 200));
+    }
+
+    FortuneSweeper sequential;
+    FortuneSweeper sparse;
+    muteStdout();
+    sequential.reset(sites);
+    sparse.reset(renamed);
+    DCEL* expected = sequential.computeAll();
+    DCEL* dcel = sparse.computeAll();
+    unmuteStdout();
+
+    assert(dcel->vertexX == expected->vertexX && dcel->vertexY == expected->vertexY);
+    assert(dcel->edgeOrigin == expected->edgeOrigin && dcel->edgeNext == expected->edgeNext);
+    assert(dcel->edgeFace == expected->edgeFace && dcel->numFaces() == expected->numFaces());
+    for (int32_t f = 0; f < dcel->numFaces(); f++) assert(dcel->faceLabel[f] == renamed[f].identifier);
+
+    // Sites sharing an identifier can't be told apart, and are refused
+    renamed[150].identifier = renamed[20].identifier;
+    try {
+        sparse.reset(renamed);
+        assert(false);
+    } catch (std::invalid_argument &e) {}
+}
+
+// Resident memory of the process, in bytes
+static size_t residentBytes() {
+    FILE* statm = fopen("/proc/self/statm", "r");
+    assert(statm != nullptr);
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    int numRead = fscanf(statm, "%zu %zu", &totalPages, &residentPages);
+    assert(numRead == 2);
+    fclose(statm);
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void fortuneSweeperTest2() {
+    std::cout << "Testing FortuneSweeper, case 2" << std::endl;
+
+    // Everything a sweep allocates is freed or reused by the next reset(), so a sweeper can run forever
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> coordinate(-10, 10);
+    std::vector<Vec2> sites;
+    for (int i = 0; i < 300; i++) {
+        double x = coordinate(rng);
+        sites.emplace_back(x, coordinate(rng), i + 1);
+    }
+
+    FortuneSweeper algo;
+    auto sweep = [&](int times) {
+        int numVertices = 0;
+        muteStdout();
+        for (int i = 0; i < times; i++) {
+            algo.reset(sites);
+            numVertices = algo.computeAll()->numVertices();
+        }
+        unmuteStdout();
+        return numVertices;
+    };
+
+    int expected = sweep(2);
+    size_t before = residentBytes();
+    assert(sweep(10) == expected);
+    size_t after = residentBytes();
+
+    // Each sweep of these sites used to leak megabytes, between its beach line and its log strings
+    assert(after < before + (4 << 20));
+}
+
+void fortuneSweeperTest3() {
+    std::cout << "Testing FortuneSweeper, case 3" << std::endl;
+
+    // Sites on breakpoints, and cocircular quadruples, make circle events whose centers coincide with vertices
+    // already offered. Nudged by less than the tolerance, the centers are a hair apart instead. Either way they must
+    // be welded into the same vertices, with no edge left between two copies of one vertex.
+    std::vector<Vec2> exact = {
+        Vec2(4, 0), Vec2(0, 4), Vec2(-4, 0), Vec2(0, -4), Vec2(8, 0), Vec2(4, 4), Vec2(0, 0), Vec2(4, -4),
+        Vec2(6, 7), Vec2(7, 6), Vec2(-7, -6), Vec2(-6, -7), Vec2(-8, -7), Vec2(-7, -8), Vec2(7, -6), Vec2(6, -7),
+        Vec2(8, -7), Vec2(7, -8), Vec2(2, -6), Vec2(1, -7), Vec2(3, -7), Vec2(2, -8), Vec2(-6, 0),
+    };
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<double> nudge(-NUMERICAL_TOLERANCE / 20, NUMERICAL_TOLERANCE / 20);
+    std::vector<Vec2> nudged;
+    for (size_t i = 0; i < exact.size(); i++) {
+        exact[i].identifier = static_cast<int>(i) + 1;
+        double x = exact[i].x + nudge(rng);
+        nudged.emplace_back(x, exact[i].y + nudge(rng), exact[i].identifier);
+    }
+
+    FortuneSweeper algo;
+    for (const std::vector<Vec2> &sites: {exact, nudged}) {
+        muteStdout();
+        algo.reset(sites);
+        DCEL* dcel = algo.computeAll();
+        unmuteStdout();
+
+        assert(dcel->numVertices() == 40);
+        for (int32_t e = 0; e < dcel->numHalfEdges(); e++) assert(dcel->edgeOrigin[e] != dcel->edgeOrigin[e ^ 1]);
+    }
+}
+
+// Corners of every cell of the diagram, sorted, by site identifier
+static std::map<int, std::vector<std::pair<double, double>>> cellCorners(const DCEL* dcel) {
+    FaceRings rings(dcel);
+    std::map<int, std::vector<std::pair<double, double>>> corners;
+    for (int32_t f = 0; f < dcel->numFaces(); f++) {
+        std::vector<std::pair<double, double>> &cell = corners[dcel->faceLabel[f]];
+        rings.forEachVertex(f, [&](int32_t v) { cell.emplace_back(dcel->vertexX[v], dcel->vertexY[v]); });
+        std::sort(cell.begin(), cell.end());
+    }
+    return corners;
+}
+
+void colinearFastPathTest1() {
+    std::cout << "Testing colinear fast path, case 1" << std::endl;
+
+    // Horizontal, vertical and diagonal lines, out of order along the line, built directly and by the full sweep
+    std::vector<std::vector<Vec2>> lines = {
+        {Vec2(3, 1), Vec2(-2, 1), Vec2(0.5, 1), Vec2(7, 1)},
+        {Vec2(4, 2), Vec2(4, -6), Vec2(4, 9), Vec2(4, 0.25), Vec2(4, 3)},
+        {Vec2(1, 2), Vec2(-3, -6), Vec2(2.5, 5), Vec2(0, 0), Vec2(-1, -2), Vec2(6, 12)},
+        {Vec2(-1, 4), Vec2(2, -2)},
+    };
+    SweepPlan sweepEverything;
+    sweepEverything.colinearFastPath = false;
+    FortuneSweeper direct;
+    FortuneSweeper swept;
+    swept.setPlan(sweepEverything);
+    for (std::vector<Vec2> &sites: lines) {
+        for (size_t i = 0; i < sites.size(); i++) sites[i].identifier = static_cast<int>(i) + 1;
+        muteStdout();
+        direct.reset(sites);
+        swept.reset(sites);
+        DCEL* fast = direct.computeAll();
+        DCEL* slow = swept.computeAll();
+        unmuteStdout();
+
+        // No events at all on the fast path
+        assert(direct.currentEventCounter == 0 && swept.currentEventCounter > 0);
+        assert(fast->numVertices() == slow->numVertices() && fast->numHalfEdges() == slow->numHalfEdges());
+        assert(fast->numFaces() == static_cast<int>(sites.size()) && slow->numFaces() == fast->numFaces());
+
+        auto fastCorners = cellCorners(fast);
+        auto slowCorners = cellCorners(slow);
+        for (auto &[site, corners]: fastCorners) {
+            const std::vector<std::pair<double, double>> &expected = slowCorners.at(site);
+            assert(corners.size() == expected.size());
+            for (size_t i = 0; i < corners.size(); i++) {
+                assert(std::abs(corners[i].first - expected[i].first) < 1e-9);
+                assert(std::abs(corners[i].second - expected[i].second) < 1e-9);
+            }
+        }
+    }
+}
+
+void colinearFastPathTest2() {
+    std::cout << "Testing colinear fast path, case 2" << std::endl;
+
+    // Coincident sites, and lone sites, are left to the sweep, which computeAll() falls back to on nullptr
+    DCELFactory coincident({Vec2(0, 0, 1), Vec2(1, 1, 2), Vec2(1, 1, 3), Vec2(2, 2, 4)});
+    assert(coincident.createColinearDCEL() == nullptr);
+    DCELFactory single({Vec2(5, 5, 1)});
+    assert(single.createColinearDCEL() == nullptr);
+
+    // As are factories that the sweep already started offering records to
+    DCELFactory started({Vec2(0, 0, 1), Vec2(1, 0, 2)});
+    muteStdout();
+    started.offerVertex(started.createVertex(1, {0.5, -1}));
+    unmuteStdout();
+    assert(started.createColinearDCEL() == nullptr);
+}
+
+
+// Full sweeps over square grids. On exact grids every cell is a cocircular event that removes a run of the beach line,
+// while the jittered grids shift half the sites by a hair, which turns each of those into a cluster of nearby events.
+void gridSweepBenchmark() {
+    std::cout << "Benchmarking sweeps over grids" << std::endl;
+
+    FortuneSweeper algo;
+    for (bool jittered: {false, true}) {
+        std::mt19937 rng(3);
+        std::bernoulli_distribution shift(0.5);
+        for (int k: {10, 20, 40}) {
+            std::vector<Vec2> sites;
+            for (int x = 0; x < k; x++) {
+                for (int y = 0; y < k; y++) {
+                    double jitter = jittered && shift(rng) ? 0.001 : 0;
+                    sites.emplace_back(x + jitter, y, x * k + y + 1);
+                }
+            }
+
+            muteStdout();
+            auto start = std::chrono::steady_clock::now();
+            algo.reset(sites);
+            DCEL* dcel = algo.computeAll();
+            auto end = std::chrono::steady_clock::now();
+
+            unmuteStdout();
+
+            printf("    %2dx%-2d %s grid: %10.3f ms (%d vertices)\n", k, k, jittered ? "jittered" : "exact   ",
+                   std::chrono::duration<double, std::milli>(end - start).count(), dcel->numVertices());
+        }
+    }
+}
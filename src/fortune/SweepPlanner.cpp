@@ -0,0 +1,229 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <random>
+#include <string>
+#include <tuple>
+#include <algorithm>
+#include "fortune/SweepPlanner.hpp"
+#include "fortune/Fortune.hpp"
+#include "utils/ThreadPool.hpp"
+#include "benchmarks.hpp"
+
+InputProfile profileInput(const std::vector<Vec2> &sites) {
+    InputProfile profile;
+    profile.numSites = static_cast<int>(sites.size());
+    if (sites.empty()) return profile;
+
+    profile.bottomLeft = Vec2(sites[0].x, sites[0].y);
+    profile.topRight = Vec2(sites[0].x, sites[0].y);
+    for (const Vec2 &site: sites) {
+        profile.bottomLeft.x = std::min(profile.bottomLeft.x, site.x);
+        profile.bottomLeft.y = std::min(profile.bottomLeft.y, site.y);
+        profile.topRight.x = std::max(profile.topRight.x, site.x);
+        profile.topRight.y = std::max(profile.topRight.y, site.y);
+    }
+
+    std::tie(profile.coincidentSite, profile.coincidentWith) = findCoincidentPoints(sites);
+
+    // Only pay for the full pass if an evenly strided sample is colinear already
+    size_t stride = std::max(sites.size() / PLANNER_SAMPLE_SIZE, static_cast<size_t>(1));
+    std::vector<Vec2> sample;
+    for (size_t i = 0; i < sites.size() && sample.size() < PLANNER_SAMPLE_SIZE; i += stride) sample.push_back(sites[i]);
+    profile.colinear = allColinear(sample) && allColinear(sites);
+    return profile;
+}
+
+
+SweepPlan planSweep(const InputProfile &profile) {
+    SweepPlan plan;
+    plan.colinearFastPath = profile.colinear;
+    plan.colinearKnown = profile.colinear;
+    plan.numThreads = profile.numSites < PLANNER_PARALLEL_MIN_SITES ? 1 : ThreadPool::shared().size();
+    return plan;
+}
+
+
+void printSweepPlan(const InputProfile &profile, const SweepPlan &plan) {
+    printf("Input: %d sites in [%f, %f] x [%f, %f], %s\n", profile.numSites,
+           profile.bottomLeft.x, profile.topRight.x, profile.bottomLeft.y, profile.topRight.y,
+           profile.colinear ? "colinear" : "not colinear");
+
+    printf("Plan:\n");
+    if (profile.coincidentSite >= 0) {
+        printf("    reject the input, since sites %d and %d of it coincide, which the sweep does not support\n",
+               profile.coincidentSite + 1, profile.coincidentWith + 1);
+        return;
+    }
+
+    if (plan.colinearFastPath) {
+        printf("    build the parallel bisectors directly, since every site lies on one line\n");
+    } else {
+        printf("    sweep, since the sites are not all on one line\n");
+    }
+
+    if (plan.numThreads == 1) {
+        printf("    build the DCEL on the calling thread, since the input is below %d sites\n",
+               PLANNER_PARALLEL_MIN_SITES);
+    } else {
+        printf("    build the DCEL over %d threads\n", plan.numThreads);
+    }
+}
+
+
+void sweepPlannerTest1() {
+    std::cout << "Testing SweepPlanner, case 1" << std::endl;
+
+    std::vector<Vec2> grid;
+    for (int x = 0; x < 20; x++) for (int y = 19; y >= 0; y--) grid.emplace_back(x, y, x * 20 + y + 1);
+    InputProfile gridProfile = profileInput(grid);
+    assert(gridProfile.numSites == 400);
+    assert(gridProfile.coincidentSite == -1 && gridProfile.coincidentWith == -1);
+    assert(!gridProfile.colinear);
+    assert(!planSweep(gridProfile).colinearFastPath);
+
+    std::vector<Vec2> line;
+    for (int i = 0; i < 100; i++) line.emplace_back(i * 0.5, 100 - i * 2, i + 1);
+    InputProfile lineProfile = profileInput(line);
+    assert(lineProfile.colinear && lineProfile.coincidentSite == -1);
+    assert(lineProfile.bottomLeft.x == 0 && lineProfile.topRight.y == 100);
+    assert(planSweep(lineProfile).colinearFastPath && planSweep(lineProfile).colinearKnown);
+    assert(!planSweep(gridProfile).colinearKnown);
+
+    // Every site is looked at, not just a sample
+    line.emplace_back(line[10].x, line[10].y, 101);
+    InputProfile duplicateProfile = profileInput(line);
+    assert(duplicateProfile.coincidentSite == 10 && duplicateProfile.coincidentWith == 100);
+
+    // Within the tolerance, across a column of the search, with a site in between them in x
+    std::vector<Vec2> near = {Vec2(0.9 * NUMERICAL_TOLERANCE, 1, 1), Vec2(1.2 * NUMERICAL_TOLERANCE, 5, 2),
+                              Vec2(1.6 * NUMERICAL_TOLERANCE, 1 + 0.5 * NUMERICAL_TOLERANCE, 3), Vec2(2, 2, 4)};
+    InputProfile nearProfile = profileInput(near);
+    assert(nearProfile.coincidentSite == 0 && nearProfile.coincidentWith == 2);
+    near[2].y = 1 + 2 * NUMERICAL_TOLERANCE;
+    assert(profileInput(near).coincidentSite == -1);
+}
+
+
+void sweepPlannerBenchmark() {
+    std::cout << "Benchmarking the sweep planner against fixed plans" << std::endl;
+
+    struct CorpusInput {
+        std::string name;
+        std::vector<Vec2> sites;
+    };
+    std::vector<CorpusInput> corpus;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> coordinate(-1, 1);
+    CorpusInput uniform {"uniform 300", {}};
+    for (int i = 0; i < 300; i++) {
+        double x = coordinate(rng);
+        double y = coordinate(rng);
+        uniform.sites.emplace_back(x, y, i + 1);
+    }
+    corpus.push_back(uniform);
+
+    CorpusInput sorted {"y-sorted 300", uniform.sites};
+    std::sort(sorted.sites.begin(), sorted.sites.end(), [](const Vec2 &a, const Vec2 &b) { return a.y > b.y; });
+    corpus.push_back(sorted);
+
+    CorpusInput grid {"grid 16x16", {}};
+    for (int x = 0; x < 16; x++) for (int y = 0; y < 16; y++) grid.sites.emplace_back(x, y, x * 16 + y + 1);
+    corpus.push_back(grid);
+
+    CorpusInput line {"colinear 150", {}};
+    for (int i = 0; i < 150; i++) line.sites.emplace_back(i * 0.3, i * 0.7, i + 1);
+    corpus.push_back(line);
+
+    SweepPlan sweepOnly;
+    sweepOnly.colinearFastPath = false;
+    sweepOnly.numThreads = 1;
+    SweepPlan oneThread;
+    oneThread.numThreads = 1;
+    std::vector<std::pair<std::string, SweepPlan>> fixedPlans = {
+        {"sweep, 1 thread", sweepOnly},
+        {"all on, 1 thread", oneThread},
+        {"all on, shared pool", SweepPlan()},
+    };
+
+    // The planned configuration is the last one, and pays for its own profiling. Each configuration has a sweeper of
+    // its own, so that its thread pool is made once, outside of the timings.
+    int numConfigs = static_cast<int>(fixedPlans.size()) + 1;
+    std::vector<FortuneSweeper> sweepers(numConfigs);
+    auto runConfig = [&](int config, const std::vector<Vec2> &sites) {
+        FortuneSweeper &algo = sweepers[config];
+        muteStdout();
+        if (config < numConfigs - 1) algo.setPlan(fixedPlans[config].second);
+        auto start = std::chrono::steady_clock::now();
+        if (config == numConfigs - 1) algo.setPlan(planSweep(profileInput(sites)));
+        algo.reset(sites);
+        algo.computeAll();
+        auto end = std::chrono::steady_clock::now();
+        unmuteStdout();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    // Every round times every configuration on every input, interleaved so that noise hits all of them alike, and keeps
+    // the best of a few runs of each, which drops the runs that were preempted. Each round gives a total over the
+    // corpus per configuration.
+    std::vector<std::vector<double>> times(numConfigs * corpus.size());
+    std::vector<std::vector<double>> totals(numConfigs, std::vector<double>(PLANNER_BENCHMARK_ROUNDS, 0));
+    for (int round = 0; round < PLANNER_BENCHMARK_ROUNDS; round++) {
+        for (size_t input = 0; input < corpus.size(); input++) {
+            for (int config = 0; config < numConfigs; config++) {
+                double ms = DOUBLE_INFINITY;
+                for (int run = 0; run < PLANNER_BENCHMARK_RUNS; run++) {
+                    ms = std::min(ms, runConfig(config, corpus[input].sites));
+                }
+                times[input * numConfigs + config].push_back(ms);
+                totals[config][round] += ms;
+            }
+        }
+    }
+
+    // Median, and the range of the values as a fraction of it
+    auto summarize = [](std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        double median = values[values.size() / 2];
+        return std::make_pair(median, (values.back() - values.front()) / median);
+    };
+    auto configName = [&](int config) {
+        return config < numConfigs - 1 ? fixedPlans[config].first.c_str() : "planned";
+    };
+
+    for (size_t input = 0; input < corpus.size(); input++) {
+        for (int config = 0; config < numConfigs; config++) {
+            auto [median, spread] = summarize(times[input * numConfigs + config]);
+            printf("    %-14s %-20s %10.3f ms median, spread %5.1f%%\n", corpus[input].name.c_str(), configName(config),
+                   median, 100 * spread);
+        }
+    }
+
+    // The fixed configuration to beat is the one with the lowest median total over the corpus. The planned one is
+    // compared with it round by round, which cancels the noise that hits a whole round.
+    int bestFixed = 0;
+    for (int config = 0; config < numConfigs; config++) {
+        auto [median, spread] = summarize(totals[config]);
+        printf("    %-14s %-20s %10.3f ms median, spread %5.1f%%\n", "corpus total", configName(config), median,
+               100 * spread);
+        if (config < numConfigs - 1 && median < summarize(totals[bestFixed]).first) bestFixed = config;
+    }
+    std::vector<double> ratios;
+    for (int round = 0; round < PLANNER_BENCHMARK_ROUNDS; round++) {
+        ratios.push_back(totals.back()[round] / totals[bestFixed][round]);
+    }
+    std::sort(ratios.begin(), ratios.end());
+    double median = ratios[ratios.size() / 2];
+    double lowerQuartile = ratios[ratios.size() / 4];
+    double upperQuartile = ratios[ratios.size() * 3 / 4];
+
+    // The bound holds if it holds for the upper quartile, not just for a lucky median, and is broken if even the lower
+    // quartile is over it. In between, the rounds are too noisy to tell.
+    double bound = 1 + PLANNER_BENCHMARK_TOLERANCE;
+    const char* verdict = upperQuartile <= bound ? "within" : lowerQuartile > bound ? "OVER" : "too noisy to check";
+    printf("    Planned: %.1f%% of the time of the best fixed plan, %s, over the corpus\n", 100 * median,
+           fixedPlans[bestFixed].first.c_str());
+    printf("    %.1f%% to %.1f%% in the middle half of the rounds, %s the bound of %.0f%%\n", 100 * lowerQuartile,
+           100 * upperQuartile, verdict, 100 * bound);
+}
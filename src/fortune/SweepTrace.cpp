@@ -0,0 +1,274 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <unistd.h>
+#include "fortune/SweepTrace.hpp"
+#include "fortune/Fortune.hpp"
+#include "utils/ByteReader.hpp"
+#include "utils/files.hpp"
+
+
+SweepTraceWriter::SweepTraceWriter(const std::string &path) : path(path), file(fopen(path.c_str(), "wb")) {
+    if (file == nullptr) throw std::runtime_error("Cannot open file for writing: " + path);
+    out = new OutputBuffer(file);
+}
+
+SweepTraceWriter::~SweepTraceWriter() {
+    if (file == nullptr) return;
+    delete out;
+    fclose(file);
+}
+
+void SweepTraceWriter::begin(const std::vector<Vec2> &sites) {
+    out->put(SWEEP_TRACE_MAGIC, sizeof(SWEEP_TRACE_MAGIC));
+    out->putBinary<uint32_t>(SWEEP_TRACE_VERSION);
+    out->putBinary<uint32_t>(0);
+    out->putBinary<uint64_t>(sites.size());
+    for (const Vec2 &site: sites) {
+        out->putBinary<double>(site.x);
+        out->putBinary<double>(site.y);
+        out->putBinary<int32_t>(site.identifier);
+    }
+}
+
+void SweepTraceWriter::recordEvent(const Event* event) {
+    numEvents++;
+    out->put(static_cast<char>(SWEEP_TRACE_EVENT));
+    if (event->isSiteEvent) out->put(static_cast<char>(SWEEP_TRACE_SITE_EVENT));
+    else if (event->isInvalidated) out->put(static_cast<char>(SWEEP_TRACE_INVALIDATED_EVENT));
+    else out->put(static_cast<char>(SWEEP_TRACE_CIRCLE_EVENT));
+    out->putBinary<double>(event->pos.x);
+    out->putBinary<double>(event->pos.y);
+    if (!event->isSiteEvent) {
+        out->putBinary<double>(event->circleCenter.x);
+        out->putBinary<double>(event->circleCenter.y);
+    }
+}
+
+void SweepTraceWriter::recordVertex(Vec2 position, int label) {
+    out->put(static_cast<char>(SWEEP_TRACE_VERTEX));
+    out->putBinary<double>(position.x);
+    out->putBinary<double>(position.y);
+    out->putVarint(label);
+}
+
+void SweepTraceWriter::recordBeachLine(LinkedNode<BeachChain*, TreeValueFacade*>* leftmost) {
+    scratch.clear();
+    for (auto* node = leftmost; node != nullptr; node = node->next) {
+        if (node->key->isArc) scratch.push_back({node->key, node->key->focus->identifier});
+    }
+
+    // Only the run between the common prefix and suffix changed
+    size_t prefix = 0;
+    while (prefix < arcs.size() && prefix < scratch.size() && arcs[prefix] == scratch[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < arcs.size() - prefix && suffix < scratch.size() - prefix
+           && arcs[arcs.size() - 1 - suffix] == scratch[scratch.size() - 1 - suffix]) {
+        suffix++;
+    }
+
+    size_t removed = arcs.size() - prefix - suffix;
+    size_t inserted = scratch.size() - prefix - suffix;
+    if (removed > 0 || inserted > 0) {
+        out->put(static_cast<char>(SWEEP_TRACE_BEACH_LINE));
+        out->putVarint(prefix);
+        out->putVarint(removed);
+        out->putVarint(inserted);
+        for (size_t i = prefix; i < prefix + inserted; i++) out->putSignedVarint(scratch[i].site);
+    }
+    arcs.swap(scratch);
+}
+
+void SweepTraceWriter::close() {
+    out->put(static_cast<char>(SWEEP_TRACE_END));
+    out->putVarint(numEvents);
+    out->flush();
+    bool ok = out->good();
+    delete out;
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    if (!ok) throw std::runtime_error("Cannot write file: " + path);
+}
+
+
+SweepTrace::SweepTrace(const std::string &path) {
+    MappedFile file(path);
+    ByteReader reader(file.data(), file.data() + file.size(), "sweep trace");
+
+    try {
+        reader.require(sizeof(SWEEP_TRACE_MAGIC));
+        if (memcmp(reader.position, SWEEP_TRACE_MAGIC, sizeof(SWEEP_TRACE_MAGIC)) != 0) reader.fail("Not a");
+        reader.position += sizeof(SWEEP_TRACE_MAGIC);
+        auto version = reader.get<uint32_t>();
+        if (version != SWEEP_TRACE_VERSION) reader.fail("Unsupported version " + std::to_string(version) + " of");
+        if (reader.get<uint32_t>() != 0) reader.fail("Unknown flags in");
+
+        auto numSites = reader.get<uint64_t>();
+        if (numSites > reader.remaining() / (2 * sizeof(double) + sizeof(int32_t))) reader.fail("Truncated");
+        sites.reserve(numSites);
+        for (uint64_t i = 0; i < numSites; i++) {
+            auto x = reader.get<double>();
+            auto y = reader.get<double>();
+            sites.emplace_back(x, y, reader.get<int32_t>());
+        }
+
+        // The splices are applied as they are read, which checks them, and fills in the checkpoints on the way
+        std::vector<int32_t> arcs;
+        while (true) {
+            reader.require(1);
+            auto tag = static_cast<uint8_t>(*reader.position++);
+
+            if (tag == SWEEP_TRACE_EVENT) {
+                if (events.size() % SWEEP_TRACE_CHECKPOINT_INTERVAL == 0) checkpoints.push_back(arcs);
+                auto kind = reader.get<uint8_t>();
+                if (kind > SWEEP_TRACE_INVALIDATED_EVENT) reader.fail("Unknown event kind in");
+                auto x = reader.get<double>();
+                Vec2 position(x, reader.get<double>());
+                Vec2 circleCenter = Vec2::infinity();
+                if (kind != SWEEP_TRACE_SITE_EVENT) {
+                    x = reader.get<double>();
+                    circleCenter = Vec2(x, reader.get<double>());
+                }
+                events.push_back({kind, position, circleCenter, static_cast<int32_t>(vertices.size())});
+                splices.emplace_back();
+
+            } else if (tag == SWEEP_TRACE_VERTEX) {
+                if (events.empty()) reader.fail("Vertex before the first event in");
+                auto x = reader.get<double>();
+                auto y = reader.get<double>();
+                vertices.emplace_back(x, y, static_cast<int>(reader.varint()));
+                events.back().numVertices++;
+
+            } else if (tag == SWEEP_TRACE_BEACH_LINE) {
+                if (events.empty()) reader.fail("Beach line before the first event in");
+                Splice &splice = splices.back();
+                if (splice.removed > 0 || splice.numInserted > 0) {
+                    reader.fail("Second beach line change of an event in");
+                }
+                uint64_t start = reader.varint();
+                uint64_t removed = reader.varint();
+                uint64_t numInserted = reader.varint();
+                if (start > arcs.size() || removed > arcs.size() - start || numInserted > reader.remaining()) {
+                    reader.fail("Beach line change out of range in");
+                }
+                splice.start = static_cast<int32_t>(start);
+                splice.removed = static_cast<int32_t>(removed);
+                splice.numInserted = static_cast<int32_t>(numInserted);
+                splice.firstInserted = insertedSites.size();
+                for (uint64_t i = 0; i < numInserted; i++) {
+                    insertedSites.push_back(static_cast<int32_t>(reader.signedVarint()));
+                }
+                applySplice(arcs, splice);
+
+            } else if (tag == SWEEP_TRACE_END) {
+                if (reader.varint() != events.size()) reader.fail("Wrong event count in");
+                break;
+
+            } else {
+                reader.fail("Unknown record in");
+            }
+        }
+        if (reader.remaining() != 0) reader.fail("Trailing data after the");
+    } catch (std::runtime_error &e) {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+}
+
+void SweepTrace::applySplice(std::vector<int32_t> &arcs, const Splice &splice) const {
+    auto start = arcs.begin() + splice.start;
+    start = arcs.erase(start, start + splice.removed);
+    auto inserted = insertedSites.begin() + static_cast<ptrdiff_t>(splice.firstInserted);
+    arcs.insert(start, inserted, inserted + splice.numInserted);
+}
+
+const std::vector<int32_t> &SweepTrace::beachLineAfter(int event) {
+    if (event < 0 || event >= static_cast<int>(events.size())) throw std::out_of_range("Event outside the trace");
+
+    int checkpoint = event / SWEEP_TRACE_CHECKPOINT_INTERVAL;
+    int checkpointEvent = checkpoint * SWEEP_TRACE_CHECKPOINT_INTERVAL;
+    if (replayedEvent > event || replayedEvent < checkpointEvent - 1) {
+        beachLine = checkpoints[checkpoint];
+        replayedEvent = checkpointEvent - 1;
+    }
+    while (replayedEvent < event) applySplice(beachLine, splices[++replayedEvent]);
+    return beachLine;
+}
+
+
+bool isSweepTraceFile(const std::string &path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return false;
+    char magic[sizeof(SWEEP_TRACE_MAGIC)];
+    bool matches = fread(magic, 1, sizeof(magic), in) == sizeof(magic)
+                   && memcmp(magic, SWEEP_TRACE_MAGIC, sizeof(magic)) == 0;
+    fclose(in);
+    return matches;
+}
+
+
+void sweepTraceTest1() {
+    std::cout << "Testing sweep traces, case 1" << std::endl;
+
+    // One circle event, where the arc of the first site, split by the second, is squeezed out by the third
+    std::vector<Vec2> sites = {Vec2(0, 10, 1), Vec2(-5, 5, 2), Vec2(5, 4, 3)};
+
+    char path[] = "/tmp/voronoi-trace-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    ::close(fd);
+
+    FortuneSweeper algo(sites);
+    {
+        SweepTraceWriter writer(path);
+        algo.setTrace(&writer);
+        algo.computeAll();
+        algo.setTrace(nullptr);
+        writer.close();
+    }
+    assert(isSweepTraceFile(path));
+
+    SweepTrace trace(path);
+    unlink(path);
+    assert(trace.sites.size() == 3 && trace.sites[2].x == 5 && trace.sites[2].identifier == 3);
+    assert(static_cast<int>(trace.events.size()) == algo.currentEventCounter);
+    assert(trace.events.size() == 4 && trace.events[3].kind == SWEEP_TRACE_CIRCLE_EVENT);
+    assert(trace.events[1].position.y == 5 && trace.events[2].numVertices == 0);
+
+    // The circle event offered the circumcenter of the three sites
+    assert(trace.vertices.size() == 1 && trace.events[3].numVertices == 1);
+    assert(trace.vertices[0].x == trace.events[3].circleCenter.x);
+    assert(trace.vertices[0].y == trace.events[3].circleCenter.y);
+    assert(std::abs(trace.vertices[0].distanceTo(sites[0]) - trace.vertices[0].distanceTo(sites[2])) < 1e-9);
+
+    // Seeking backwards replays from the start, and forwards from where the last seek left off
+    assert(trace.beachLineAfter(3) == std::vector<int32_t>({1, 2, 3, 1}));
+    assert(trace.beachLineAfter(0) == std::vector<int32_t>({1}));
+    assert(trace.beachLineAfter(1) == std::vector<int32_t>({1, 2, 1}));
+    assert(trace.beachLineAfter(2) == std::vector<int32_t>({1, 2, 1, 3, 1}));
+    assert(trace.beachLineAfter(3) == std::vector<int32_t>({1, 2, 3, 1}));
+
+    // Every event taken off the queue is in the trace, also those handled along with another one, or dropped in bulk.
+    // The first two sites are a run at the top, and the third is at the bottom of their circle event, which it
+    // invalidates. On the lattice, every row is a run, and every circle event leaves an invalidated twin behind.
+    std::vector<std::vector<Vec2>> degenerate = {{Vec2(0, 1, 1), Vec2(2, 1, 2), Vec2(1, 0, 3)}, {}};
+    for (int i = 0; i < 16; i++) degenerate[1].emplace_back(i % 4, i / 4, i + 1);
+    for (const std::vector<Vec2> &input: degenerate) {
+        algo.reset(input);
+        {
+            SweepTraceWriter writer(path);
+            algo.setTrace(&writer);
+            algo.computeAll();
+            algo.setTrace(nullptr);
+            writer.close();
+        }
+        SweepTrace degenerateTrace(path);
+        unlink(path);
+        assert(static_cast<int>(degenerateTrace.events.size()) == algo.currentEventCounter);
+        size_t siteEvents = 0;
+        for (const SweepTraceEvent &event: degenerateTrace.events) siteEvents += event.kind == SWEEP_TRACE_SITE_EVENT;
+        assert(siteEvents == input.size());
+        assert(degenerateTrace.events.back().kind == SWEEP_TRACE_INVALIDATED_EVENT);
+    }
+}
@@ -0,0 +1,224 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <random>
+#include "geometry/CompactVoronoi.hpp"
+#include "fortune/Fortune.hpp"
+#include "benchmarks.hpp"
+
+#define COMPACT_BATCH_MIN_CHUNK 256
+
+void computeCompactVoronoiBatch(
+    const std::vector<Vec2> &sites,
+    const std::vector<int32_t> &recordOffsets,
+    CompactVoronoiBatch &result,
+    ThreadPool &pool
+) {
+    int numRecords = std::max(static_cast<int>(recordOffsets.size()) - 1, 0);
+    if (numRecords > 0 && recordOffsets[0] < 0) {
+        throw std::invalid_argument("Negative first record offset in compact Voronoi batch");
+    }
+    for (int r = 0; r < numRecords; r++) {
+        int size = recordOffsets[r + 1] - recordOffsets[r];
+        if (size < 0 || size > COMPACT_VORONOI_MAX_SITES || recordOffsets[r + 1] > static_cast<int>(sites.size())) {
+            throw std::invalid_argument("Invalid record " + std::to_string(r) + " in compact Voronoi batch");
+        }
+    }
+
+    // Each chunk of records writes its cell sizes and coordinates into its own buffers
+    struct ChunkOutput {
+        std::vector<int32_t> cellSizes;
+        std::vector<double> x;
+        std::vector<double> y;
+    };
+    std::vector<ChunkOutput> chunks(std::max(pool.numChunks(numRecords, COMPACT_BATCH_MIN_CHUNK), 1));
+
+    pool.parallelFor(numRecords, [&](int begin, int end, int chunk) {
+        ChunkOutput &out = chunks[chunk];
+        CompactVoronoi<> engine;
+        for (int r = begin; r < end; r++) {
+            try {
+                engine.compute(sites.data() + recordOffsets[r], recordOffsets[r + 1] - recordOffsets[r]);
+            } catch (std::invalid_argument &e) {
+                throw std::invalid_argument(std::string(e.what()) + " in record " + std::to_string(r)
+                                            + " of compact Voronoi batch");
+            }
+            for (int i = 0; i < engine.numSites; i++) {
+                out.cellSizes.push_back(engine.cellSize[i]);
+                out.x.insert(out.x.end(), engine.cellX[i], engine.cellX[i] + engine.cellSize[i]);
+                out.y.insert(out.y.end(), engine.cellY[i], engine.cellY[i] + engine.cellSize[i]);
+            }
+        }
+    }, COMPACT_BATCH_MIN_CHUNK);
+
+    // Stitch the chunks together in record order
+    size_t numCells = 0;
+    size_t numVertices = 0;
+    for (const ChunkOutput &out: chunks) {
+        numCells += out.cellSizes.size();
+        numVertices += out.x.size();
+    }
+
+    result.cellOffsets.clear();
+    result.cellOffsets.reserve(numCells + 1);
+    result.cellOffsets.push_back(0);
+    result.cellX.clear();
+    result.cellY.clear();
+    result.cellX.reserve(numVertices);
+    result.cellY.reserve(numVertices);
+    for (const ChunkOutput &out: chunks) {
+        for (int32_t size: out.cellSizes) result.cellOffsets.push_back(result.cellOffsets.back() + size);
+        result.cellX.insert(result.cellX.end(), out.x.begin(), out.x.end());
+        result.cellY.insert(result.cellY.end(), out.y.begin(), out.y.end());
+    }
+}
+
+
+void compactVoronoiTest1() {
+    std::cout << "Testing CompactVoronoi, case 1" << std::endl;
+
+    // Four sites on a square split the box into four equal quadrants
+    std::vector<Vec2> sites = {Vec2(0, 0), Vec2(2, 0), Vec2(2, 2), Vec2(0, 2)};
+    CompactVoronoi<8> voronoi;
+    voronoi.compute(sites.data(), 4, Vec2(-1, -1), Vec2(3, 3));
+    for (int i = 0; i < 4; i++) {
+        assert(voronoi.cellSize[i] == 4);
+        assert(std::abs(voronoi.cellArea(i) - 4) < NUMERICAL_TOLERANCE);
+    }
+
+    // Random sites: the cells tile the box, and every sample lands in the cell of its nearest site
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> coordinate(-10, 10);
+    sites.clear();
+    for (int i = 0; i < COMPACT_VORONOI_MAX_SITES; i++) sites.emplace_back(coordinate(rng), coordinate(rng));
+
+    CompactVoronoi<> full;
+    full.compute(sites.data(), static_cast<int>(sites.size()), Vec2(-20, -20), Vec2(20, 20));
+    double totalArea = 0;
+    for (int i = 0; i < full.numSites; i++) totalArea += full.cellArea(i);
+    assert(std::abs(totalArea - 1600) < 1e-6);
+
+    for (int sample = 0; sample < 1000; sample++) {
+        Vec2 p = Vec2(coordinate(rng), coordinate(rng));
+        int nearest = 0;
+        for (int i = 1; i < full.numSites; i++) {
+            if (p.distanceTo(sites[i]) < p.distanceTo(sites[nearest])) nearest = i;
+        }
+
+        int size = full.cellSize[nearest];
+        for (int v = 0, u = size - 1; v < size; u = v, v++) {
+            double cross = (full.cellX[nearest][v] - full.cellX[nearest][u]) * (p.y - full.cellY[nearest][u])
+                           - (full.cellY[nearest][v] - full.cellY[nearest][u]) * (p.x - full.cellX[nearest][u]);
+            assert(cross >= -1e-9);
+        }
+    }
+}
+
+void compactVoronoiTest2() {
+    std::cout << "Testing CompactVoronoi, case 2" << std::endl;
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> coordinate(-5, 5);
+    std::uniform_int_distribution<int> recordSize(1, COMPACT_VORONOI_MAX_SITES);
+
+    std::vector<Vec2> sites;
+    std::vector<int32_t> recordOffsets = {0};
+    for (int r = 0; r < 2000; r++) {
+        int n = recordSize(rng);
+        for (int i = 0; i < n; i++) sites.emplace_back(coordinate(rng), coordinate(rng));
+        recordOffsets.push_back(static_cast<int32_t>(sites.size()));
+    }
+
+    // The batch output must not depend on how records are spread over threads
+    ThreadPool single(1);
+    ThreadPool several(4);
+    CompactVoronoiBatch a;
+    CompactVoronoiBatch b;
+    computeCompactVoronoiBatch(sites, recordOffsets, a, single);
+    computeCompactVoronoiBatch(sites, recordOffsets, b, several);
+    assert(a.cellOffsets.size() == sites.size() + 1);
+    assert(a.cellOffsets == b.cellOffsets);
+    assert(a.cellX == b.cellX && a.cellY == b.cellY);
+
+    // And must match the single-record engine
+    CompactVoronoi<> voronoi;
+    int r = 1234;
+    voronoi.compute(sites.data() + recordOffsets[r], recordOffsets[r + 1] - recordOffsets[r]);
+    for (int i = 0; i < voronoi.numSites; i++) {
+        int32_t offset = a.cellOffsets[recordOffsets[r] + i];
+        assert(a.cellOffsets[recordOffsets[r] + i + 1] - offset == voronoi.cellSize[i]);
+        for (int v = 0; v < voronoi.cellSize[i]; v++) assert(a.cellX[offset + v] == voronoi.cellX[i][v]);
+    }
+
+    // Records that start before the sites, or have two sites in one place, are refused rather than read out of
+    // bounds or given overlapping cells
+    std::vector<int32_t> negative = {-1, 2};
+    try {
+        computeCompactVoronoiBatch(sites, negative, b, several);
+        assert(false);
+    } catch (std::invalid_argument &e) {}
+
+    assert(recordOffsets[r + 1] - recordOffsets[r] >= 2);
+    sites[recordOffsets[r] + 1] = sites[recordOffsets[r]];
+    try {
+        voronoi.compute(sites.data() + recordOffsets[r], recordOffsets[r + 1] - recordOffsets[r]);
+        assert(false);
+    } catch (std::invalid_argument &e) {
+        assert(std::string(e.what()) == "Sites 1 and 2 coincide" && voronoi.numSites == 0);
+    }
+    try {
+        computeCompactVoronoiBatch(sites, recordOffsets, b, several);
+        assert(false);
+    } catch (std::invalid_argument &e) {
+        assert(std::string(e.what()) == "Sites 1 and 2 coincide in record 1234 of compact Voronoi batch");
+    }
+}
+
+void compactVoronoiBenchmark() {
+    std::cout << "Benchmarking compact Voronoi batches" << std::endl;
+
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> coordinate(-1, 1);
+    std::uniform_int_distribution<int> recordSize(5, 30);
+
+    const int numRecords = 100000;
+    std::vector<Vec2> sites;
+    std::vector<int32_t> recordOffsets = {0};
+    for (int r = 0; r < numRecords; r++) {
+        int n = recordSize(rng);
+        for (int i = 0; i < n; i++) {
+            double x = coordinate(rng);
+            double y = coordinate(rng);
+            sites.emplace_back(x, y);
+        }
+        recordOffsets.push_back(static_cast<int32_t>(sites.size()));
+    }
+
+    // The general sweep, one record at a time, on a slice of the records
+    const int sweptRecords = 2000;
+    FortuneSweeper algo;
+    muteStdout();
+    auto sweepStart = std::chrono::steady_clock::now();
+    for (int r = 0; r < sweptRecords; r++) {
+        std::vector<Vec2> record(sites.begin() + recordOffsets[r], sites.begin() + recordOffsets[r + 1]);
+        for (int i = 0; i < static_cast<int>(record.size()); i++) record[i].identifier = i + 1;
+        algo.reset(record);
+        algo.computeAll();
+    }
+    auto sweepEnd = std::chrono::steady_clock::now();
+    unmuteStdout();
+    double sweepMs = std::chrono::duration<double, std::milli>(sweepEnd - sweepStart).count();
+    printf("    %d records through FortuneSweeper:       %10.3f ms (%.3f us per record)\n",
+           sweptRecords, sweepMs, 1000 * sweepMs / sweptRecords);
+
+    ThreadPool single(1);
+    CompactVoronoiBatch result;
+    for (ThreadPool* pool: {&single, &ThreadPool::shared()}) {
+        auto start = std::chrono::steady_clock::now();
+        computeCompactVoronoiBatch(sites, recordOffsets, result, *pool);
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        printf("    %d records of 5-30 sites, %d thread(s): %10.3f ms (%.3f us per record)\n",
+               numRecords, pool->size(), ms, 1000 * ms / numRecords);
+    }
+}
@@ -1,42 +1,241 @@
 #include <algorithm>
-#include <set>
 #include <cassert>
 #include <cmath>
-#include <unordered_map>
+#include <iostream>
+#include <stdexcept>
 #include "geometry/DCEL.hpp"
 #include "utils/math/mathematics.hpp"
+#include "utils/ThreadPool.hpp"
+#include "utils/SweepLog.hpp"
 
 // Any reasonable number (around 0.1 to 0.5), aesthetics only
 #define BOUNDING_BOX_PADDING 0.362160297
 
-Vertex* DCEL::insertVertex(int label, Vec2 position) {
-    auto* v = new Vertex(label, position);
-//    v->pos.x = std::clamp(v->pos.x, bottomLeftBounds.x, topRightBounds.x);
-//    v->pos.y = std::clamp(v->pos.y, bottomLeftBounds.y, topRightBounds.y);
-    return insert(v);
+bool VertexRef::isNull() const {
+    return index == DCEL_NULL_INDEX;
 }
 
-HalfEdge* DCEL::insertEdge(Vertex* v1, Vertex* v2) {
-    auto* e = new HalfEdge(v1, v2);
-    if (v1->isBoundary || v2->isBoundary) e->unbounded = true;
-    halfEdges.push_back(e);
-    return e;
+int VertexRef::label() const {
+    return dcel->vertexLabel[index];
+}
+
+Vec2 VertexRef::pos() const {
+    return dcel->vertexPos(index);
+}
+
+bool VertexRef::isBoundary() const {
+    return dcel->vertexIsBoundary[index];
+}
+
+HalfEdgeRef VertexRef::incidentEdge() const {
+    return {dcel, dcel->vertexIncidentEdge[index]};
+}
+
+std::string VertexRef::toString() const {
+    return (isBoundary() ? 'b' : 'v') + std::to_string(label());
+}
+
+bool HalfEdgeRef::isNull() const {
+    return index == DCEL_NULL_INDEX;
+}
+
+VertexRef HalfEdgeRef::origin() const {
+    return {dcel, dcel->edgeOrigin[index]};
+}
+
+VertexRef HalfEdgeRef::dest() const {
+    return {dcel, dcel->dest(index)};
+}
+
+HalfEdgeRef HalfEdgeRef::twin() const {
+    return {dcel, DCEL::twin(index)};
+}
+
+HalfEdgeRef HalfEdgeRef::next() const {
+    return {dcel, dcel->edgeNext[index]};
+}
+
+HalfEdgeRef HalfEdgeRef::prev() const {
+    return {dcel, dcel->edgePrev[index]};
+}
+
+FaceRef HalfEdgeRef::incidentFace() const {
+    return {dcel, dcel->edgeFace[index]};
+}
+
+bool HalfEdgeRef::unbounded() const {
+    return dcel->edgeUnbounded[index];
+}
+
+std::string HalfEdgeRef::toString() const {
+    VertexRef o = origin();
+    VertexRef d = dest();
+    return (o.isBoundary() ? "b" : "") + std::to_string(o.label()) + ","
+           + (d.isBoundary() ? "b" : "") + std::to_string(d.label());
+}
+
+bool FaceRef::isNull() const {
+    return index == DCEL_NULL_INDEX;
+}
+
+int FaceRef::label() const {
+    return dcel->faceLabel[index];
+}
+
+HalfEdgeRef FaceRef::outer() const {
+    return {dcel, dcel->faceOuter[index]};
+}
+
+HalfEdgeRef FaceRef::inner() const {
+    return {dcel, dcel->faceInner[index]};
+}
+
+bool FaceRef::unbounded() const {
+    return dcel->faceUnbounded[index];
+}
+
+std::string FaceRef::toString() const {
+    return "f" + std::to_string(label());
+}
+
+
+int32_t DCEL::insertVertex(int label, Vec2 position, bool isBoundary) {
+    vertexX.push_back(position.x);
+    vertexY.push_back(position.y);
+    vertexLabel.push_back(label);
+    vertexIncidentEdge.push_back(DCEL_NULL_INDEX);
+    vertexIsBoundary.push_back(isBoundary);
+    return static_cast<int32_t>(vertexX.size()) - 1;
+}
+
+int32_t DCEL::insertEdge(int32_t origin, int32_t dest) {
+    auto edge = static_cast<int32_t>(edgeOrigin.size());
+    assert(edge % 2 == 0);
+
+    edgeOrigin.push_back(origin);
+    edgeOrigin.push_back(dest);
+    edgeNext.insert(edgeNext.end(), 2, DCEL_NULL_INDEX);
+    edgePrev.insert(edgePrev.end(), 2, DCEL_NULL_INDEX);
+    edgeFace.insert(edgeFace.end(), 2, DCEL_NULL_INDEX);
+
+    // Only the forward half-edge is flagged, the twin is treated as an outer component of its face
+    edgeUnbounded.push_back(vertexIsBoundary[origin] || vertexIsBoundary[dest]);
+    edgeUnbounded.push_back(false);
+
+    return edge;
+}
+
+int32_t DCEL::insertFace(int label, bool unbounded) {
+    faceLabel.push_back(label);
+    faceOuter.push_back(DCEL_NULL_INDEX);
+    faceInner.push_back(DCEL_NULL_INDEX);
+    faceUnbounded.push_back(unbounded);
+    return static_cast<int32_t>(faceLabel.size()) - 1;
+}
+
+void DCEL::offerFaceComponent(int32_t face, int32_t edge) {
+    if (edgeUnbounded[edge]) {
+        faceUnbounded[face] = true;
+        faceOuter[face] = DCEL_NULL_INDEX;
+        faceInner[face] = edge;
+    } else if (!faceUnbounded[face]) {
+        faceOuter[face] = edge;
+    } else {
+        faceInner[face] = edge;
+    }
+}
+
+int32_t DCEL::faceBoundaryEdge(int32_t face) const {
+    return faceOuter[face] != DCEL_NULL_INDEX ? faceOuter[face] : faceInner[face];
+}
+
+void DCEL::chainNext(int32_t edge, int32_t nextEdge) {
+    edgeNext[edge] = nextEdge;
+    edgePrev[nextEdge] = edge;
+}
+
+void DCEL::clear() {
+    vertexX.clear();
+    vertexY.clear();
+    vertexLabel.clear();
+    vertexIncidentEdge.clear();
+    vertexIsBoundary.clear();
+
+    edgeOrigin.clear();
+    edgeNext.clear();
+    edgePrev.clear();
+    edgeFace.clear();
+    edgeUnbounded.clear();
+
+    faceLabel.clear();
+    faceOuter.clear();
+    faceInner.clear();
+    faceUnbounded.clear();
+
+    bottomLeftBounds = Vec2(-DOUBLE_INFINITY, -DOUBLE_INFINITY);
+    topRightBounds = Vec2(DOUBLE_INFINITY, DOUBLE_INFINITY);
+    majorAxis = DOUBLE_INFINITY;
+    centroid = Vec2(0, 0);
+    consolidated = false;
+}
+
+void DCEL::reserve(int vertices, int halfEdges, int faces) {
+    vertexX.reserve(vertices);
+    vertexY.reserve(vertices);
+    vertexLabel.reserve(vertices);
+    vertexIncidentEdge.reserve(vertices);
+    vertexIsBoundary.reserve(vertices);
+
+    edgeOrigin.reserve(halfEdges);
+    edgeNext.reserve(halfEdges);
+    edgePrev.reserve(halfEdges);
+    edgeFace.reserve(halfEdges);
+    edgeUnbounded.reserve(halfEdges);
+
+    faceLabel.reserve(faces);
+    faceOuter.reserve(faces);
+    faceInner.reserve(faces);
+    faceUnbounded.reserve(faces);
 }
 
 int DCEL::numVertices() const {
-    return static_cast<int>(vertices.size());
+    return static_cast<int>(vertexX.size());
 }
 
 int DCEL::numHalfEdges() const {
-    return static_cast<int>(halfEdges.size());
+    return static_cast<int>(edgeOrigin.size());
 }
 
 int DCEL::numEdges() const {
-    return static_cast<int>(halfEdges.size() / 2);
+    return static_cast<int>(edgeOrigin.size() / 2);
 }
 
 int DCEL::numFaces() const {
-    return static_cast<int>(faces.size());
+    return static_cast<int>(faceLabel.size());
+}
+
+DCELRange<VertexRef> DCEL::vertices() const {
+    return {this, numVertices()};
+}
+
+DCELRange<HalfEdgeRef> DCEL::halfEdges() const {
+    return {this, numHalfEdges()};
+}
+
+DCELRange<FaceRef> DCEL::faces() const {
+    return {this, numFaces()};
+}
+
+int32_t DCEL::twin(int32_t edge) {
+    return edge ^ 1;
+}
+
+int32_t DCEL::dest(int32_t edge) const {
+    return edgeOrigin[twin(edge)];
+}
+
+Vec2 DCEL::vertexPos(int32_t vertex) const {
+    return {vertexX[vertex], vertexY[vertex]};
 }
 
 double DCEL::getCenteredX(double x) const {
@@ -49,160 +248,269 @@ double DCEL::getCenteredY(double y) const {
 //    return y / 10.0;
 }
 
-Vertex* DCEL::insertVertex(Vec2 position) {
-    return insertVertex(-1, position);
-}
 
-Vertex* DCEL::insert(Vertex* vertex) {
-    vertices.push_back(vertex);
-    return vertex;
+void DCEL::putVertexName(OutputBuffer &out, int32_t vertex) const {
+    out.put(vertexIsBoundary[vertex] ? 'b' : 'v');
+    out.putInt(vertexLabel[vertex]);
 }
 
-HalfEdge* DCEL::insert(HalfEdge* edge) {
-    halfEdges.push_back(edge);
-    return edge;
+void DCEL::putEdgeName(OutputBuffer &out, int32_t edge) const {
+    if (edge == DCEL_NULL_INDEX) {
+        out.put("nil", 3);
+        return;
+    }
+    int32_t origin = edgeOrigin[edge];
+    int32_t destination = dest(edge);
+    if (vertexIsBoundary[origin]) out.put('b');
+    out.putInt(vertexLabel[origin]);
+    out.put(',');
+    if (vertexIsBoundary[destination]) out.put('b');
+    out.putInt(vertexLabel[destination]);
 }
 
-
-Face* DCEL::insert(Face* face) {
-    faces.push_back(face);
-    return face;
+void DCEL::printOutputVoronoiStyle() const {
+    OutputBuffer out(stdout);
+    writeOutputVoronoiStyle(out);
 }
 
+void DCEL::printOutputDelaunayStyle() const {
+    OutputBuffer out(stdout);
+    writeOutputDelaunayStyle(out);
+}
 
-void DCEL::printOutputVoronoiStyle() {
+void DCEL::writeOutputVoronoiStyle(OutputBuffer &out) const {
     // Print vertices
-    printf("\n");
-    for (Vertex* v: vertices) {
-        printf(
-            "%s %s %s\n",
-            v->toString().c_str(),
-            v->pos.toString(),
-            (v->incidentEdge == nullptr ? "nil" : v->incidentEdge->toString())
-        );
+    out.put('\n');
+    for (int32_t v = 0; v < numVertices(); v++) {
+        putVertexName(out, v);
+        out.put(' ');
+        out.putPoint(vertexX[v], vertexY[v]);
+        out.put(' ');
+        putEdgeName(out, vertexIncidentEdge[v]);
+        out.put('\n');
     }
 
     // Print faces
-    printf("\n");
-    for (Face* f: faces) {
-        printf(
-            "c%d %s%s %s%s\n",
-            f->label,
-            f->outer == nullptr ? "" : "e",
-            f->outer == nullptr ? "nil" : f->outer->toString(),
-            f->inner == nullptr ? "" : "e",
-            f->inner == nullptr ? "nil" : f->inner->toString()
-        );
+    out.put('\n');
+    for (int32_t f = 0; f < numFaces(); f++) {
+        out.put('c');
+        out.putInt(faceLabel[f]);
+        out.put(' ');
+        if (faceOuter[f] != DCEL_NULL_INDEX) out.put('e');
+        putEdgeName(out, faceOuter[f]);
+        out.put(' ');
+        if (faceInner[f] != DCEL_NULL_INDEX) out.put('e');
+        putEdgeName(out, faceInner[f]);
+        out.put('\n');
     }
 
-    // Print vertices
-    printf("\n");
-    for (HalfEdge* e: halfEdges) {
-        printf(
-            "e%s %s e%s %s e%s e%s\n",
-            e->toString(),
-            e->origin->toString().c_str(),
-            e->twin->toString(),
-            (e->incidentFace == nullptr ? "nil" : e->incidentFace->toString().c_str()),
-            (e->next == nullptr ? "nil" : e->next->toString()),
-            (e->prev == nullptr ? "nil" : e->prev->toString())
-        );
+    // Print edges
+    out.put('\n');
+    for (int32_t e = 0; e < numHalfEdges(); e++) {
+        out.put('e');
+        putEdgeName(out, e);
+        out.put(' ');
+        putVertexName(out, edgeOrigin[e]);
+        out.put(" e", 2);
+        putEdgeName(out, twin(e));
+        out.put(' ');
+        if (edgeFace[e] == DCEL_NULL_INDEX) {
+            out.put("nil", 3);
+        } else {
+            out.put('f');
+            out.putInt(faceLabel[edgeFace[e]]);
+        }
+        out.put(" e", 2);
+        putEdgeName(out, edgeNext[e]);
+        out.put(" e", 2);
+        putEdgeName(out, edgePrev[e]);
+        out.put('\n');
     }
 }
 
-void DCEL::printOutputDelaunayStyle() {
+void DCEL::writeOutputDelaunayStyle(OutputBuffer &out) const {
     // Print vertices
-    printf("\n");
-    for (Vertex* v: vertices) {
-        printf(
-            "p%d %s %s\n",
-            v->label,
-            v->pos.toString(),
-            (v->incidentEdge == nullptr ? "nil" : v->incidentEdge->toString())
-        );
+    out.put('\n');
+    for (int32_t v = 0; v < numVertices(); v++) {
+        out.put('p');
+        out.putInt(vertexLabel[v]);
+        out.put(' ');
+        out.putPoint(vertexX[v], vertexY[v]);
+        out.put(' ');
+        putEdgeName(out, vertexIncidentEdge[v]);
+        out.put('\n');
     }
 
     // Print faces
-    printf("\n");
-    for (Face* f: faces) {
-        if (f->unbounded) {
-            printf(
-                "uf %s %s\n",
-                f->outer == nullptr ? "nil" : f->outer->toString(),
-                f->inner == nullptr ? "nil" : f->inner->toString()
-            );
+    out.put('\n');
+    for (int32_t f = 0; f < numFaces(); f++) {
+        if (faceUnbounded[f]) {
+            out.put("uf", 2);
         } else {
-            printf(
-                "t%d %s %s\n",
-                f->label,
-                f->outer == nullptr ? "nil" : f->outer->toString(),
-                f->inner == nullptr ? "nil" : f->inner->toString()
-            );
+            out.put('t');
+            out.putInt(faceLabel[f]);
         }
+        out.put(' ');
+        putEdgeName(out, faceOuter[f]);
+        out.put(' ');
+        putEdgeName(out, faceInner[f]);
+        out.put('\n');
     }
 
-    // Print vertices
-    printf("\n");
-    for (HalfEdge* e: halfEdges) {
-        printf(
-            "d%s p%d d%s %s d%s d%s\n",
-            e->toString(),
-            e->origin->label,
-            e->twin->toString(),
-            (e->incidentFace == nullptr
-             ? "nil"
-             : (e->incidentFace->unbounded ? "uf" : "t" + std::to_string(e->incidentFace->label)).c_str()),
-            (e->next == nullptr ? "nil" : e->next->toString()),
-            (e->prev == nullptr ? "nil" : e->prev->toString())
-        );
+    // Print edges
+    out.put('\n');
+    for (int32_t e = 0; e < numHalfEdges(); e++) {
+        out.put('d');
+        putEdgeName(out, e);
+        out.put(" p", 2);
+        out.putInt(vertexLabel[edgeOrigin[e]]);
+        out.put(" d", 2);
+        putEdgeName(out, twin(e));
+        out.put(' ');
+        int32_t face = edgeFace[e];
+        if (face == DCEL_NULL_INDEX) {
+            out.put("nil", 3);
+        } else if (faceUnbounded[face]) {
+            out.put("uf", 2);
+        } else {
+            out.put('t');
+            out.putInt(faceLabel[face]);
+        }
+        out.put(" d", 2);
+        putEdgeName(out, edgeNext[e]);
+        out.put(" d", 2);
+        putEdgeName(out, edgePrev[e]);
+        out.put('\n');
     }
 }
 
 
-struct VertexPairComparator {
-    bool operator()(const VertexPair* lhs, const VertexPair* rhs) const {
-        // Order-independent comparison of vertex pointers
-        std::pair<Vertex*, Vertex*> minmax_lhs = std::minmax(lhs->v1, lhs->v2);
-        std::pair<Vertex*, Vertex*> minmax_rhs = std::minmax(rhs->v1, rhs->v2);
-        return minmax_lhs < minmax_rhs;
+FaceRings::FaceRings(const DCEL* dcel) : dcel(dcel) {
+    for (int32_t v = 0; v < dcel->numVertices(); v++) {
+        if (dcel->vertexIsBoundary[v]) perimeter.push_back(v);
     }
-};
+    std::sort(perimeter.begin(), perimeter.end(), [&](int32_t a, int32_t b) {
+        return distanceAlongBox(a) < distanceAlongBox(b);
+    });
+    perimeterDistance.reserve(perimeter.size());
+    for (int32_t v: perimeter) perimeterDistance.push_back(distanceAlongBox(v));
+}
 
+int32_t FaceRings::ringSize(int32_t face) const {
+    int32_t size = 0;
+    forEachVertex(face, [&](int32_t) { size++; });
+    return size;
+}
 
-DCELFactory::DCELFactory(const std::vector<Vec2> &sites) : sites(sites) {
-    dcel = new DCEL();
-    for (auto s: sites) {
-        Face* newFace = dcel->insert(new Face(&s));
-        assert(newFace->label == s.identifier);
-        cells.insert({s.identifier, newFace});
+double FaceRings::distanceAlongBox(int32_t vertex) const {
+    Vec2 bottomLeft = dcel->bottomLeftBounds;
+    Vec2 topRight = dcel->topRightBounds;
+    double width = topRight.x - bottomLeft.x;
+    double height = topRight.y - bottomLeft.y;
+    double x = dcel->vertexX[vertex];
+    double y = dcel->vertexY[vertex];
+
+    // Sides in order bottom, right, top, left, and each corner goes with the first side it is on
+    double bottom = std::abs(y - bottomLeft.y);
+    double right = std::abs(x - topRight.x);
+    double top = std::abs(y - topRight.y);
+    double left = std::abs(x - bottomLeft.x);
+    if (bottom <= std::min(right, std::min(top, left))) return x - bottomLeft.x;
+    if (right <= std::min(top, left)) return width + (y - bottomLeft.y);
+    if (top <= left) return width + height + (topRight.x - x);
+    return 2 * width + height + (topRight.y - y);
+}
+
+size_t FaceRings::perimeterPosition(int32_t vertex) const {
+    double distance = distanceAlongBox(vertex);
+    size_t position = std::lower_bound(perimeterDistance.begin(), perimeterDistance.end(), distance)
+                      - perimeterDistance.begin();
+    for (size_t k = 0; k < perimeter.size(); k++) {
+        size_t i = (position + k) % perimeter.size();
+        if (perimeter[i] == vertex) return i;
+    }
+    return position % perimeter.size();
+}
+
+int32_t FaceRings::outgoingEdge(int32_t vertex, int32_t face) const {
+    int32_t first = dcel->vertexIncidentEdge[vertex];
+    int32_t edge = first;
+    for (int steps = 0; edge != DCEL_NULL_INDEX && steps < dcel->numHalfEdges(); steps++) {
+        if (dcel->edgeFace[edge] == face) return edge;
+        edge = dcel->edgeNext[DCEL::twin(edge)];
+        if (edge == first) break;
     }
+    return DCEL_NULL_INDEX;
 }
 
 
-DCEL* DCELFactory::createDCEL(const std::vector<Vec2> &sites) {
-    // Define the bounding box corner coordinates
+DCELFactory::DCELFactory(const std::vector<Vec2> &sites) {
+    reset(sites);
+}
+
+DCELFactory::~DCELFactory() {
+    delete dcel;
+    delete dualGraph;
+}
+
+void DCELFactory::reset(const std::vector<Vec2> &newSites) {
+    sites.assign(newSites.begin(), newSites.end());
+
+    // Euler bounds for n sites: at most 2n - 5 Voronoi vertices and 3n - 6 edges. Every unbounded edge adds a
+    // boundary vertex, and there are at most n of those, on top of the 4 corners.
+    int n = static_cast<int>(sites.size());
+    int maxVoronoiVertices = std::max(2 * n - 5, 1);
+    int maxEdges = std::max(3 * n - 6, n);
+
+    vertexStore.clear();
+    pairStore.clear();
+    vertices.clear();
+    vertices.reserve(maxVoronoiVertices);
+    weldGrid.clear();
+    weldGrid.reserve(maxVoronoiVertices);
+    vertexPairs.clear();
+    vertexPairs.reserve(maxEdges);
+    pendingEdges.clear();
+    pendingEdges.reserve(maxEdges);
+
+    dcel->clear();
+    dcel->reserve(maxVoronoiVertices + n + 4, 2 * maxEdges, n);
+    dualGraph->clear();
+    dualGraph->reserve(n, 2 * maxEdges, maxVoronoiVertices + 1);
+
+    sequentialSites = true;
+    siteIndices.clear();
+    for (auto &s: sites) {
+        int32_t newFace = dcel->insertFace(s.identifier);
+        sequentialSites &= s.identifier == newFace + 1;
+    }
+    if (sequentialSites) return;
+
+    siteIndices.reserve(n);
+    for (int32_t i = 0; i < n; i++) siteIndices.emplace_back(sites[i].identifier, i);
+    std::sort(siteIndices.begin(), siteIndices.end());
+    for (int32_t i = 1; i < n; i++) {
+        if (siteIndices[i].first == siteIndices[i - 1].first) {
+            throw std::invalid_argument("Duplicate site identifier " + std::to_string(siteIndices[i].first));
+        }
+    }
+}
+
+
+void DCELFactory::fitBoundsToSites() {
     bottomLeft = Vec2(DOUBLE_INFINITY, DOUBLE_INFINITY);
     topRight = Vec2(-DOUBLE_INFINITY, -DOUBLE_INFINITY);
 
-    // Adjust the boundary box corners
     for (auto &s: sites) {
         bottomLeft.x = std::min(bottomLeft.x, s.x);
         bottomLeft.y = std::min(bottomLeft.y, s.y);
         topRight.x = std::max(topRight.x, s.x);
         topRight.y = std::max(topRight.y, s.y);
     }
-
-    for (auto &v: vertices) {
-        dcel->vertices.push_back(v);
-
-        // Continue adjusting bounding box corners
-        bottomLeft.x = std::min(bottomLeft.x, v->x());
-        bottomLeft.y = std::min(bottomLeft.y, v->y());
-        topRight.x = std::max(topRight.x, v->x());
-        topRight.y = std::max(topRight.y, v->y());
-    }
+}
 
 
+void DCELFactory::insertBoundingBox() {
     // Equalize axes
     double width = topRight.x - bottomLeft.x;
     double height = topRight.y - bottomLeft.y;
@@ -218,10 +526,10 @@ DCEL* DCELFactory::createDCEL(const std::vector<Vec2> &sites) {
     bottomLeft = bottomLeft - padding;
 
     // Add in the bounding box
-    bl = dcel->insert(Vertex::boundary({bottomLeft.x, bottomLeft.y}, 1));
-    br = dcel->insert(Vertex::boundary({topRight.x, bottomLeft.y}, 2));
-    tr = dcel->insert(Vertex::boundary({topRight.x, topRight.y}, 3));
-    tl = dcel->insert(Vertex::boundary({bottomLeft.x, topRight.y}, 4));
+    bl = dcel->insertVertex(1, {bottomLeft.x, bottomLeft.y}, true);
+    br = dcel->insertVertex(2, {topRight.x, bottomLeft.y}, true);
+    tr = dcel->insertVertex(3, {topRight.x, topRight.y}, true);
+    tl = dcel->insertVertex(4, {bottomLeft.x, topRight.y}, true);
     numBoundaryVertices = 4;
 
     dcel->topRightBounds.x = topRight.x;
@@ -230,29 +538,59 @@ DCEL* DCELFactory::createDCEL(const std::vector<Vec2> &sites) {
     dcel->bottomLeftBounds.y = bottomLeft.y;
     dcel->majorAxis = (majorAxis * (1 + 2 * BOUNDING_BOX_PADDING)) * 0.5;
     dcel->centroid = centroid;
+}
+
+
+DCEL* DCELFactory::createDCEL() {
+    fitBoundsToSites();
+
+    for (auto &v: vertices) {
+        int32_t index = dcel->insertVertex(v->label, v->pos, v->isBoundary);
+        assert(index == vertexIndex(v));
+
+        // Continue adjusting bounding box corners
+        bottomLeft.x = std::min(bottomLeft.x, v->x());
+        bottomLeft.y = std::min(bottomLeft.y, v->y());
+        topRight.x = std::max(topRight.x, v->x());
+        topRight.y = std::max(topRight.y, v->y());
+    }
+
+    insertBoundingBox();
+
+    // First pass: resolve the endpoints that are already known, and queue up a ray for every unbounded end.
+    // The rays are then clipped against the bounding box in one batch.
+    pendingEdges.clear();
+    rayOrigins.clear();
+    rayDirections.clear();
+
+    auto queueRay = [&](Vec2 origin, Vec2 direction) {
+        rayOrigins.push_back(origin);
+        rayDirections.push_back(direction);
+        return static_cast<int>(rayOrigins.size()) - 1;
+    };
 
     for (auto &p: vertexPairs) {
         if (p->v1 == p->v2) continue;
 
-        assert(p->angle != QUIET_NAN);
+        assert(p->direction.x != 0 || p->direction.y != 0);
         assert(p->v1 != nullptr);
 
-        if (vertices.find(p->v1) == vertices.end()) {
+        PendingEdge pending {p, DCEL_NULL_INDEX, DCEL_NULL_INDEX, -1, -1};
+        if (!isOfferedVertex(p->v1)) {
             // Vert 1 is a site event origin
             if (p->v2 == nullptr) {
                 // Both vertices are unbounded
 
                 if (p->v1->y() == INFINITY) {
-                    // Vertical unbounded line
-                    assert(softEquals(std::abs(p->angle), M_PI / 2));
-                    p->v1->pos.y = topRight.y;
-                    p->v2 = dcel->insertVertex({p->v1->x(), bottomLeft.y});
+                    // Vertical unbounded line, running straight across the bounding box
+                    assert(softEquals(p->direction.x, 0));
+                    Vec2 midpoint(p->v1->x(), dcel->centroid.y);
+                    pending.originRay = queueRay(midpoint, {0, 1});
+                    pending.destRay = queueRay(midpoint, {0, -1});
                 } else {
                     // Vert 1 is a site event origin, and is a full unbounded line
-                    Vertex* new1 = getOrCreateBoundaryVertex(p->v1->pos, p->angle + M_PI);
-                    Vertex* new2 = getOrCreateBoundaryVertex(p->v1->pos, p->angle);
-                    p->v1 = dcel->insert(new1);
-                    p->v2 = dcel->insert(new2);
+                    pending.originRay = queueRay(p->v1->pos, p->direction * -1);
+                    pending.destRay = queueRay(p->v1->pos, p->direction);
                 }
             } else {
                 // Vert 1 is a site event origin, vert 2 is a voronoi vertex
@@ -266,134 +604,293 @@ DCEL* DCELFactory::createDCEL(const std::vector<Vec2> &sites) {
                     p->v1->pos.isInfinite = p->v2->y() == INFINITY;
                 }
 
-                double rayAngle = p->angle;
-                if (p->v1->x() < p->v2->x()) rayAngle += M_PI;
-                p->v1 = dcel->insert(getOrCreateBoundaryVertex(p->v2->pos, rayAngle));
+                Vec2 rayDirection = p->v1->x() < p->v2->x() ? p->direction * -1 : p->direction;
+                pending.originRay = queueRay(p->v2->pos, rayDirection);
+                pending.dest = vertexIndex(p->v2);
             }
         } else if (p->v2 == nullptr) {
             // Vert 1 is a voronoi vertex, but is unbounded
-            p->v2 = dcel->insert(getOrCreateBoundaryVertex(p->v1->pos, p->angle));
+            pending.origin = vertexIndex(p->v1);
+            pending.destRay = queueRay(p->v1->pos, p->direction);
         } else {
             // Vert 1 is a voronoi vertex, and vert 2 is non null
             // so vert 2 can't be a site event origin, and thus is another voronoi vertex
-            assert(vertices.find(p->v2) != vertices.end());
+            assert(isOfferedVertex(p->v2));
+            pending.origin = vertexIndex(p->v1);
+            pending.dest = vertexIndex(p->v2);
         }
 
-        HalfEdge* newHalfEdge = dcel->insertEdge(p->v1, p->v2);
-        HalfEdge* twinEdge = newHalfEdge->generateTwin();
-        fwdEdges.push_back(newHalfEdge);
-        dcel->insert(twinEdge);
-        newHalfEdge->bindTwins(twinEdge);
-
-        // Decide which incident face to use
-        Vec2 dir = newHalfEdge->dest->pos - newHalfEdge->origin->pos;
-        Vec2 dirA = (*p->incidentSiteA) - newHalfEdge->origin->pos;
-        Vec2 dirB = (*p->incidentSiteB) - newHalfEdge->origin->pos;
-
-        if (dir.cross(dirA) > 0) {
-            assert(dir.cross(dirB) - NUMERICAL_TOLERANCE <= 0);
-            newHalfEdge->incidentFace = cells.at(p->incidentSiteA->identifier);
-            twinEdge->incidentFace = cells.at(p->incidentSiteB->identifier);
-        } else {
-            assert(dir.cross(dirA) - NUMERICAL_TOLERANCE <= 0);
-            newHalfEdge->incidentFace = cells.at(p->incidentSiteB->identifier);
-            twinEdge->incidentFace = cells.at(p->incidentSiteA->identifier);
-        }
+        pendingEdges.push_back(pending);
+    }
 
-        // Face relation operations
-        newHalfEdge->incidentFace->offerComponent(newHalfEdge);
-        twinEdge->incidentFace->offerComponent(twinEdge);
+    clipRaysToBox(rayOrigins, rayDirections, bottomLeft, topRight, rayExits);
+
+    // Second pass: create the boundary vertices where the rays left the box, then the edges themselves
+    for (auto &pending: pendingEdges) {
+        VertexPair* p = pending.pair;
+        int32_t origin = pending.originRay < 0 ? pending.origin : getOrCreateBoundaryVertex(rayExits[pending.originRay]);
+        int32_t dest = pending.destRay < 0 ? pending.dest : getOrCreateBoundaryVertex(rayExits[pending.destRay]);
+
+        insertSeparatingEdge(origin, dest, siteIndex(p->incidentSiteA), siteIndex(p->incidentSiteB));
     }
 
-    printf(
+    SWEEP_LOG(
         "Pushed all preliminary vertices and edges into DCEL, with %d vertices and %d edges\n",
         dcel->numVertices(), dcel->numHalfEdges()
     );
 
-    return consolidateDCEL(dcel);
+    return consolidateDCEL(dcel, threadPool());
 }
 
-void DCELFactory::offerVertex(Vertex* vertex) {
-    printf("Factory was offered vertex %s: %s\n", vertex->toString().c_str(), vertex->pos.toString());
-    vertices.insert(vertex);
+void DCELFactory::insertSeparatingEdge(int32_t origin, int32_t dest, int32_t faceA, int32_t faceB) {
+    int32_t newHalfEdge = dcel->insertEdge(origin, dest);
+    int32_t twinEdge = DCEL::twin(newHalfEdge);
+
+    // Decide which incident face to use
+    Vec2 originPos = dcel->vertexPos(origin);
+    Vec2 dir = dcel->vertexPos(dest) - originPos;
+    Vec2 dirA = sites[faceA] - originPos;
+    Vec2 dirB = sites[faceB] - originPos;
+
+    if (dir.cross(dirA) > 0) {
+        assert(dir.cross(dirB) - NUMERICAL_TOLERANCE <= 0);
+        dcel->edgeFace[newHalfEdge] = faceA;
+        dcel->edgeFace[twinEdge] = faceB;
+    } else {
+        assert(dir.cross(dirA) - NUMERICAL_TOLERANCE <= 0);
+        dcel->edgeFace[newHalfEdge] = faceB;
+        dcel->edgeFace[twinEdge] = faceA;
+    }
+
+    // Face relation operations
+    dcel->offerFaceComponent(dcel->edgeFace[newHalfEdge], newHalfEdge);
+    dcel->offerFaceComponent(dcel->edgeFace[twinEdge], twinEdge);
+}
+
+
+DCEL* DCELFactory::createColinearDCEL() {
+    int n = static_cast<int>(sites.size());
+    if (n < 2 || !vertices.empty() || !vertexPairs.empty()) return nullptr;
+
+    // Order the sites along the line. Their bisectors are then the ones between neighbours, and are all parallel.
+    Vec2 along = sites[1] - sites[0];
+    for (auto &s: sites) {
+        if (sq(s.x - sites[0].x) + sq(s.y - sites[0].y) > sq(along.x) + sq(along.y)) along = s - sites[0];
+    }
+
+    std::vector<int32_t> order(n);
+    for (int32_t i = 0; i < n; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b) {
+        return along.dot(sites[a]) < along.dot(sites[b]);
+    });
+
+    // Coincident sites are left to the sweep
+    for (int i = 1; i < n; i++) {
+        if (softEquals(sites[order[i - 1]], sites[order[i]])) return nullptr;
+    }
+
+    fitBoundsToSites();
+    insertBoundingBox();
+
+    // Every bisector crosses the whole box, so each one is a pair of rays out of the midpoint of its two sites
+    rayOrigins.clear();
+    rayDirections.clear();
+    for (int i = 1; i < n; i++) {
+        const Vec2 &a = sites[order[i - 1]];
+        const Vec2 &b = sites[order[i]];
+        Vec2 midpoint((a.x + b.x) * 0.5, (a.y + b.y) * 0.5);
+        Vec2 direction = perpendicularBisectorDirection(a, b);
+        rayOrigins.push_back(midpoint);
+        rayDirections.push_back(direction * -1);
+        rayOrigins.push_back(midpoint);
+        rayDirections.push_back(direction);
+    }
+
+    clipRaysToBox(rayOrigins, rayDirections, bottomLeft, topRight, rayExits);
+
+    for (int i = 1; i < n; i++) {
+        int32_t origin = getOrCreateBoundaryVertex(rayExits[2 * (i - 1)]);
+        int32_t dest = getOrCreateBoundaryVertex(rayExits[2 * (i - 1) + 1]);
+        insertSeparatingEdge(origin, dest, order[i - 1], order[i]);
+    }
+
+    SWEEP_LOG(
+        "Built colinear diagram directly, with %d vertices and %d edges\n",
+        dcel->numVertices(), dcel->numHalfEdges()
+    );
+
+    return consolidateDCEL(dcel, threadPool());
+}
+
+
+int64_t DCELFactory::weldCell(double coordinate) {
+    // Far-out coordinates share the cells at the edge of the grid instead of overflowing the cast, and the limit
+    // leaves room for the neighbouring cells on either side. NaN fails both comparisons, and lands on the low edge.
+    double cell = std::floor(coordinate / NUMERICAL_TOLERANCE);
+    if (!(cell > -WELD_CELL_LIMIT)) return -WELD_CELL_LIMIT;
+    if (cell > WELD_CELL_LIMIT) return WELD_CELL_LIMIT;
+    return static_cast<int64_t>(cell);
+}
+
+uint64_t DCELFactory::weldCellKey(int64_t cellX, int64_t cellY) {
+    return static_cast<uint64_t>(cellX) * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(cellY);
+}
+
+Vertex* DCELFactory::createVertex(int label, Vec2 position) {
+    return &vertexStore.emplace_back(label, position);
+}
+
+VertexPair* DCELFactory::createPair() {
+    return &pairStore.emplace_back();
+}
+
+Vertex* DCELFactory::offerVertex(Vertex* vertex) {
+    SWEEP_LOG("Factory was offered vertex %s: %s\n", vertex->toString().c_str(), vertex->pos.toString());
+    assert(vertex->label == numVertices() + 1);
+
+    // Cells are as wide as the tolerance, so any vertex softEquals to this one sits in one of the 9 cells around it
+    int64_t cellX = weldCell(vertex->x());
+    int64_t cellY = weldCell(vertex->y());
+    for (int64_t dx = -1; dx <= 1; dx++) {
+        for (int64_t dy = -1; dy <= 1; dy++) {
+            auto range = weldGrid.equal_range(weldCellKey(cellX + dx, cellY + dy));
+            for (auto it = range.first; it != range.second; it++) {
+                Vertex* existing = vertices[it->second];
+                if (!softEquals(existing->pos, vertex->pos)) continue;
+
+                SWEEP_LOG("Welded vertex %s into %s\n", vertex->toString().c_str(), existing->toString().c_str());
+                return existing;
+            }
+        }
+    }
+
+    weldGrid.emplace(weldCellKey(cellX, cellY), static_cast<int32_t>(vertices.size()));
+    vertices.push_back(vertex);
+    return vertex;
 }
 
 void DCELFactory::offerPair(VertexPair* vertexPair) {
     Vertex* v1 = vertexPair->v1;
     Vertex* v2 = vertexPair->v2;
-    printf("Factory was offered vertex pair: <\n\tFROM %s\n\tTO\t %s\n> with angle %f rad (%f deg)\n",
-           v1 == nullptr ? "null" : (v1->toString() + " " + v1->pos.toString()).c_str(),
-           v2 == nullptr ? "null" : (v2->toString() + " " + v2->pos.toString()).c_str(),
-           vertexPair->angle,
-           vertexPair->angle / M_PI * 180.0
+    SWEEP_LOG("Factory was offered vertex pair: <\n\tFROM %s\n\tTO\t %s\n> with direction %s\n",
+              v1 == nullptr ? "null" : (v1->toString() + " " + v1->pos.toString()).c_str(),
+              v2 == nullptr ? "null" : (v2->toString() + " " + v2->pos.toString()).c_str(),
+              vertexPair->direction.toString()
     );
-    vertexPairs.insert(vertexPair);
+    vertexPairs.push_back(vertexPair);
+}
+
+void DCELFactory::setThreadPool(ThreadPool* newPool) {
+    pool = newPool;
+}
+
+ThreadPool &DCELFactory::threadPool() const {
+    return pool == nullptr ? ThreadPool::shared() : *pool;
 }
 
 int DCELFactory::numVertices() {
     return static_cast<int>(vertices.size());
 }
 
-Vertex* DCELFactory::getOrCreateBoundaryVertex(Vec2 origin, double angle) {
-    Vec2 intersect = rayIntersectBox(origin, angle, bottomLeft, topRight);
+int32_t DCELFactory::getOrCreateBoundaryVertex(Vec2 intersect) {
+    if (softEquals(intersect, dcel->vertexPos(bl))) return bl;
+    if (softEquals(intersect, dcel->vertexPos(br))) return br;
+    if (softEquals(intersect, dcel->vertexPos(tr))) return tr;
+    if (softEquals(intersect, dcel->vertexPos(tl))) return tl;
 
-    if (softEquals(intersect, bl->pos)) return bl;
-    if (softEquals(intersect, br->pos)) return br;
-    if (softEquals(intersect, tr->pos)) return tr;
-    if (softEquals(intersect, tl->pos)) return tl;
+    return dcel->insertVertex(++numBoundaryVertices, intersect, true);
+}
 
-    return Vertex::boundary(intersect, ++numBoundaryVertices);
+bool DCELFactory::isOfferedVertex(const Vertex* vertex) const {
+    int label = vertex->label;
+    return label >= 1 && label <= static_cast<int>(vertices.size()) && vertices[label - 1] == vertex;
 }
 
+int32_t DCELFactory::vertexIndex(const Vertex* vertex) const {
+    assert(isOfferedVertex(vertex));
+    return vertex->label - 1;
+}
 
-void printIncidenceSet(std::set<HalfEdge*, HalfEdgeAngleComparator>* incidenceSet) {
-    for (HalfEdge* edge: *incidenceSet) {
-        printf("%s - %f (%f deg)\n", edge->toString(), edge->angle, edge->angle / M_PI * 180);
+int32_t DCELFactory::siteIndex(const Vec2* site) const {
+    if (sequentialSites) {
+        assert(site->identifier >= 1 && site->identifier <= static_cast<int>(sites.size()));
+        return site->identifier - 1;
     }
+    auto entry = std::lower_bound(siteIndices.begin(), siteIndices.end(), std::make_pair(site->identifier, 0));
+    assert(entry != siteIndices.end() && entry->first == site->identifier);
+    return entry->second;
 }
 
-DCEL* DCELFactory::consolidateDCEL(DCEL* geometry) {
-    std::unordered_map<Vertex*, std::set<HalfEdge*, HalfEdgeAngleComparator>*> incidenceMap {};
 
-    // Set up the incidence map
-    for (Vertex* v: geometry->vertices) {
-        auto* newSet = new std::set<HalfEdge*, HalfEdgeAngleComparator>();
-        incidenceMap.insert({v, newSet});
+// Below this many half-edges, the incidence build is done on the calling thread only
+#define PARALLEL_CONSOLIDATE_MIN_CHUNK 2048
+
+struct IncidenceRecord {
+    int32_t origin;
+    int32_t edge;
+    double angle;
+};
+
+// Orders half-edges by origin, then by (pseudo-)angle around the origin. Ties in angle are kept in insertion order,
+// so that only the first of several coincident edges gets linked.
+struct IncidenceRecordComparator {
+    bool operator()(const IncidenceRecord &lhs, const IncidenceRecord &rhs) const {
+        if (lhs.origin != rhs.origin) return lhs.origin < rhs.origin;
+        if (lhs.angle != rhs.angle) return lhs.angle < rhs.angle;
+        return lhs.edge < rhs.edge;
     }
+};
+
+DCEL* DCELFactory::consolidateDCEL(DCEL* geometry, ThreadPool &pool) {
 
-    // Go through each outer and update the incidence map
-    for (HalfEdge* fwdEdge: geometry->halfEdges) {
-        try {
-            incidenceMap.at(fwdEdge->origin)->insert(fwdEdge);
-        } catch (std::out_of_range const &) {
-            continue;
+    // Flat list of every half-edge, sorted by origin and then angle
+    int numRecords = geometry->numHalfEdges();
+    std::vector<IncidenceRecord> incidence(numRecords);
+    pool.parallelFor(numRecords, [&](int begin, int end, int) {
+        for (int32_t e = begin; e < end; e++) {
+            Vec2 dir = geometry->vertexPos(geometry->dest(e)) - geometry->vertexPos(geometry->edgeOrigin[e]);
+            incidence[e] = {geometry->edgeOrigin[e], e, pseudoAngle(dir)};
         }
+    }, PARALLEL_CONSOLIDATE_MIN_CHUNK);
+    parallelSort(incidence.begin(), incidence.end(), IncidenceRecordComparator(), pool);
+
+    // Split the sorted list into runs sharing the same origin. Every run is independent of the others: each half-edge
+    // is the prev of exactly one edge and the next of exactly one twin, so the runs can be linked concurrently.
+    std::vector<int> runStarts;
+    for (int i = 0; i < numRecords; i++) {
+        if (i == 0 || incidence[i].origin != incidence[i - 1].origin) runStarts.push_back(i);
     }
+    int numRuns = static_cast<int>(runStarts.size());
+    runStarts.push_back(numRecords);
+
+    pool.parallelFor(numRuns, [&](int runBegin, int runEnd, int) {
+        std::vector<int32_t> incidenceSet;
+        for (int r = runBegin; r < runEnd; r++) {
+            int32_t v = incidence[runStarts[r]].origin;
+
+            // Drop edges that have the same angle as the one before them
+            incidenceSet.clear();
+            for (int i = runStarts[r]; i < runStarts[r + 1]; i++) {
+                if (i > runStarts[r] && incidence[i].angle == incidence[i - 1].angle) continue;
+                incidenceSet.push_back(incidence[i].edge);
+            }
 
-    // Now, work out the next/prev relationship for each vertex
-    for (Vertex* v: geometry->vertices) {
-        std::set<HalfEdge*, HalfEdgeAngleComparator>* incidenceSet = incidenceMap.at(v);
-//        printIncidenceSet(incidenceSet);
-
-        // Check if there are more than 2 edges through this vertex
-        if (incidenceSet->empty()) continue;
+            if (incidenceSet.size() == 1) {
+                int32_t edge = incidenceSet.front();
+                geometry->vertexIncidentEdge[v] = edge;
+                geometry->chainNext(DCEL::twin(edge), edge);
+                continue;
+            }
 
-        if (incidenceSet->size() == 1) {
-            HalfEdge* edge = *incidenceSet->begin();
-            v->incidentEdge = edge;
-            edge->twin->chainNext(edge);
-            continue;
+            // Establish the prev/next outer relation
+            int32_t edge = incidenceSet.back();
+            geometry->vertexIncidentEdge[v] = edge;
+            for (int32_t nextEdge: incidenceSet) {
+                geometry->chainNext(DCEL::twin(nextEdge), edge);
+                edge = nextEdge;
+            }
         }
-
-        // Establish the prev/next outer relation
-        HalfEdge* edge = *incidenceSet->rbegin();
-        assert(edge != nullptr);
-        v->incidentEdge = edge;
-        for (HalfEdge* nextEdge: *incidenceSet) {
-            nextEdge->twin->chainNext(edge);
-            edge = nextEdge;
-        }
-    }
+    }, PARALLEL_CONSOLIDATE_MIN_CHUNK);
 
     geometry->consolidated = true;
 
@@ -408,16 +905,13 @@ DCEL* DCELFactory::buildDualGraph() {
     assert(dcel->numEdges() > 0);
     assert(dcel->numFaces() > 0);
 
-    DCEL* dualGraph = new DCEL();
+    dualGraph->clear();
     bottomLeft = Vec2(DOUBLE_INFINITY, DOUBLE_INFINITY);
     topRight = Vec2(-DOUBLE_INFINITY, -DOUBLE_INFINITY);
 
-    std::unordered_map<int, Vertex*> siteVertices;
-    for (Vec2 s: sites) {
-        auto* newVertex = new Vertex(s.identifier, s);
-        dualGraph->insert(newVertex);
-
-        siteVertices.insert({s.identifier, newVertex});
+    // Sites are inserted in the same order as the Voronoi cells, so a cell's index is also its site's vertex index
+    for (auto &s: sites) {
+        dualGraph->insertVertex(s.identifier, s);
 
         // Also calculate the bounding box
         bottomLeft.x = std::min(bottomLeft.x, s.x);
@@ -442,44 +936,85 @@ DCEL* DCELFactory::buildDualGraph() {
     dualGraph->majorAxis = (majorAxis * (1 + 2 * BOUNDING_BOX_PADDING)) * 0.5;
     dualGraph->centroid = centroid;
 
-    // Map between Voronoi vertices and triangulation faces
-    std::unordered_map<Vertex*, Face*> triangleMap;
-    for (auto &v: dcel->vertices) {
-        if (v->isBoundary) continue;
-        auto* newFace = new Face(new Vec2(v->pos.x, v->pos.y, dualGraph->numFaces() + 1));
-        dualGraph->insert(newFace);
-        triangleMap.insert({v, newFace});
+    // Map between Voronoi vertices and triangulation faces, boundary vertices all map to the unbounded face
+    std::vector<int32_t> triangleMap(dcel->numVertices(), DCEL_NULL_INDEX);
+    for (int32_t v = 0; v < dcel->numVertices(); v++) {
+        if (dcel->vertexIsBoundary[v]) continue;
+        triangleMap[v] = dualGraph->insertFace(dualGraph->numFaces() + 1);
+    }
+    int32_t unboundedFace = dualGraph->insertFace(-1, true);
+    for (int32_t v = 0; v < dcel->numVertices(); v++) {
+        if (dcel->vertexIsBoundary[v]) triangleMap[v] = unboundedFace;
     }
-    auto* unboundedFace = new Face();
-    unboundedFace->unbounded = true;
-    dualGraph->insert(unboundedFace);
-
-    for (auto &edge: fwdEdges) {
-        try {
-            Face* leftOuterFace = edge->dest->isBoundary ? unboundedFace : triangleMap.at(edge->dest);
-            Face* rightOuterFace = edge->origin->isBoundary ? unboundedFace : triangleMap.at(edge->origin);
 
-            Face* leftFace = edge->incidentFace;
-            Face* rightFace = edge->twin->incidentFace;
+    // Build the dual edges of each chunk of Voronoi edges into a per-chunk buffer. Face bookkeeping is order dependent,
+    // so it is done afterwards, by merging the buffers back in chunk order.
+    struct DualEdgeRecord {
+        int32_t origin;
+        int32_t dest;
+        int32_t leftOuterFace;
+        int32_t rightOuterFace;
+    };
+
+    ThreadPool &pool = threadPool();
+    int numFwdEdges = dcel->numEdges();
+    std::vector<std::vector<DualEdgeRecord>> chunkBuffers(pool.numChunks(numFwdEdges, PARALLEL_CONSOLIDATE_MIN_CHUNK));
+
+    pool.parallelFor(numFwdEdges, [&](int begin, int end, int chunk) {
+        std::vector<DualEdgeRecord> &buffer = chunkBuffers[chunk];
+        buffer.reserve(end - begin);
+
+        for (int i = begin; i < end; i++) {
+            int32_t edge = 2 * i;
+            int32_t leftFace = dcel->edgeFace[edge];
+            int32_t rightFace = dcel->edgeFace[DCEL::twin(edge)];
             if (leftFace == rightFace) continue;
 
-            HalfEdge* dualEdge = new HalfEdge(siteVertices.at(leftFace->label), siteVertices.at(rightFace->label));
-            HalfEdge* twinEdge = dualEdge->generateTwin();
+            buffer.push_back({
+                leftFace,
+                rightFace,
+                triangleMap[dcel->dest(edge)],
+                triangleMap[dcel->edgeOrigin[edge]]
+            });
+        }
+    }, PARALLEL_CONSOLIDATE_MIN_CHUNK);
 
-            dualEdge->incidentFace = leftOuterFace;
-            twinEdge->incidentFace = rightOuterFace;
-            leftOuterFace->offerComponent(dualEdge);
-            rightOuterFace->offerComponent(twinEdge);
+    for (auto &buffer: chunkBuffers) {
+        for (auto &record: buffer) {
+            int32_t dualEdge = dualGraph->insertEdge(record.origin, record.dest);
+            int32_t twinEdge = DCEL::twin(dualEdge);
 
-            dualEdge->bindTwins(twinEdge);
-            dualGraph->insert(dualEdge);
-            dualGraph->insert(twinEdge);
-        } catch (std::out_of_range const &) {
-            continue;
+            dualGraph->edgeFace[dualEdge] = record.leftOuterFace;
+            dualGraph->edgeFace[twinEdge] = record.rightOuterFace;
+            dualGraph->offerFaceComponent(record.leftOuterFace, dualEdge);
+            dualGraph->offerFaceComponent(record.rightOuterFace, twinEdge);
         }
     }
 
-    consolidateDCEL(dualGraph);
+    consolidateDCEL(dualGraph, threadPool());
 
     return dualGraph;
 }
+
+
+void dcelFactoryTest1() {
+    std::cout << "Testing DCELFactory, case 1" << std::endl;
+
+    DCELFactory factory({Vec2(0, 0, 1), Vec2(1, 0, 2)});
+    auto offer = [&](double x, double y) {
+        return factory.offerVertex(factory.createVertex(factory.numVertices() + 1, {x, y}));
+    };
+
+    // Vertices within the tolerance are welded, even across the border of two cells of the grid
+    Vertex* a = offer(NUMERICAL_TOLERANCE - 1e-9, 0.5);
+    assert(offer(NUMERICAL_TOLERANCE + 1e-9, 0.5) == a);
+    assert(offer(3 * NUMERICAL_TOLERANCE, 0.5) != a);
+
+    // Coordinates past the range of the grid share its edge cells, where they are still told apart by distance
+    Vertex* far = offer(1e15, -1e15);
+    assert(offer(1e15 + 1, -1e15) != far);
+    assert(offer(1e15, -1e15) == far);
+    Vertex* huge = offer(-1e300, 1e300);
+    assert(offer(1e300, 1e300) != huge && offer(-1e300, 1e300) == huge);
+    assert(factory.numVertices() == 6);
+}
@@ -0,0 +1,426 @@
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <stdexcept>
+#include "geometry/DCELArchive.hpp"
+#include "fortune/Fortune.hpp"
+#include "utils/files.hpp"
+#include "utils/ByteReader.hpp"
+#include "benchmarks.hpp"
+
+static_assert(sizeof(DCELArchiveHeader) == DCEL_ARCHIVE_HEADER_SIZE, "DCEL archive header must be packed");
+
+// Smallest encoding of each kind of record, which bounds the counts a header can claim for the bytes left
+#define DCEL_ARCHIVE_MIN_VERTEX_BYTES 4
+#define DCEL_ARCHIVE_MIN_EDGE_BYTES 3
+#define DCEL_ARCHIVE_MIN_FACE_BYTES 3
+
+static void putFlags(OutputBuffer &out, const std::vector<uint8_t> &flags) {
+    for (size_t i = 0; i < flags.size(); i += 8) {
+        uint8_t byte = 0;
+        for (size_t j = i; j < std::min(i + 8, flags.size()); j++) byte |= (flags[j] ? 1 : 0) << (j - i);
+        out.put(static_cast<char>(byte));
+    }
+}
+
+static void readFlags(ByteReader &reader, std::vector<uint8_t> &flags) {
+    size_t numBytes = (flags.size() + 7) / 8;
+    reader.require(numBytes);
+    for (size_t i = 0; i < flags.size(); i++) flags[i] = (static_cast<uint8_t>(reader.position[i / 8]) >> (i % 8)) & 1;
+    reader.position += numBytes;
+}
+
+// The header goes out field by field, little-endian like the rest of the format, rather than as the struct in host
+// order
+static void putHeader(OutputBuffer &out, const DCELArchiveHeader &header) {
+    out.put(header.magic, sizeof(header.magic));
+    out.putBinary(header.version);
+    out.putBinary(header.flags);
+    out.putBinary(header.numVertices);
+    out.putBinary(header.numHalfEdges);
+    out.putBinary(header.numFaces);
+    out.putBinary(header.coordinateBits);
+    for (double value: {header.originX, header.originY, header.step, header.bottomLeftX, header.bottomLeftY,
+                        header.topRightX, header.topRightY, header.majorAxis, header.centroidX, header.centroidY}) {
+        out.putBinary(value);
+    }
+}
+
+static DCELArchiveHeader readHeader(ByteReader &reader) {
+    DCELArchiveHeader header {};
+    reader.require(DCEL_ARCHIVE_HEADER_SIZE);
+    memcpy(header.magic, reader.position, sizeof(header.magic));
+    reader.position += sizeof(header.magic);
+    header.version = reader.get<uint32_t>();
+    header.flags = reader.get<uint32_t>();
+    header.numVertices = reader.get<int32_t>();
+    header.numHalfEdges = reader.get<int32_t>();
+    header.numFaces = reader.get<int32_t>();
+    header.coordinateBits = reader.get<uint32_t>();
+    for (double* value: {&header.originX, &header.originY, &header.step, &header.bottomLeftX, &header.bottomLeftY,
+                         &header.topRightX, &header.topRightY, &header.majorAxis, &header.centroidX,
+                         &header.centroidY}) {
+        *value = reader.get<double>();
+    }
+    return header;
+}
+
+// Decodes one delta, and checks that the index it leads to is a record, or null
+static int32_t readIndex(ByteReader &reader, int64_t base, int32_t count) {
+    int64_t index = base + reader.signedVarint();
+    if (index < DCEL_NULL_INDEX || index >= count) reader.fail("Index out of range in");
+    return static_cast<int32_t>(index);
+}
+
+
+void writeDCELArchive(OutputBuffer &out, const DCEL* dcel, int coordinateBits) {
+    if (coordinateBits < 1 || coordinateBits > DCEL_ARCHIVE_MAX_BITS) {
+        throw std::invalid_argument("Coordinate bits must be between 1 and " + std::to_string(DCEL_ARCHIVE_MAX_BITS));
+    }
+
+    DCELArchiveHeader header {};
+    memcpy(header.magic, DCEL_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = DCEL_ARCHIVE_VERSION;
+    header.numVertices = dcel->numVertices();
+    header.numHalfEdges = dcel->numHalfEdges();
+    header.numFaces = dcel->numFaces();
+    header.coordinateBits = coordinateBits;
+    header.bottomLeftX = dcel->bottomLeftBounds.x;
+    header.bottomLeftY = dcel->bottomLeftBounds.y;
+    header.topRightX = dcel->topRightBounds.x;
+    header.topRightY = dcel->topRightBounds.y;
+    header.majorAxis = dcel->majorAxis;
+    header.centroidX = dcel->centroid.x;
+    header.centroidY = dcel->centroid.y;
+    if (dcel->consolidated) header.flags |= DCEL_ARCHIVE_CONSOLIDATED;
+    for (int32_t e = 0; e < dcel->numHalfEdges(); e++) {
+        int32_t next = dcel->edgeNext[e];
+        if (next == DCEL_NULL_INDEX ? dcel->edgePrev[e] != DCEL_NULL_INDEX : dcel->edgePrev[next] != e) {
+            header.flags |= DCEL_ARCHIVE_PREV;
+            break;
+        }
+    }
+
+    // The grid spans the larger side of the vertex bounds, so both axes share one step
+    double minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+    for (int32_t v = 0; v < dcel->numVertices(); v++) {
+        if (!std::isfinite(dcel->vertexX[v]) || !std::isfinite(dcel->vertexY[v])) {
+            throw std::invalid_argument("Cannot archive a DCEL with vertices at infinity");
+        }
+        minX = std::min(minX, dcel->vertexX[v]);
+        minY = std::min(minY, dcel->vertexY[v]);
+        maxX = std::max(maxX, dcel->vertexX[v]);
+        maxY = std::max(maxY, dcel->vertexY[v]);
+    }
+    double extent = std::max(maxX - minX, maxY - minY);
+    header.originX = dcel->numVertices() > 0 ? minX : 0;
+    header.originY = dcel->numVertices() > 0 ? minY : 0;
+    header.step = extent > 0 ? extent / static_cast<double>((uint64_t(1) << coordinateBits) - 1) : 1;
+    putHeader(out, header);
+
+    int64_t previousX = 0, previousY = 0, previousLabel = 0, previousIncident = 0;
+    for (int32_t v = 0; v < dcel->numVertices(); v++) {
+        auto x = static_cast<int64_t>(std::llround((dcel->vertexX[v] - header.originX) / header.step));
+        auto y = static_cast<int64_t>(std::llround((dcel->vertexY[v] - header.originY) / header.step));
+        out.putSignedVarint(x - previousX);
+        out.putSignedVarint(y - previousY);
+        out.putSignedVarint(dcel->vertexLabel[v] - previousLabel);
+        out.putSignedVarint(dcel->vertexIncidentEdge[v] - previousIncident);
+        previousX = x;
+        previousY = y;
+        previousLabel = dcel->vertexLabel[v];
+        previousIncident = dcel->vertexIncidentEdge[v];
+    }
+    putFlags(out, dcel->vertexIsBoundary);
+
+    int64_t previousOrigin = 0, previousFace = 0;
+    for (int32_t e = 0; e < dcel->numHalfEdges(); e++) {
+        // Twins are adjacent, so the odd half-edges are coded against their twin
+        int64_t origin = dcel->edgeOrigin[e];
+        out.putSignedVarint(origin - (e % 2 == 0 ? previousOrigin : dcel->edgeOrigin[e - 1]));
+        if (e % 2 == 0) previousOrigin = origin;
+        out.putSignedVarint(dcel->edgeNext[e] - e);
+        out.putSignedVarint(dcel->edgeFace[e] - previousFace);
+        previousFace = dcel->edgeFace[e];
+        if (header.flags & DCEL_ARCHIVE_PREV) out.putSignedVarint(dcel->edgePrev[e] - e);
+    }
+    putFlags(out, dcel->edgeUnbounded);
+
+    int64_t previousOuter = 0, previousInner = 0;
+    previousLabel = 0;
+    for (int32_t f = 0; f < dcel->numFaces(); f++) {
+        out.putSignedVarint(dcel->faceLabel[f] - previousLabel);
+        out.putSignedVarint(dcel->faceOuter[f] - previousOuter);
+        out.putSignedVarint(dcel->faceInner[f] - previousInner);
+        previousLabel = dcel->faceLabel[f];
+        previousOuter = dcel->faceOuter[f];
+        previousInner = dcel->faceInner[f];
+    }
+    putFlags(out, dcel->faceUnbounded);
+}
+
+
+const char* readDCELArchive(const char* begin, const char* end, DCEL &dcel) {
+    if (end - begin < DCEL_ARCHIVE_HEADER_SIZE) throw std::runtime_error("Truncated DCEL archive");
+    ByteReader reader(begin, end, "DCEL archive");
+    DCELArchiveHeader header = readHeader(reader);
+    if (memcmp(header.magic, DCEL_ARCHIVE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a DCEL archive");
+    }
+    if (header.version != DCEL_ARCHIVE_VERSION) {
+        throw std::runtime_error("Unsupported version " + std::to_string(header.version) + " of DCEL archive");
+    }
+    if ((header.flags & ~static_cast<uint32_t>(DCEL_ARCHIVE_CONSOLIDATED | DCEL_ARCHIVE_PREV)) != 0) {
+        throw std::runtime_error("Unknown flags in DCEL archive");
+    }
+
+    // Every record takes some bytes, so counts that don't fit in the rest of the data are corrupt
+    uint64_t available = end - begin - DCEL_ARCHIVE_HEADER_SIZE;
+    if (header.numVertices < 0 || header.numHalfEdges < 0 || header.numHalfEdges % 2 != 0 || header.numFaces < 0
+        || static_cast<uint64_t>(header.numVertices) * DCEL_ARCHIVE_MIN_VERTEX_BYTES
+           + static_cast<uint64_t>(header.numHalfEdges) * DCEL_ARCHIVE_MIN_EDGE_BYTES
+           + static_cast<uint64_t>(header.numFaces) * DCEL_ARCHIVE_MIN_FACE_BYTES > available) {
+        throw std::runtime_error("Record counts don't fit in the DCEL archive");
+    }
+
+    int32_t numVertices = header.numVertices;
+    int32_t numHalfEdges = header.numHalfEdges;
+    int32_t numFaces = header.numFaces;
+    dcel.clear();
+    dcel.vertexX.resize(numVertices);
+    dcel.vertexY.resize(numVertices);
+    dcel.vertexLabel.resize(numVertices);
+    dcel.vertexIncidentEdge.resize(numVertices);
+    dcel.vertexIsBoundary.resize(numVertices);
+    dcel.edgeOrigin.resize(numHalfEdges);
+    dcel.edgeNext.resize(numHalfEdges);
+    dcel.edgePrev.resize(numHalfEdges, DCEL_NULL_INDEX);
+    dcel.edgeFace.resize(numHalfEdges);
+    dcel.edgeUnbounded.resize(numHalfEdges);
+    dcel.faceLabel.resize(numFaces);
+    dcel.faceOuter.resize(numFaces);
+    dcel.faceInner.resize(numFaces);
+    dcel.faceUnbounded.resize(numFaces);
+
+    int64_t x = 0, y = 0, label = 0;
+    int32_t incident = 0;
+    for (int32_t v = 0; v < numVertices; v++) {
+        x += reader.signedVarint();
+        y += reader.signedVarint();
+        label += reader.signedVarint();
+        incident = readIndex(reader, incident, numHalfEdges);
+        dcel.vertexX[v] = header.originX + static_cast<double>(x) * header.step;
+        dcel.vertexY[v] = header.originY + static_cast<double>(y) * header.step;
+        dcel.vertexLabel[v] = static_cast<int32_t>(label);
+        dcel.vertexIncidentEdge[v] = incident;
+    }
+    readFlags(reader, dcel.vertexIsBoundary);
+
+    int32_t origin = 0, face = 0;
+    for (int32_t e = 0; e < numHalfEdges; e++) {
+        int32_t edgeOrigin = readIndex(reader, e % 2 == 0 ? origin : dcel.edgeOrigin[e - 1], numVertices);
+        if (edgeOrigin == DCEL_NULL_INDEX) reader.fail("Half-edge without an origin in");
+        if (e % 2 == 0) origin = edgeOrigin;
+        dcel.edgeOrigin[e] = edgeOrigin;
+        dcel.edgeNext[e] = readIndex(reader, e, numHalfEdges);
+        face = readIndex(reader, face, numFaces);
+        dcel.edgeFace[e] = face;
+        if (header.flags & DCEL_ARCHIVE_PREV) dcel.edgePrev[e] = readIndex(reader, e, numHalfEdges);
+    }
+    if (!(header.flags & DCEL_ARCHIVE_PREV)) {
+        for (int32_t e = 0; e < numHalfEdges; e++) {
+            if (dcel.edgeNext[e] != DCEL_NULL_INDEX) dcel.edgePrev[dcel.edgeNext[e]] = e;
+        }
+    }
+    readFlags(reader, dcel.edgeUnbounded);
+
+    int32_t outer = 0, inner = 0;
+    label = 0;
+    for (int32_t f = 0; f < numFaces; f++) {
+        label += reader.signedVarint();
+        outer = readIndex(reader, outer, numHalfEdges);
+        inner = readIndex(reader, inner, numHalfEdges);
+        dcel.faceLabel[f] = static_cast<int32_t>(label);
+        dcel.faceOuter[f] = outer;
+        dcel.faceInner[f] = inner;
+    }
+    readFlags(reader, dcel.faceUnbounded);
+
+    dcel.bottomLeftBounds = Vec2(header.bottomLeftX, header.bottomLeftY);
+    dcel.topRightBounds = Vec2(header.topRightX, header.topRightY);
+    dcel.majorAxis = header.majorAxis;
+    dcel.centroid = Vec2(header.centroidX, header.centroidY);
+    dcel.consolidated = header.flags & DCEL_ARCHIVE_CONSOLIDATED;
+    return reader.position;
+}
+
+
+void saveDiagramArchive(const std::string &path, const DCEL* voronoi, const DCEL* delaunay, int coordinateBits) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) throw std::runtime_error("Cannot open file for writing: " + path);
+    bool ok;
+    try {
+        OutputBuffer out(file);
+        writeDCELArchive(out, voronoi, coordinateBits);
+        if (delaunay != nullptr) writeDCELArchive(out, delaunay, coordinateBits);
+        out.flush();
+        ok = out.good();
+    } catch (std::invalid_argument &) {
+        fclose(file);
+        throw;
+    }
+    if (fclose(file) != 0 || !ok) throw std::runtime_error("Cannot write file: " + path);
+}
+
+
+bool loadDiagramArchive(const std::string &path, DCEL &voronoi, DCEL &delaunay) {
+    MappedFile file(path);
+    const char* end = file.data() + file.size();
+    try {
+        const char* position = readDCELArchive(file.data(), end, voronoi);
+        if (position == end) return false;
+        position = readDCELArchive(position, end, delaunay);
+        if (position != end) throw std::runtime_error("Trailing data after the DCEL archive");
+    } catch (std::runtime_error &e) {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+    return true;
+}
+
+
+bool isDCELArchiveFile(const std::string &path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return false;
+    char magic[8];
+    bool matches = fread(magic, 1, sizeof(magic), in) == sizeof(magic)
+                   && memcmp(magic, DCEL_ARCHIVE_MAGIC, sizeof(magic)) == 0;
+    fclose(in);
+    return matches;
+}
+
+
+static std::vector<Vec2> archiveTestSites(int k) {
+    std::vector<Vec2> sites;
+    for (int x = 0; x < k; x++) {
+        for (int y = 0; y < k; y++) sites.emplace_back(x + (y % 2) * 0.001, y, x * k + y + 1);
+    }
+    return sites;
+}
+
+// Encodes into a temporary file, and returns its contents
+static std::string encodeArchive(const DCEL* dcel, int coordinateBits) {
+    FILE* file = tmpfile();
+    {
+        OutputBuffer out(file);
+        writeDCELArchive(out, dcel, coordinateBits);
+    }
+    std::string bytes(ftell(file), '\0');
+    rewind(file);
+    size_t numRead = fread(bytes.data(), 1, bytes.size(), file);
+    assert(numRead == bytes.size());
+    fclose(file);
+    return bytes;
+}
+
+
+void dcelArchiveTest1() {
+    std::cout << "Testing DCEL archives, case 1" << std::endl;
+
+    FortuneSweeper algo(archiveTestSites(12));
+    muteStdout();
+    DCEL* voronoi = algo.computeAll();
+    DCEL* delaunay = algo.factory->buildDualGraph();
+    unmuteStdout();
+
+    for (const DCEL* original: {voronoi, delaunay}) {
+        for (int bits: {DCEL_ARCHIVE_DEFAULT_BITS, 12}) {
+            std::string bytes = encodeArchive(original, bits);
+
+            // The header is little-endian, whatever the host
+            assert(bytes.compare(8, 4, std::string("\x01\0\0\0", 4)) == 0);
+            for (int i = 0; i < 4; i++) {
+                assert(static_cast<uint8_t>(bytes[16 + i]) == ((original->numVertices() >> (8 * i)) & 0xff));
+                assert(static_cast<uint8_t>(bytes[28 + i]) == ((bits >> (8 * i)) & 0xff));
+            }
+
+            DCEL loaded;
+            const char* end = readDCELArchive(bytes.data(), bytes.data() + bytes.size(), loaded);
+            assert(end == bytes.data() + bytes.size());
+
+            // The topology comes back exactly, and coordinates to within half a step of the grid
+            double extent = std::max(original->topRightBounds.x - original->bottomLeftBounds.x,
+                                     original->topRightBounds.y - original->bottomLeftBounds.y);
+            double tolerance = extent / static_cast<double>((uint64_t(1) << bits) - 1);
+            assert(loaded.numVertices() == original->numVertices());
+            for (int32_t v = 0; v < original->numVertices(); v++) {
+                assert(std::abs(loaded.vertexX[v] - original->vertexX[v]) <= tolerance);
+                assert(std::abs(loaded.vertexY[v] - original->vertexY[v]) <= tolerance);
+            }
+            assert(loaded.vertexLabel == original->vertexLabel);
+            assert(loaded.vertexIncidentEdge == original->vertexIncidentEdge);
+            assert(loaded.vertexIsBoundary == original->vertexIsBoundary);
+            assert(loaded.edgeOrigin == original->edgeOrigin && loaded.edgeNext == original->edgeNext);
+            assert(loaded.edgePrev == original->edgePrev && loaded.edgeFace == original->edgeFace);
+            assert(loaded.edgeUnbounded == original->edgeUnbounded);
+            assert(loaded.faceLabel == original->faceLabel && loaded.faceOuter == original->faceOuter);
+            assert(loaded.faceInner == original->faceInner && loaded.faceUnbounded == original->faceUnbounded);
+            assert(loaded.consolidated == original->consolidated);
+
+            // Cutting the record anywhere is caught
+            for (size_t length: {size_t(0), size_t(DCEL_ARCHIVE_HEADER_SIZE), bytes.size() / 2, bytes.size() - 1}) {
+                try {
+                    readDCELArchive(bytes.data(), bytes.data() + length, loaded);
+                    assert(false);
+                } catch (std::runtime_error &e) {}
+            }
+        }
+    }
+}
+
+
+void dcelArchiveBenchmark() {
+    std::cout << "Benchmarking DCEL archives against text output and recomputing" << std::endl;
+
+    std::vector<Vec2> sites = archiveTestSites(60);
+    FortuneSweeper algo(sites);
+    muteStdout();
+    auto start = std::chrono::steady_clock::now();
+    DCEL* voronoi = algo.computeAll();
+    DCEL* delaunay = algo.factory->buildDualGraph();
+    double computeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    unmuteStdout();
+
+    FILE* text = tmpfile();
+    {
+        OutputBuffer out(text);
+        voronoi->writeOutputVoronoiStyle(out);
+        delaunay->writeOutputDelaunayStyle(out);
+    }
+    long textSize = ftell(text);
+    fclose(text);
+
+    std::string path = "/tmp/voronoi-archive-benchmark.dcel";
+    start = std::chrono::steady_clock::now();
+    saveDiagramArchive(path, voronoi, delaunay);
+    double saveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    FILE* archive = fopen(path.c_str(), "rb");
+    fseek(archive, 0, SEEK_END);
+    long archiveSize = ftell(archive);
+    fclose(archive);
+
+    DCEL loadedVoronoi;
+    DCEL loadedDelaunay;
+    start = std::chrono::steady_clock::now();
+    bool hasDual = loadDiagramArchive(path, loadedVoronoi, loadedDelaunay);
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(hasDual && loadedDelaunay.numFaces() == delaunay->numFaces());
+    remove(path.c_str());
+
+    printf("    %zu sites: text %ld bytes, archive %ld bytes (%.1f%%)\n", sites.size(), textSize, archiveSize,
+           100.0 * static_cast<double>(archiveSize) / static_cast<double>(textSize));
+    printf("    compute %8.3f ms, save %8.3f ms, load %8.3f ms (%.1fx faster than computing)\n",
+           computeMs, saveMs, loadMs, computeMs / loadMs);
+}
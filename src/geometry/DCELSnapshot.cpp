@@ -0,0 +1,318 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <chrono>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "geometry/DCELSnapshot.hpp"
+#include "geometry/DCELArchive.hpp"
+#include "fortune/Fortune.hpp"
+#include "utils/OutputBuffer.hpp"
+#include "utils/ByteOrder.hpp"
+#include "benchmarks.hpp"
+
+static_assert(sizeof(DCELSnapshotHeader) == DCEL_SNAPSHOT_HEADER_SIZE, "DCEL snapshot header must be packed");
+
+// The header and arrays are written and read in place in host order, which is only the format's order on a
+// little-endian host
+static_assert(HOST_LITTLE_ENDIAN, "DCEL snapshots are only supported on little-endian hosts");
+
+
+MappedDCEL::MappedDCEL(const std::string &path) : file(path) {
+    if (file.size() < DCEL_SNAPSHOT_HEADER_SIZE) throw std::runtime_error("Truncated DCEL snapshot: " + path);
+
+    memcpy(&header, file.data(), DCEL_SNAPSHOT_HEADER_SIZE);
+    if (memcmp(header.magic, DCEL_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a DCEL snapshot: " + path);
+    }
+    if (header.version != DCEL_SNAPSHOT_VERSION) {
+        std::string version = std::to_string(header.version);
+        throw std::runtime_error("Unsupported version " + version + " of DCEL snapshot: " + path);
+    }
+    if ((header.flags & ~static_cast<uint32_t>(DCEL_SNAPSHOT_CONSOLIDATED)) != 0) {
+        throw std::runtime_error("Unknown flags in DCEL snapshot: " + path);
+    }
+    if (header.fileSize != file.size()) throw std::runtime_error("DCEL snapshot has the wrong size: " + path);
+    if (header.numVertices < 0 || header.numHalfEdges < 0 || header.numHalfEdges % 2 != 0 || header.numFaces < 0) {
+        throw std::runtime_error("Invalid record counts in DCEL snapshot: " + path);
+    }
+
+    try {
+        vertexX = reinterpret_cast<const double*>(array(header.vertexXOffset, header.numVertices, sizeof(double)));
+        vertexY = reinterpret_cast<const double*>(array(header.vertexYOffset, header.numVertices, sizeof(double)));
+        vertexLabel = reinterpret_cast<const int32_t*>(
+            array(header.vertexLabelOffset, header.numVertices, sizeof(int32_t)));
+        vertexIncidentEdge = reinterpret_cast<const int32_t*>(
+            array(header.vertexIncidentEdgeOffset, header.numVertices, sizeof(int32_t)));
+        vertexIsBoundary = reinterpret_cast<const uint8_t*>(
+            array(header.vertexIsBoundaryOffset, header.numVertices, sizeof(uint8_t)));
+
+        edgeOrigin = reinterpret_cast<const int32_t*>(
+            array(header.edgeOriginOffset, header.numHalfEdges, sizeof(int32_t)));
+        edgeNext = reinterpret_cast<const int32_t*>(array(header.edgeNextOffset, header.numHalfEdges, sizeof(int32_t)));
+        edgePrev = reinterpret_cast<const int32_t*>(array(header.edgePrevOffset, header.numHalfEdges, sizeof(int32_t)));
+        edgeFace = reinterpret_cast<const int32_t*>(array(header.edgeFaceOffset, header.numHalfEdges, sizeof(int32_t)));
+        edgeUnbounded = reinterpret_cast<const uint8_t*>(
+            array(header.edgeUnboundedOffset, header.numHalfEdges, sizeof(uint8_t)));
+
+        faceLabel = reinterpret_cast<const int32_t*>(array(header.faceLabelOffset, header.numFaces, sizeof(int32_t)));
+        faceOuter = reinterpret_cast<const int32_t*>(array(header.faceOuterOffset, header.numFaces, sizeof(int32_t)));
+        faceInner = reinterpret_cast<const int32_t*>(array(header.faceInnerOffset, header.numFaces, sizeof(int32_t)));
+        faceUnbounded = reinterpret_cast<const uint8_t*>(
+            array(header.faceUnboundedOffset, header.numFaces, sizeof(uint8_t)));
+    } catch (std::runtime_error &e) {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+
+    bottomLeftBounds = Vec2(header.bottomLeftX, header.bottomLeftY);
+    topRightBounds = Vec2(header.topRightX, header.topRightY);
+    majorAxis = header.majorAxis;
+    centroid = Vec2(header.centroidX, header.centroidY);
+    consolidated = header.flags & DCEL_SNAPSHOT_CONSOLIDATED;
+
+    // Queries jump around the arrays, so reading ahead of them would mostly be wasted
+    madvise(const_cast<char*>(file.data()), file.size(), MADV_RANDOM);
+}
+
+const char* MappedDCEL::array(uint64_t offset, int32_t count, size_t elementSize) const {
+    if (offset % DCEL_SNAPSHOT_ALIGNMENT != 0 || offset < DCEL_SNAPSHOT_HEADER_SIZE || offset > file.size()
+        || static_cast<uint64_t>(count) * elementSize > file.size() - offset) {
+        throw std::runtime_error("Array out of bounds in DCEL snapshot");
+    }
+    return file.data() + offset;
+}
+
+int MappedDCEL::numVertices() const {
+    return header.numVertices;
+}
+
+int MappedDCEL::numHalfEdges() const {
+    return header.numHalfEdges;
+}
+
+int MappedDCEL::numFaces() const {
+    return header.numFaces;
+}
+
+int32_t MappedDCEL::twin(int32_t edge) {
+    return edge ^ 1;
+}
+
+int32_t MappedDCEL::dest(int32_t edge) const {
+    return edgeOrigin[twin(edge)];
+}
+
+void MappedDCEL::copyTo(DCEL &dcel) const {
+    dcel.clear();
+    dcel.vertexX.assign(vertexX, vertexX + numVertices());
+    dcel.vertexY.assign(vertexY, vertexY + numVertices());
+    dcel.vertexLabel.assign(vertexLabel, vertexLabel + numVertices());
+    dcel.vertexIncidentEdge.assign(vertexIncidentEdge, vertexIncidentEdge + numVertices());
+    dcel.vertexIsBoundary.assign(vertexIsBoundary, vertexIsBoundary + numVertices());
+
+    dcel.edgeOrigin.assign(edgeOrigin, edgeOrigin + numHalfEdges());
+    dcel.edgeNext.assign(edgeNext, edgeNext + numHalfEdges());
+    dcel.edgePrev.assign(edgePrev, edgePrev + numHalfEdges());
+    dcel.edgeFace.assign(edgeFace, edgeFace + numHalfEdges());
+    dcel.edgeUnbounded.assign(edgeUnbounded, edgeUnbounded + numHalfEdges());
+
+    dcel.faceLabel.assign(faceLabel, faceLabel + numFaces());
+    dcel.faceOuter.assign(faceOuter, faceOuter + numFaces());
+    dcel.faceInner.assign(faceInner, faceInner + numFaces());
+    dcel.faceUnbounded.assign(faceUnbounded, faceUnbounded + numFaces());
+
+    dcel.bottomLeftBounds = bottomLeftBounds;
+    dcel.topRightBounds = topRightBounds;
+    dcel.majorAxis = majorAxis;
+    dcel.centroid = centroid;
+    dcel.consolidated = consolidated;
+}
+
+
+void writeDCELSnapshot(const std::string &path, const DCEL* dcel) {
+    DCELSnapshotHeader header {};
+    memcpy(header.magic, DCEL_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = DCEL_SNAPSHOT_VERSION;
+    if (dcel->consolidated) header.flags |= DCEL_SNAPSHOT_CONSOLIDATED;
+    header.numVertices = dcel->numVertices();
+    header.numHalfEdges = dcel->numHalfEdges();
+    header.numFaces = dcel->numFaces();
+    header.bottomLeftX = dcel->bottomLeftBounds.x;
+    header.bottomLeftY = dcel->bottomLeftBounds.y;
+    header.topRightX = dcel->topRightBounds.x;
+    header.topRightY = dcel->topRightBounds.y;
+    header.majorAxis = dcel->majorAxis;
+    header.centroidX = dcel->centroid.x;
+    header.centroidY = dcel->centroid.y;
+
+    // Lay the arrays out one after the other, each padded up to the alignment
+    struct Section {
+        uint64_t* offset;
+        const void* data;
+        size_t bytes;
+    };
+    Section sections[] = {
+        {&header.vertexXOffset, dcel->vertexX.data(), dcel->vertexX.size() * sizeof(double)},
+        {&header.vertexYOffset, dcel->vertexY.data(), dcel->vertexY.size() * sizeof(double)},
+        {&header.vertexLabelOffset, dcel->vertexLabel.data(), dcel->vertexLabel.size() * sizeof(int32_t)},
+        {&header.vertexIncidentEdgeOffset, dcel->vertexIncidentEdge.data(),
+         dcel->vertexIncidentEdge.size() * sizeof(int32_t)},
+        {&header.vertexIsBoundaryOffset, dcel->vertexIsBoundary.data(), dcel->vertexIsBoundary.size()},
+        {&header.edgeOriginOffset, dcel->edgeOrigin.data(), dcel->edgeOrigin.size() * sizeof(int32_t)},
+        {&header.edgeNextOffset, dcel->edgeNext.data(), dcel->edgeNext.size() * sizeof(int32_t)},
+        {&header.edgePrevOffset, dcel->edgePrev.data(), dcel->edgePrev.size() * sizeof(int32_t)},
+        {&header.edgeFaceOffset, dcel->edgeFace.data(), dcel->edgeFace.size() * sizeof(int32_t)},
+        {&header.edgeUnboundedOffset, dcel->edgeUnbounded.data(), dcel->edgeUnbounded.size()},
+        {&header.faceLabelOffset, dcel->faceLabel.data(), dcel->faceLabel.size() * sizeof(int32_t)},
+        {&header.faceOuterOffset, dcel->faceOuter.data(), dcel->faceOuter.size() * sizeof(int32_t)},
+        {&header.faceInnerOffset, dcel->faceInner.data(), dcel->faceInner.size() * sizeof(int32_t)},
+        {&header.faceUnboundedOffset, dcel->faceUnbounded.data(), dcel->faceUnbounded.size()},
+    };
+    uint64_t position = DCEL_SNAPSHOT_HEADER_SIZE;
+    for (Section &section: sections) {
+        *section.offset = position;
+        position += (section.bytes + DCEL_SNAPSHOT_ALIGNMENT - 1) / DCEL_SNAPSHOT_ALIGNMENT * DCEL_SNAPSHOT_ALIGNMENT;
+    }
+    header.fileSize = position;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) throw std::runtime_error("Cannot open file for writing: " + path);
+    bool ok;
+    {
+        const char padding[DCEL_SNAPSHOT_ALIGNMENT] = {};
+        OutputBuffer out(file);
+        out.put(reinterpret_cast<const char*>(&header), DCEL_SNAPSHOT_HEADER_SIZE);
+        for (Section &section: sections) {
+            out.put(static_cast<const char*>(section.data), section.bytes);
+            size_t remainder = section.bytes % DCEL_SNAPSHOT_ALIGNMENT;
+            if (remainder != 0) out.put(padding, DCEL_SNAPSHOT_ALIGNMENT - remainder);
+        }
+        out.flush();
+        ok = out.good();
+    }
+    if (fclose(file) != 0 || !ok) throw std::runtime_error("Cannot write file: " + path);
+}
+
+
+bool isDCELSnapshotFile(const std::string &path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return false;
+    char magic[8];
+    bool matches = fread(magic, 1, sizeof(magic), in) == sizeof(magic)
+                   && memcmp(magic, DCEL_SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+    fclose(in);
+    return matches;
+}
+
+
+static std::string temporaryPath() {
+    char path[] = "/tmp/voronoi-snapshot-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) throw std::runtime_error("Cannot create a temporary file");
+    close(fd);
+    return path;
+}
+
+static std::vector<Vec2> snapshotTestSites(int k) {
+    std::vector<Vec2> sites;
+    for (int x = 0; x < k; x++) {
+        for (int y = 0; y < k; y++) sites.emplace_back(x + (y % 2) * 0.001, y, x * k + y + 1);
+    }
+    return sites;
+}
+
+// Sum over the boundary cycles of every face, walked through whichever arrays the DCEL type has
+template<typename D>
+static int64_t walkFaces(const D &dcel) {
+    int64_t total = 0;
+    for (int32_t f = 0; f < dcel.numFaces(); f++) {
+        int32_t start = dcel.faceOuter[f] != DCEL_NULL_INDEX ? dcel.faceOuter[f] : dcel.faceInner[f];
+        int32_t edge = start;
+        for (int steps = 0; edge != DCEL_NULL_INDEX && steps < dcel.numHalfEdges(); steps++) {
+            total += dcel.edgeOrigin[edge] + dcel.dest(edge);
+            edge = dcel.edgeNext[edge];
+            if (edge == start) break;
+        }
+    }
+    return total;
+}
+
+
+void dcelSnapshotTest1() {
+    std::cout << "Testing DCEL snapshots, case 1" << std::endl;
+
+    FortuneSweeper algo(snapshotTestSites(12));
+    muteStdout();
+    DCEL* voronoi = algo.computeAll();
+    DCEL* delaunay = algo.factory->buildDualGraph();
+    unmuteStdout();
+
+    std::string path = temporaryPath();
+    for (const DCEL* original: {voronoi, delaunay}) {
+        writeDCELSnapshot(path, original);
+        assert(isDCELSnapshotFile(path));
+
+        // Queried in place, and copied out, the snapshot is the same as the DCEL
+        MappedDCEL mapped(path);
+        assert(mapped.numVertices() == original->numVertices() && mapped.numFaces() == original->numFaces());
+        assert(mapped.consolidated == original->consolidated);
+        assert(walkFaces(mapped) == walkFaces(*original));
+        DCEL copy;
+        mapped.copyTo(copy);
+        assert(copy.vertexX == original->vertexX && copy.vertexY == original->vertexY);
+        assert(copy.vertexLabel == original->vertexLabel && copy.vertexIsBoundary == original->vertexIsBoundary);
+        assert(copy.vertexIncidentEdge == original->vertexIncidentEdge);
+        assert(copy.edgeOrigin == original->edgeOrigin && copy.edgeNext == original->edgeNext);
+        assert(copy.edgePrev == original->edgePrev && copy.edgeFace == original->edgeFace);
+        assert(copy.edgeUnbounded == original->edgeUnbounded);
+        assert(copy.faceLabel == original->faceLabel && copy.faceOuter == original->faceOuter);
+        assert(copy.faceInner == original->faceInner && copy.faceUnbounded == original->faceUnbounded);
+        assert(copy.bottomLeftBounds.x == original->bottomLeftBounds.x);
+        assert(copy.topRightBounds.y == original->topRightBounds.y);
+    }
+
+    // Truncated files are rejected
+    truncate(path.c_str(), DCEL_SNAPSHOT_HEADER_SIZE + 8);
+    try {
+        MappedDCEL mapped(path);
+        assert(false);
+    } catch (std::runtime_error &e) {}
+    remove(path.c_str());
+}
+
+
+void dcelSnapshotBenchmark() {
+    std::cout << "Benchmarking DCEL snapshots against archives" << std::endl;
+
+    FortuneSweeper algo(snapshotTestSites(60));
+    muteStdout();
+    DCEL* voronoi = algo.computeAll();
+    unmuteStdout();
+
+    std::string snapshotPath = temporaryPath();
+    std::string archivePath = temporaryPath();
+    writeDCELSnapshot(snapshotPath, voronoi);
+    saveDiagramArchive(archivePath, voronoi, nullptr);
+    int64_t expected = walkFaces(*voronoi);
+
+    // Time from the path to the first answer, a walk over every face
+    auto start = std::chrono::steady_clock::now();
+    DCEL loaded;
+    DCEL unused;
+    loadDiagramArchive(archivePath, loaded, unused);
+    assert(walkFaces(loaded) == expected);
+    double archiveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    MappedDCEL mapped(snapshotPath);
+    double openMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(walkFaces(mapped) == expected);
+    double mappedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("    %d half-edges: archive load and walk %8.3f ms, snapshot open %8.3f ms, open and walk %8.3f ms\n",
+           voronoi->numHalfEdges(), archiveMs, openMs, mappedMs);
+
+    remove(snapshotPath.c_str());
+    remove(archivePath.c_str());
+}
@@ -0,0 +1,650 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include "geometry/GeometryWriters.hpp"
+#include "geometry/DCELArchive.hpp"
+#include "geometry/DCELSnapshot.hpp"
+#include "fortune/Fortune.hpp"
+#include "benchmarks.hpp"
+
+#define WKB_LITTLE_ENDIAN 1
+#define WKB_POLYGON 3
+#define WKB_MULTIPOLYGON 6
+
+// WKB says which byte order it's in, so the bytes are laid out by hand rather than in the order of the host
+static void putWKBUint32(OutputBuffer &out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; i++) bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    out.put(bytes, 4);
+}
+
+static void putWKBDouble(OutputBuffer &out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    char bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xff);
+    out.put(bytes, 8);
+}
+
+// Triangles of a fan over each bounded face, as fn(a, b, c)
+template<typename Fn>
+static void forEachMeshTriangle(const DCEL* dcel, Fn fn) {
+    FaceRings rings(dcel);
+    for (int32_t f = 0; f < dcel->numFaces(); f++) {
+        if (dcel->faceUnbounded[f]) continue;
+        int32_t first = DCEL_NULL_INDEX;
+        int32_t previous = DCEL_NULL_INDEX;
+        rings.forEachVertex(f, [&](int32_t vertex) {
+            if (first == DCEL_NULL_INDEX) first = vertex;
+            else if (previous != DCEL_NULL_INDEX) fn(first, previous, vertex);
+            if (vertex != first) previous = vertex;
+        });
+    }
+}
+
+
+void writeCellsGeoJSON(OutputBuffer &out, const DCEL* voronoi) {
+    FaceRings rings(voronoi);
+    out.put("{\"type\":\"FeatureCollection\",\"features\":[");
+    for (int32_t f = 0; f < voronoi->numFaces(); f++) {
+        if (f > 0) out.put(',');
+        out.put("\n{\"type\":\"Feature\",\"properties\":{\"site\":");
+        out.putInt(voronoi->faceLabel[f]);
+        out.put("},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[");
+
+        // A ring needs at least three distinct positions, and ends where it starts
+        if (rings.ringSize(f) >= 3) {
+            int32_t first = DCEL_NULL_INDEX;
+            out.put('[');
+            rings.forEachVertex(f, [&](int32_t vertex) {
+                if (first == DCEL_NULL_INDEX) first = vertex;
+                out.put('[');
+                out.putShortest(voronoi->vertexX[vertex]);
+                out.put(',');
+                out.putShortest(voronoi->vertexY[vertex]);
+                out.put("],", 2);
+            });
+            out.put('[');
+            out.putShortest(voronoi->vertexX[first]);
+            out.put(',');
+            out.putShortest(voronoi->vertexY[first]);
+            out.put("]]", 2);
+        }
+        out.put("]}}");
+    }
+    out.put("\n]}\n");
+}
+
+
+void writeCellsWKB(OutputBuffer &out, const DCEL* voronoi) {
+    FaceRings rings(voronoi);
+    out.put(static_cast<char>(WKB_LITTLE_ENDIAN));
+    putWKBUint32(out, WKB_MULTIPOLYGON);
+    putWKBUint32(out, voronoi->numFaces());
+    for (int32_t f = 0; f < voronoi->numFaces(); f++) {
+        int32_t size = rings.ringSize(f);
+        out.put(static_cast<char>(WKB_LITTLE_ENDIAN));
+        putWKBUint32(out, WKB_POLYGON);
+        if (size < 3) {
+            putWKBUint32(out, 0);
+            continue;
+        }
+
+        int32_t first = DCEL_NULL_INDEX;
+        putWKBUint32(out, 1);
+        putWKBUint32(out, size + 1);
+        rings.forEachVertex(f, [&](int32_t vertex) {
+            if (first == DCEL_NULL_INDEX) first = vertex;
+            putWKBDouble(out, voronoi->vertexX[vertex]);
+            putWKBDouble(out, voronoi->vertexY[vertex]);
+        });
+        putWKBDouble(out, voronoi->vertexX[first]);
+        putWKBDouble(out, voronoi->vertexY[first]);
+    }
+}
+
+
+void writeDiagramSVG(OutputBuffer &out, const std::vector<Vec2> &sites, const DCEL* voronoi) {
+    // SVG has y pointing down, so every y is negated
+    double width = voronoi->topRightBounds.x - voronoi->bottomLeftBounds.x;
+    double height = voronoi->topRightBounds.y - voronoi->bottomLeftBounds.y;
+    double stroke = std::max(width, height) / 1000;
+
+    out.put("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+    out.putShortest(voronoi->bottomLeftBounds.x);
+    out.put(' ');
+    out.putShortest(-voronoi->topRightBounds.y);
+    out.put(' ');
+    out.putShortest(width);
+    out.put(' ');
+    out.putShortest(height);
+    out.put("\">\n<g fill=\"none\" stroke=\"#b33\" stroke-linejoin=\"round\" stroke-width=\"");
+    out.putShortest(stroke);
+    out.put("\">\n");
+
+    FaceRings rings(voronoi);
+    for (int32_t f = 0; f < voronoi->numFaces(); f++) {
+        if (rings.ringSize(f) < 3) continue;
+        char command = 'M';
+        out.put("<path d=\"");
+        rings.forEachVertex(f, [&](int32_t vertex) {
+            out.put(command);
+            out.putShortest(voronoi->vertexX[vertex]);
+            out.put(' ');
+            out.putShortest(-voronoi->vertexY[vertex]);
+            command = 'L';
+        });
+        out.put("Z\"/>\n");
+    }
+
+    out.put("</g>\n<g fill=\"#000\">\n");
+    for (const Vec2 &site: sites) {
+        out.put("<circle cx=\"");
+        out.putShortest(site.x);
+        out.put("\" cy=\"");
+        out.putShortest(-site.y);
+        out.put("\" r=\"");
+        out.putShortest(3 * stroke);
+        out.put("\"/>\n");
+    }
+    out.put("</g>\n</svg>\n");
+}
+
+
+void writeMeshOFF(OutputBuffer &out, const DCEL* delaunay) {
+    int64_t numTriangles = 0;
+    forEachMeshTriangle(delaunay, [&](int32_t, int32_t, int32_t) { numTriangles++; });
+
+    out.put("OFF\n");
+    out.putInt(delaunay->numVertices());
+    out.put(' ');
+    out.putInt(numTriangles);
+    out.put(" 0\n");
+    for (int32_t v = 0; v < delaunay->numVertices(); v++) {
+        out.putShortest(delaunay->vertexX[v]);
+        out.put(' ');
+        out.putShortest(delaunay->vertexY[v]);
+        out.put(" 0\n");
+    }
+    forEachMeshTriangle(delaunay, [&](int32_t a, int32_t b, int32_t c) {
+        out.put("3 ", 2);
+        out.putInt(a);
+        out.put(' ');
+        out.putInt(b);
+        out.put(' ');
+        out.putInt(c);
+        out.put('\n');
+    });
+}
+
+
+void writeMeshPLY(OutputBuffer &out, const DCEL* delaunay) {
+    int64_t numTriangles = 0;
+    forEachMeshTriangle(delaunay, [&](int32_t, int32_t, int32_t) { numTriangles++; });
+
+    out.put("ply\nformat ascii 1.0\nelement vertex ");
+    out.putInt(delaunay->numVertices());
+    out.put("\nproperty double x\nproperty double y\nproperty double z\nelement face ");
+    out.putInt(numTriangles);
+    out.put("\nproperty list uchar int vertex_indices\nend_header\n");
+    for (int32_t v = 0; v < delaunay->numVertices(); v++) {
+        out.putShortest(delaunay->vertexX[v]);
+        out.put(' ');
+        out.putShortest(delaunay->vertexY[v]);
+        out.put(" 0\n");
+    }
+    forEachMeshTriangle(delaunay, [&](int32_t a, int32_t b, int32_t c) {
+        out.put("3 ", 2);
+        out.putInt(a);
+        out.put(' ');
+        out.putInt(b);
+        out.put(' ');
+        out.putInt(c);
+        out.put('\n');
+    });
+}
+
+
+void writeEdgesCSV(OutputBuffer &out, const DCEL* dcel) {
+    out.put("origin,dest,x1,y1,x2,y2,left_site,right_site\n");
+
+    // Twins are adjacent, so every even half-edge stands for one edge
+    for (int32_t edge = 0; edge < dcel->numHalfEdges(); edge += 2) {
+        int32_t origin = dcel->edgeOrigin[edge];
+        int32_t dest = dcel->dest(edge);
+        dcel->putVertexName(out, origin);
+        out.put(',');
+        dcel->putVertexName(out, dest);
+        out.put(',');
+        out.putShortest(dcel->vertexX[origin]);
+        out.put(',');
+        out.putShortest(dcel->vertexY[origin]);
+        out.put(',');
+        out.putShortest(dcel->vertexX[dest]);
+        out.put(',');
+        out.putShortest(dcel->vertexY[dest]);
+        for (int32_t halfEdge: {edge, DCEL::twin(edge)}) {
+            out.put(',');
+            if (dcel->edgeFace[halfEdge] != DCEL_NULL_INDEX) out.putInt(dcel->faceLabel[dcel->edgeFace[halfEdge]]);
+        }
+        out.put('\n');
+    }
+}
+
+
+static bool hasExtension(const std::string &path, const char* extension) {
+    size_t length = strlen(extension);
+    return path.size() >= length && path.compare(path.size() - length, length, extension) == 0;
+}
+
+void exportDiagram(
+    const std::string &path,
+    const std::vector<Vec2> &sites,
+    const DCEL* voronoi,
+    const DCEL* delaunay
+) {
+    if (hasExtension(path, ".dcel")) {
+        saveDiagramArchive(path, voronoi, delaunay);
+        return;
+    }
+    if (hasExtension(path, ".dcelm")) {
+        writeDCELSnapshot(path, voronoi);
+        return;
+    }
+
+    void (*writeMesh)(OutputBuffer &, const DCEL*) = nullptr;
+    void (*writeDiagram)(OutputBuffer &, const DCEL*) = nullptr;
+    bool svg = hasExtension(path, ".svg");
+    if (hasExtension(path, ".geojson")) writeDiagram = writeCellsGeoJSON;
+    else if (hasExtension(path, ".wkb")) writeDiagram = writeCellsWKB;
+    else if (hasExtension(path, ".csv")) writeDiagram = writeEdgesCSV;
+    else if (hasExtension(path, ".off")) writeMesh = writeMeshOFF;
+    else if (hasExtension(path, ".ply")) writeMesh = writeMeshPLY;
+    else if (!svg) throw std::runtime_error("Unknown export format: " + path);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) throw std::runtime_error("Cannot open file for writing: " + path);
+    bool ok;
+    {
+        OutputBuffer out(file);
+        if (svg) writeDiagramSVG(out, sites, voronoi);
+        else if (writeDiagram != nullptr) writeDiagram(out, voronoi);
+        else writeMesh(out, delaunay);
+        out.flush();
+        ok = out.good();
+    }
+    if (fclose(file) != 0 || !ok) throw std::runtime_error("Cannot write file: " + path);
+}
+
+
+static std::string readWholeFile(FILE* file) {
+    std::string contents(ftell(file), '\0');
+    rewind(file);
+    size_t read = fread(contents.data(), 1, contents.size(), file);
+    contents.resize(read);
+    return contents;
+}
+
+void geometryWritersTest1() {
+    std::cout << "Testing geometry writers, case 1" << std::endl;
+
+    // A lattice, so that every Delaunay face is a square of four cocircular sites
+    std::vector<Vec2> sites;
+    for (int x = 0; x < 6; x++) {
+        for (int y = 0; y < 6; y++) sites.emplace_back(x, y, x * 6 + y + 1);
+    }
+    FortuneSweeper algo(sites);
+    muteStdout();
+    DCEL* voronoi = algo.computeAll();
+    DCEL* delaunay = algo.factory->buildDualGraph();
+    unmuteStdout();
+
+    // The WKB cells tile the bounding box
+    FILE* file = tmpfile();
+    {
+        OutputBuffer out(file);
+        writeCellsWKB(out, voronoi);
+    }
+    std::string wkb(ftell(file), '\0');
+    rewind(file);
+    size_t numRead = fread(wkb.data(), 1, wkb.size(), file);
+    assert(numRead == wkb.size());
+    fclose(file);
+
+    // Read back as little-endian whatever the host is
+    size_t p = 0;
+    auto readUint64 = [&](int numBytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < numBytes; i++) value |= uint64_t(static_cast<uint8_t>(wkb[p + i])) << (8 * i);
+        p += numBytes;
+        return value;
+    };
+    auto readUint32 = [&]() {
+        return static_cast<uint32_t>(readUint64(4));
+    };
+    auto readDouble = [&]() {
+        uint64_t bits = readUint64(8);
+        double value;
+        memcpy(&value, &bits, 8);
+        return value;
+    };
+    auto readHeader = [&](uint32_t type) {
+        bool littleEndian = wkb[p++] == WKB_LITTLE_ENDIAN;
+        uint32_t readType = readUint32();
+        assert(littleEndian && readType == type);
+    };
+    readHeader(WKB_MULTIPOLYGON);
+    uint32_t numPolygons = readUint32();
+    assert(static_cast<int>(numPolygons) == voronoi->numFaces());
+    double totalArea = 0;
+    for (int f = 0; f < voronoi->numFaces(); f++) {
+        readHeader(WKB_POLYGON);
+        uint32_t numRings = readUint32();
+        assert(numRings == 1);
+        uint32_t size = readUint32();
+        double firstX = readDouble();
+        double firstY = readDouble();
+        double previousX = firstX;
+        double previousY = firstY;
+        double doubleArea = 0;
+        for (uint32_t i = 1; i < size; i++) {
+            double x = readDouble();
+            double y = readDouble();
+            doubleArea += previousX * y - x * previousY;
+            previousX = x;
+            previousY = y;
+        }
+        assert(previousX == firstX && previousY == firstY && doubleArea > 0);
+        totalArea += doubleArea / 2;
+    }
+    assert(p == wkb.size());
+    double boxArea = (voronoi->topRightBounds.x - voronoi->bottomLeftBounds.x)
+                     * (voronoi->topRightBounds.y - voronoi->bottomLeftBounds.y);
+    assert(std::abs(totalArea - boxArea) < 1e-9 * boxArea);
+
+    // The fans of the Delaunay faces cover the convex hull of the lattice, once
+    file = tmpfile();
+    {
+        OutputBuffer out(file);
+        writeMeshOFF(out, delaunay);
+    }
+    rewind(file);
+    int numVertices;
+    int numTriangles;
+    assert(fscanf(file, "OFF %d %d 0", &numVertices, &numTriangles) == 2);
+    assert(numVertices == 36 && numTriangles == 50);
+    std::vector<double> xs(numVertices);
+    std::vector<double> ys(numVertices);
+    for (int v = 0; v < numVertices; v++) assert(fscanf(file, "%lf %lf 0", &xs[v], &ys[v]) == 2);
+    double meshArea = 0;
+    for (int t = 0; t < numTriangles; t++) {
+        int a;
+        int b;
+        int c;
+        assert(fscanf(file, " 3 %d %d %d", &a, &b, &c) == 3);
+        double doubleArea = (xs[b] - xs[a]) * (ys[c] - ys[a]) - (xs[c] - xs[a]) * (ys[b] - ys[a]);
+        assert(doubleArea > 0);
+        meshArea += doubleArea / 2;
+    }
+    fclose(file);
+    assert(std::abs(meshArea - 25) < 1e-9);
+}
+
+void geometryWritersTest2() {
+    std::cout << "Testing geometry writers, case 2" << std::endl;
+
+    std::vector<Vec2> sites;
+    for (int x = 0; x < 6; x++) {
+        for (int y = 0; y < 6; y++) sites.emplace_back(x, y, x * 6 + y + 1);
+    }
+    FortuneSweeper algo(sites);
+    muteStdout();
+    DCEL* voronoi = algo.computeAll();
+    DCEL* delaunay = algo.factory->buildDualGraph();
+    unmuteStdout();
+    auto written = [](auto write) {
+        FILE* file = tmpfile();
+        {
+            OutputBuffer out(file);
+            write(out);
+        }
+        std::string contents = readWholeFile(file);
+        fclose(file);
+        return contents;
+    };
+
+    // The GeoJSON cells are closed counterclockwise rings, one per site, that tile the bounding box
+    std::string geojson = written([&](OutputBuffer &out) { writeCellsGeoJSON(out, voronoi); });
+    const char* c = geojson.c_str();
+    auto expect = [&](const char* text) {
+        assert(strncmp(c, text, strlen(text)) == 0);
+        c += strlen(text);
+    };
+    expect("{\"type\":\"FeatureCollection\",\"features\":[");
+    std::vector<bool> seen(sites.size() + 1, false);
+    double totalArea = 0;
+    for (int32_t f = 0; f < voronoi->numFaces(); f++) {
+        if (f > 0) expect(",");
+        expect("\n{\"type\":\"Feature\",\"properties\":{\"site\":");
+        char* end;
+        long site = strtol(c, &end, 10);
+        c = end;
+        assert(site >= 1 && site <= static_cast<long>(sites.size()) && !seen[site]);
+        seen[site] = true;
+        expect("},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[");
+        std::vector<double> xs;
+        std::vector<double> ys;
+        while (true) {
+            expect("[");
+            xs.push_back(strtod(c, &end));
+            c = end;
+            expect(",");
+            ys.push_back(strtod(c, &end));
+            c = end;
+            expect("]");
+            if (*c != ',') break;
+            c++;
+        }
+        expect("]]}}");
+        assert(xs.size() >= 4 && xs.front() == xs.back() && ys.front() == ys.back());
+        double doubleArea = 0;
+        for (size_t i = 1; i < xs.size(); i++) doubleArea += xs[i - 1] * ys[i] - xs[i] * ys[i - 1];
+        assert(doubleArea > 0);
+        totalArea += doubleArea / 2;
+    }
+    expect("\n]}\n");
+    assert(*c == '\0' && voronoi->numFaces() == static_cast<int32_t>(sites.size()));
+    double boxArea = (voronoi->topRightBounds.x - voronoi->bottomLeftBounds.x)
+                     * (voronoi->topRightBounds.y - voronoi->bottomLeftBounds.y);
+    assert(std::abs(totalArea - boxArea) < 1e-9 * boxArea);
+
+    // The PLY mesh has the vertices and triangles of the OFF one, line for line
+    std::string off = written([&](OutputBuffer &out) { writeMeshOFF(out, delaunay); });
+    std::string ply = written([&](OutputBuffer &out) { writeMeshPLY(out, delaunay); });
+    int offVertices;
+    int offTriangles;
+    assert(sscanf(off.c_str(), "OFF %d %d 0", &offVertices, &offTriangles) == 2);
+    int plyVertices;
+    int plyFaces;
+    assert(sscanf(ply.c_str(), "ply\nformat ascii 1.0\nelement vertex %d", &plyVertices) == 1);
+    size_t faceElement = ply.find("element face ");
+    assert(faceElement != std::string::npos && sscanf(ply.c_str() + faceElement, "element face %d", &plyFaces) == 1);
+    assert(plyVertices == offVertices && plyFaces == offTriangles && plyFaces == 50);
+    size_t plyBody = ply.find("end_header\n");
+    assert(plyBody != std::string::npos);
+    assert(ply.compare(plyBody + 11, std::string::npos, off, off.find('\n', 4) + 1, std::string::npos) == 0);
+
+    // One CSV row per edge, with the coordinates of its ends, and the site on either side of it, and each site next
+    // to at least one edge
+    std::string csv = written([&](OutputBuffer &out) { writeEdgesCSV(out, voronoi); });
+    c = csv.c_str();
+    expect("origin,dest,x1,y1,x2,y2,left_site,right_site\n");
+    std::fill(seen.begin(), seen.end(), false);
+    for (int32_t edge = 0; edge < voronoi->numHalfEdges(); edge += 2) {
+        for (int name = 0; name < 2; name++) {
+            c = strchr(c, ',');
+            assert(c != nullptr);
+            c++;
+        }
+        char* end;
+        for (int32_t vertex: {voronoi->edgeOrigin[edge], voronoi->dest(edge)}) {
+            assert(strtod(c, &end) == voronoi->vertexX[vertex] && *end == ',');
+            c = end + 1;
+            assert(strtod(c, &end) == voronoi->vertexY[vertex] && *end == ',');
+            c = end + 1;
+        }
+        int numFaces = 0;
+        for (int32_t halfEdge: {edge, DCEL::twin(edge)}) {
+            int32_t face = voronoi->edgeFace[halfEdge];
+            if (face != DCEL_NULL_INDEX) {
+                long site = strtol(c, &end, 10);
+                assert(end != c && site == voronoi->faceLabel[face]);
+                c = end;
+                seen[site] = true;
+                numFaces++;
+            }
+            assert(*c == (halfEdge == edge ? ',' : '\n'));
+            c++;
+        }
+        assert(numFaces > 0);
+    }
+    assert(*c == '\0');
+    for (size_t site = 1; site <= sites.size(); site++) assert(seen[site]);
+
+    // The SVG has a path per cell and a circle per site
+    std::string svg = written([&](OutputBuffer &out) { writeDiagramSVG(out, sites, voronoi); });
+    auto count = [&](const char* text) {
+        size_t n = 0;
+        for (size_t at = svg.find(text); at != std::string::npos; at = svg.find(text, at + 1)) n++;
+        return n;
+    };
+    assert(svg.compare(0, 4, "<svg") == 0 && svg.compare(svg.size() - 7, 7, "</svg>\n") == 0);
+    assert(count("<path d=\"M") == sites.size() && count("Z\"/>") == sites.size());
+    assert(count("<circle ") == sites.size());
+}
+
+
+// The element-wise printf output that the writers replaced, kept as the reference for their format
+static void printfOutputReference(const DCEL* dcel, FILE* out, bool delaunayStyle) {
+    fprintf(out, "\n");
+    for (VertexRef v: dcel->vertices()) {
+        std::string incident = v.incidentEdge().isNull() ? "nil" : v.incidentEdge().toString();
+        const char* pos = v.pos().toString();
+        if (delaunayStyle) fprintf(out, "p%d %s %s\n", v.label(), pos, incident.c_str());
+        else fprintf(out, "%s %s %s\n", v.toString().c_str(), pos, incident.c_str());
+    }
+
+    fprintf(out, "\n");
+    for (FaceRef f: dcel->faces()) {
+        std::string outer = f.outer().isNull() ? "nil" : f.outer().toString();
+        std::string inner = f.inner().isNull() ? "nil" : f.inner().toString();
+        if (!delaunayStyle) {
+            fprintf(out, "c%d %s%s %s%s\n", f.label(), f.outer().isNull() ? "" : "e", outer.c_str(),
+                    f.inner().isNull() ? "" : "e", inner.c_str());
+        } else if (f.unbounded()) {
+            fprintf(out, "uf %s %s\n", outer.c_str(), inner.c_str());
+        } else {
+            fprintf(out, "t%d %s %s\n", f.label(), outer.c_str(), inner.c_str());
+        }
+    }
+
+    fprintf(out, "\n");
+    for (HalfEdgeRef e: dcel->halfEdges()) {
+        FaceRef face = e.incidentFace();
+        std::string next = e.next().isNull() ? "nil" : e.next().toString();
+        std::string prev = e.prev().isNull() ? "nil" : e.prev().toString();
+        if (delaunayStyle) {
+            std::string faceName = face.isNull() ? "nil" : "t" + std::to_string(face.label());
+            if (!face.isNull() && face.unbounded()) faceName = "uf";
+            fprintf(out, "d%s p%d d%s %s d%s d%s\n", e.toString().c_str(), e.origin().label(),
+                    e.twin().toString().c_str(), faceName.c_str(), next.c_str(), prev.c_str());
+        } else {
+            fprintf(out, "e%s %s e%s %s e%s e%s\n", e.toString().c_str(), e.origin().toString().c_str(),
+                    e.twin().toString().c_str(), face.isNull() ? "nil" : face.toString().c_str(), next.c_str(),
+                    prev.c_str());
+        }
+    }
+}
+
+// Sites on a k by k lattice, with every other row shifted by a hair so that the diagram has both cocircular and
+// general-position vertices
+static std::vector<Vec2> outputTestSites(int k) {
+    std::vector<Vec2> sites;
+    for (int x = 0; x < k; x++) {
+        for (int y = 0; y < k; y++) sites.emplace_back(x + (y % 2) * 0.001, y, x * k + y + 1);
+    }
+    return sites;
+}
+
+
+void dcelOutputTest1() {
+    std::cout << "Testing DCEL output writers, case 1" << std::endl;
+
+    for (int k: {2, 3, 12}) {
+        FortuneSweeper algo(outputTestSites(k));
+        muteStdout();
+        DCEL* voronoi = algo.computeAll();
+        DCEL* delaunay = algo.factory->buildDualGraph();
+        unmuteStdout();
+
+        for (int style = 0; style < 2; style++) {
+            const DCEL* dcel = style == 0 ? voronoi : delaunay;
+            FILE* ours = tmpfile();
+            FILE* reference = tmpfile();
+            {
+                OutputBuffer out(ours);
+                if (style == 0) dcel->writeOutputVoronoiStyle(out);
+                else dcel->writeOutputDelaunayStyle(out);
+            }
+            printfOutputReference(dcel, reference, style == 1);
+            assert(readWholeFile(ours) == readWholeFile(reference));
+            fclose(ours);
+            fclose(reference);
+        }
+    }
+}
+
+
+void dcelOutputBenchmark() {
+    std::cout << "Benchmarking DCEL output writers" << std::endl;
+
+    FortuneSweeper algo(outputTestSites(60));
+    muteStdout();
+    DCEL* voronoi = algo.computeAll();
+    DCEL* delaunay = algo.factory->buildDualGraph();
+    unmuteStdout();
+
+    const int rounds = 10;
+    FILE* sink = fopen("/dev/null", "w");
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        printfOutputReference(voronoi, sink, false);
+        printfOutputReference(delaunay, sink, true);
+    }
+    double printfMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Count the bytes once, through a file
+    FILE* counter = tmpfile();
+    {
+        OutputBuffer out(counter);
+        voronoi->writeOutputVoronoiStyle(out);
+        delaunay->writeOutputDelaunayStyle(out);
+    }
+    double megabytes = static_cast<double>(ftell(counter)) * rounds / (1 << 20);
+    fclose(counter);
+
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        OutputBuffer out(sink);
+        voronoi->writeOutputVoronoiStyle(out);
+        delaunay->writeOutputDelaunayStyle(out);
+    }
+    double bufferedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fclose(sink);
+
+    printf("    %d half-edges, %.1f MB: printf %8.3f ms (%6.1f MB/s), buffered to_chars %8.3f ms (%6.1f MB/s)\n",
+           voronoi->numHalfEdges() + delaunay->numHalfEdges(), megabytes, printfMs, megabytes / printfMs * 1000,
+           bufferedMs, megabytes / bufferedMs * 1000);
+}
@@ -7,6 +7,7 @@
 void VertexPair::offerVertex(Vertex* vertex) {
     if (v1 == nullptr) this->v1 = vertex;
     else if (v2 == nullptr) this->v2 = vertex;
+    else if (vertex == v1 || vertex == v2) return;
     else {
         // Third vertex is offered, check if we want to extend the segment
         Vec2 dir12 = v2->pos - v1->pos;
@@ -45,39 +46,3 @@ void VertexPair::offerVertex(Vertex* vertex) {
 
     }
 }
-
-const char* HalfEdge::toString() const {
-    char* result = new char[64];
-    sprintf(
-        result, "%s%d,%s%d",
-        (origin->isBoundary ? "b" : ""), origin->label,
-        (dest->isBoundary ? "b" : ""), dest->label
-    );
-
-    return result;
-}
-
-HalfEdge* HalfEdge::generateTwin() const {
-    auto* result = new HalfEdge(dest, origin);  // NOLINT
-    return result;
-}
-
-void HalfEdge::bindTwins(HalfEdge* other) {
-    this->twin = other;
-    other->twin = this;
-}
-
-void HalfEdge::chainNext(HalfEdge* other) {
-    this->next = other;
-    other->prev = this;
-}
-
-void HalfEdge::chainPrev(HalfEdge* other) {
-    this->prev = other;
-    other->next = this;
-}
-
-HalfEdge::HalfEdge(Vertex* origin, Vertex* dest) : origin(origin), dest(dest) {
-    if (origin != nullptr && dest != nullptr) angle = atan2(dest->y() - origin->y(), dest->x() - origin->x());
-    else angle = QUIET_NAN;
-}
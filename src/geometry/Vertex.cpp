@@ -11,9 +11,3 @@ double Vertex::y() const {
 std::string Vertex::toString() const {
     return (isBoundary ? 'b' : 'v') + std::to_string(label);
 }
-
-Vertex* Vertex::boundary(Vec2 v, int label) {
-    auto* result = new Vertex(label, v);
-    result->isBoundary = true;
-    return result;
-}
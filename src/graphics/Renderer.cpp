@@ -66,11 +66,11 @@ void Renderer::initVertexObjects(DCEL* geometry) {
 
     // Initialize vertex points data
 
-    for (auto &e: this->dcel->halfEdges) {
-        pointVertices.push_back(float(dcel->getCenteredX(e->origin->pos.x)));
-        pointVertices.push_back(float(dcel->getCenteredY(e->origin->pos.y)));
-        pointVertices.push_back(float(dcel->getCenteredX(e->dest->pos.x)));
-        pointVertices.push_back(float(dcel->getCenteredY(e->dest->pos.y)));
+    for (HalfEdgeRef e: this->dcel->halfEdges()) {
+        pointVertices.push_back(float(dcel->getCenteredX(e.origin().pos().x)));
+        pointVertices.push_back(float(dcel->getCenteredY(e.origin().pos().y)));
+        pointVertices.push_back(float(dcel->getCenteredX(e.dest().pos().x)));
+        pointVertices.push_back(float(dcel->getCenteredY(e.dest().pos().y)));
     }
 
     glGenVertexArrays(1, &pointsVAO);
@@ -90,11 +90,11 @@ void Renderer::initVertexObjects(DCEL* geometry) {
     glBindVertexArray(0);
 
     // Initialize outer data
-    for (auto &e: geometry->halfEdges) {
-        edgeEndpoints.push_back(float(dcel->getCenteredX(e->origin->pos.x)));
-        edgeEndpoints.push_back(float(dcel->getCenteredY(e->origin->pos.y)));
-        edgeEndpoints.push_back(float(dcel->getCenteredX(e->dest->pos.x)));
-        edgeEndpoints.push_back(float(dcel->getCenteredY(e->dest->pos.y)));
+    for (HalfEdgeRef e: geometry->halfEdges()) {
+        edgeEndpoints.push_back(float(dcel->getCenteredX(e.origin().pos().x)));
+        edgeEndpoints.push_back(float(dcel->getCenteredY(e.origin().pos().y)));
+        edgeEndpoints.push_back(float(dcel->getCenteredX(e.dest().pos().x)));
+        edgeEndpoints.push_back(float(dcel->getCenteredY(e.dest().pos().y)));
     }
 
     glGenVertexArrays(1, &VAO);
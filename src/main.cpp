@@ -2,9 +2,15 @@
 #include <vector>
 #include <fstream>
 #include "tests.hpp"
+#include "benchmarks.hpp"
 #include "utils/math/Vec2.hpp"
 #include "fortune/Fortune.hpp"
+#include "fortune/SweepTrace.hpp"
 #include "utils/files.hpp"
+#include "utils/SiteBinary.hpp"
+#include "utils/Npy.hpp"
+#include "utils/OutputBuffer.hpp"
+#include "geometry/GeometryWriters.hpp"
 #include "graphics/Renderer.hpp"
 
 int main(int argc, char* argv[]) {
@@ -14,7 +20,21 @@ int main(int argc, char* argv[]) {
     [[maybe_unused]] bool delaunay = false;
     [[maybe_unused]] bool voronoi = false;
     std::vector<Vec2> sites;
+    MappedSites* mappedSites = nullptr;
 
+    // Conversion of a text site file to the binary format, instead of a diagram
+    const char* convertFrom = nullptr;
+    const char* convertTo = nullptr;
+    bool singlePrecision = false;
+
+    // Where to write the arrays of the diagram for NumPy, if anywhere
+    const char* outputPath = nullptr;
+
+    // Files to export the diagram to, in the format given by each extension
+    std::vector<const char*> exportPaths;
+
+    // Where to record the events of the sweep, if anywhere
+    const char* tracePath = nullptr;
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -24,80 +44,192 @@ int main(int argc, char* argv[]) {
             delaunay = true;
         } else if (strcmp(argv[i], "--voronoi") == 0) {
             voronoi = true;
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            runAllBenchmarks();
+            return 0;
+        } else if (strcmp(argv[i], "--convert") == 0) {
+            if (i + 2 >= argc) {
+                std::cerr << "ERROR: Usage: --convert <text sites> <binary sites> [--float32]" << std::endl;
+                exit(1);
+            }
+            convertFrom = argv[++i];
+            convertTo = argv[++i];
+        } else if (strcmp(argv[i], "--float32") == 0) {
+            singlePrecision = true;
+        } else if (strcmp(argv[i], "--output") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "ERROR: Usage: --output <diagram.npz>" << std::endl;
+                exit(1);
+            }
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--export") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "ERROR: Usage: --export <file.geojson|.wkb|.svg|.csv|.off|.ply|.dcel|.dcelm>" << std::endl;
+                exit(1);
+            }
+            exportPaths.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "ERROR: Usage: --trace <sweep.trace>" << std::endl;
+                exit(1);
+            }
+            tracePath = argv[++i];
         } else {
             // Assume it's a file path
-            sites = parseSites(argv[i]);
-            if (sites.empty()) {
+            try {
+                delete mappedSites;
+                mappedSites = nullptr;
+                sites.clear();
+                if (isSiteBinaryFile(argv[i])) {
+                    mappedSites = new MappedSites(argv[i]);
+                } else if (isNumpyFile(argv[i])) {
+                    sites = readSitesNumpy(argv[i]);
+                } else {
+                    sites = parseSites(argv[i]);
+                }
+            } catch (std::runtime_error &e) {
+                std::cerr << "ERROR: Cannot parse input file " << argv[i] << ": " << e.what() << std::endl;
+                exit(1);
+            }
+            if (sites.empty() && (mappedSites == nullptr || mappedSites->size() == 0)) {
                 std::cerr << "ERROR: Provided file " << argv[i] << " has no parsed data" << std::endl;
                 exit(1);
             }
         }
     }
 
-    // Initialize the algorithm
-    for (auto v: sites) {
-        std::cout << v.toString() << std::endl;
+    if (convertFrom != nullptr) {
+        try {
+            int numSites = convertSitesToBinary(convertFrom, convertTo, singlePrecision);
+            printf("Wrote %d sites to %s\n", numSites, convertTo);
+        } catch (std::runtime_error &e) {
+            std::cerr << "ERROR: Cannot convert " << convertFrom << ": " << e.what() << std::endl;
+            exit(1);
+        }
+        return 0;
+    }
+
+    // Initialize the algorithm. Binary input is copied into the sweeper from the mapping, without a parse.
+    FortuneSweeper algo;
+    try {
+        if (mappedSites != nullptr) algo.reset(*mappedSites);
+        else algo.reset(sites);
+    } catch (std::invalid_argument &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        exit(1);
+    }
+    delete mappedSites;
+
+    {
+        OutputBuffer out(stdout);
+        for (const Vec2 &v: algo.sites) {
+            out.putPoint(v.x, v.y);
+            out.put('\n');
+        }
+    }
+
+    // Pick an execution strategy from the shape of the input
+    InputProfile profile = profileInput(algo.sites);
+    SweepPlan plan = planSweep(profile);
+    printSweepPlan(profile, plan);
+    if (profile.coincidentSite >= 0) {
+        std::cerr << "ERROR: Sites " << algo.sites[profile.coincidentSite].identifier << " and "
+                  << algo.sites[profile.coincidentWith].identifier << " coincide" << std::endl;
+        exit(1);
+    }
+
+    // The animation replays the sweep from sweep.trace
+    if (animate && tracePath == nullptr) tracePath = "sweep.trace";
+    SweepTraceWriter* trace = nullptr;
+    if (tracePath != nullptr) {
+        try {
+            trace = new SweepTraceWriter(tracePath);
+        } catch (std::runtime_error &e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            exit(1);
+        }
+        algo.setTrace(trace);
     }
 
     // Start the algorithm
-    FortuneSweeper algo(sites);
-    DCEL* dcel = algo.computeAll();
+    algo.setPlan(plan);
+    DCEL* dcel;
+    try {
+        dcel = algo.computeAll();
+    } catch (std::runtime_error &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        exit(1);
+    }
+
+    if (trace != nullptr) {
+        algo.setTrace(nullptr);
+        try {
+            trace->close();
+        } catch (std::runtime_error &e) {
+            std::cerr << "ERROR: Cannot write " << tracePath << ": " << e.what() << std::endl;
+            exit(1);
+        }
+        delete trace;
+    }
 
     printf("\n\n--- FINISHED ---\n\n");
     printf("V: %d, HE: %d, F: %d\n", dcel->numVertices(), dcel->numHalfEdges(), dcel->numFaces());
 
-    std::cout << "\nVertices:\n" << std::endl;
-    for (auto v: dcel->vertices) {
-        std::cout << v->toString() << " " << v->pos.toString() << std::endl;
-    }
-
-    std::cout << "\nEdges:\n" << std::endl;
+    {
+        OutputBuffer out(stdout);
+        out.put("\nVertices:\n\n");
+        for (int32_t v = 0; v < dcel->numVertices(); v++) {
+            dcel->putVertexName(out, v);
+            out.put(' ');
+            out.putPoint(dcel->vertexX[v], dcel->vertexY[v]);
+            out.put('\n');
+        }
 
-    for (auto e: dcel->halfEdges) {
-        Vertex* origin = e->origin;
-        Vertex* dest = e->dest;
-        std::cout << e->toString() << " - "
-                  << (origin == nullptr ? "infty" : origin->toString() + origin->pos.toString()) << "->"
-                  << (dest == nullptr ? "infty" : dest->toString() + dest->pos.toString()) << std::endl;
+        out.put("\nEdges:\n\n");
+        for (int32_t e = 0; e < dcel->numHalfEdges(); e++) {
+            int32_t origin = dcel->edgeOrigin[e];
+            int32_t dest = dcel->dest(e);
+            dcel->putEdgeName(out, e);
+            out.put(" - ");
+            dcel->putVertexName(out, origin);
+            out.putPoint(dcel->vertexX[origin], dcel->vertexY[origin]);
+            out.put("->");
+            dcel->putVertexName(out, dest);
+            out.putPoint(dcel->vertexX[dest], dcel->vertexY[dest]);
+            out.put('\n');
+        }
     }
 
 
     // TODO: DEBUGGING ONLY -------------
-    std::ofstream file;
-    std::streambuf* oldCoutStreamBuf;
-    if (animate) {
-        file = std::ofstream("dump");
-        oldCoutStreamBuf = std::cout.rdbuf();
-        std::cout.rdbuf(file.rdbuf());
-    } else {
-        std::cout << "\n\nDEBUGGING: Generated python mpl syntax:\n```\n" << std::endl;
-    }
-    std::cout << "sites = np.array([" << std::endl;
-    for (auto s: sites) {
-        std::cout << "\t(" << std::to_string(s.x) << ", " << std::to_string(s.y) << ")," << std::endl;
-    }
-    std::cout << "])\n\n# Vertex list\nverts = np.array([" << std::endl;
-    for (auto v: dcel->vertices) {
-        std::cout << '\t' << v->pos.toString() << "," << (v->isBoundary ? "\t# boundary" : "") << std::endl;
-    }
-    std::cout << "])\n\n# Edge list\nv1 = np.array([" << std::endl;
-    for (auto e: dcel->halfEdges) {
-        std::cout << '\t';
-        Vertex* origin = e->origin;
-        if (origin == nullptr || e->dest == nullptr) std::cout << "# ";
-        std::cout << (origin == nullptr ? "(0, 0)" : origin->pos.toString()) << "," << std::endl;
-    }
-    std::cout << "])\n\nv2 = np.array([" << std::endl;
-    for (auto e: dcel->halfEdges) {
-        std::cout << '\t';
-        Vertex* dest = e->dest;
-        if (dest == nullptr || e->origin == nullptr) std::cout << "# ";
-        std::cout << (dest == nullptr ? "(0, 0)" : dest->pos.toString()) << "," << std::endl;
-    }
-    std::cout << "])\n\n" << std::endl;
-    if (animate) {
-        std::cout.rdbuf(oldCoutStreamBuf);  // Restore old std::cout buffer
-        file.close();
+    if (!animate) {
+        OutputBuffer out(stdout);
+        out.put("\n\nDEBUGGING: Generated python mpl syntax:\n```\n\n");
+        out.put("sites = np.array([\n");
+        for (const Vec2 &s: algo.sites) {
+            out.put('\t');
+            out.putPoint(s.x, s.y);
+            out.put(",\n");
+        }
+        out.put("])\n\n# Vertex list\nverts = np.array([\n");
+        for (int32_t v = 0; v < dcel->numVertices(); v++) {
+            out.put('\t');
+            out.putPoint(dcel->vertexX[v], dcel->vertexY[v]);
+            out.put(dcel->vertexIsBoundary[v] ? ",\t# boundary\n" : ",\n");
+        }
+        out.put("])\n\n# Edge list\nv1 = np.array([\n");
+        for (int32_t e = 0; e < dcel->numHalfEdges(); e++) {
+            out.put('\t');
+            out.putPoint(dcel->vertexX[dcel->edgeOrigin[e]], dcel->vertexY[dcel->edgeOrigin[e]]);
+            out.put(",\n");
+        }
+        out.put("])\n\nv2 = np.array([\n");
+        for (int32_t e = 0; e < dcel->numHalfEdges(); e++) {
+            out.put('\t');
+            out.putPoint(dcel->vertexX[dcel->dest(e)], dcel->vertexY[dcel->dest(e)]);
+            out.put(",\n");
+        }
+        out.put("])\n\n\n");
     }
     // ----------------------
 
@@ -111,6 +243,26 @@ int main(int argc, char* argv[]) {
 
     printf("\n\n");
 
+    // The Python tools load these arrays with np.load, the animation from dump.npz
+    if (animate && outputPath == nullptr) outputPath = "dump.npz";
+    if (outputPath != nullptr) {
+        try {
+            writeDiagramNpz(outputPath, algo.sites, dcel, delaunayTriangulation);
+        } catch (std::runtime_error &e) {
+            std::cerr << "ERROR: Cannot write " << outputPath << ": " << e.what() << std::endl;
+            exit(1);
+        }
+    }
+
+    for (const char* path: exportPaths) {
+        try {
+            exportDiagram(path, algo.sites, dcel, delaunayTriangulation);
+        } catch (std::runtime_error &e) {
+            std::cerr << "ERROR: Cannot export " << path << ": " << e.what() << std::endl;
+            exit(1);
+        }
+    }
+
     if (animate) return 0;
 
     // Set up renderer
@@ -118,12 +270,12 @@ int main(int argc, char* argv[]) {
 
     if ((!voronoi && !delaunay) || voronoi) {
         renderer.initVertexObjects(dcel);
-        renderer.initSiteVertexObjects(sites);
+        renderer.initSiteVertexObjects(algo.sites);
         renderer.startRender();  // Blocking call
         renderer.terminate();
     } else if (delaunay) {
         renderer.initVertexObjects(delaunayTriangulation);
-        renderer.initSiteVertexObjects(sites);
+        renderer.initSiteVertexObjects(algo.sites);
         renderer.startRender();  // Blocking call
         renderer.terminate();
     }
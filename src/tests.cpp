@@ -2,6 +2,22 @@
 #include "tests.hpp"
 #include "utils/PriorityQueue.hpp"
 #include "utils/LinkedSplayTree.hpp"
+#include "utils/ThreadPool.hpp"
+#include "utils/RadixHeap.hpp"
+#include "utils/files.hpp"
+#include "utils/OutputBuffer.hpp"
+#include "geometry/DCEL.hpp"
+#include "geometry/GeometryWriters.hpp"
+#include "geometry/DCELArchive.hpp"
+#include "geometry/DCELSnapshot.hpp"
+#include "utils/SiteBinary.hpp"
+#include "utils/Npy.hpp"
+#include "fortune/EventQueue.hpp"
+#include "fortune/SweepPlanner.hpp"
+#include "fortune/SweepTrace.hpp"
+#include "fortune/Fortune.hpp"
+#include "geometry/CompactVoronoi.hpp"
+#include "api/voronoi.h"
 
 
 void runAllTests() {
@@ -16,6 +32,8 @@ void runAllTests() {
 
     linkedSplayTreeTest1();
     linkedSplayTreeTest2_3();
+    linkedSplayTreeTest4();
+    linkedSplayTreeTest5();
 
     priorityQueueTest1();
     priorityQueueTest2();
@@ -25,6 +43,39 @@ void runAllTests() {
     priorityQueueTest6();
     priorityQueueTest7();
     priorityQueueTest8();
+    priorityQueueTest9();
+
+    radixHeapTest1();
+    radixHeapTest2();
+    eventQueueTest1();
+    sweepPlannerTest1();
+    sweepTraceTest1();
+    fortuneSweeperTest1();
+    fortuneSweeperTest2();
+    fortuneSweeperTest3();
+    colinearFastPathTest1();
+    colinearFastPathTest2();
+
+    siteParserTest1();
+    siteParserTest2();
+    siteBinaryTest1();
+    npyTest1();
+    npyTest2();
+    outputBufferTest1();
+    dcelFactoryTest1();
+    dcelOutputTest1();
+    geometryWritersTest1();
+    geometryWritersTest2();
+    dcelArchiveTest1();
+    dcelSnapshotTest1();
+
+    threadPoolTest1();
+    threadPoolTest2();
+
+    compactVoronoiTest1();
+    compactVoronoiTest2();
+
+    voronoiApiTest1();
 
     std::cout << "\n-- All assertions passed --\n" << std::endl;
 }
\ No newline at end of file
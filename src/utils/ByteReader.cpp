@@ -0,0 +1,33 @@
+#include "utils/ByteReader.hpp"
+#include "utils/OutputBuffer.hpp"
+
+ByteReader::ByteReader(const char* begin, const char* end, const char* format)
+    : position(begin), end(end), format(format) {}
+
+size_t ByteReader::remaining() const {
+    return end - position;
+}
+
+uint64_t ByteReader::varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 7 * VARINT_MAX_BYTES; shift += 7) {
+        require(1);
+        auto byte = static_cast<uint8_t>(*position++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    fail("Malformed varint in");
+}
+
+int64_t ByteReader::signedVarint() {
+    uint64_t value = varint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void ByteReader::require(size_t length) const {
+    if (remaining() < length) fail("Truncated");
+}
+
+void ByteReader::fail(const std::string &reason) const {
+    throw std::runtime_error(reason + " " + format);
+}
@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <random>
+#include <vector>
 #include "utils/LinkedSplayTree.hpp"
 #include "geometry/Vertex.hpp"
 #include "utils/SplayTree.hpp"
@@ -152,3 +156,149 @@ void linkedSplayTreeTest2_3() {
 
     std::cout << "Finished (Linked)SplayTree tests" << std::endl;
 }
+
+// Checks that the in-order traversal, the parent pointers and the linked list all agree with the expected keys
+static void checkLinkedTree(LinkedNode<int, int>* root, const std::vector<int> &expected) {
+    std::vector<int> inorder;
+    std::function<void(LinkedNode<int, int>*)> visit = [&](LinkedNode<int, int>* node) {
+        if (node == nullptr) return;
+        if (node->leftChild) assert(node->leftChild->parent == node);
+        if (node->rightChild) assert(node->rightChild->parent == node);
+        visit(node->leftChild);
+        inorder.push_back(node->key);
+        visit(node->rightChild);
+    };
+    visit(root);
+    assert(inorder == expected);
+
+    std::vector<int> listed;
+    LinkedNode<int, int>* previous = nullptr;
+    for (auto* node = root ? root->leftmost() : nullptr; node != nullptr; node = node->next) {
+        assert(node->prev == previous);
+        listed.push_back(node->key);
+        previous = node;
+    }
+    assert(listed == expected);
+}
+
+void linkedSplayTreeTest4() {
+    std::cout << "Testing LinkedSplayTree, case 4" << std::endl;
+    LinkedSplayTree<int, int> tree;
+    std::vector<int> expected;
+    for (int i = 0; i < 50; i++) {
+        tree.add((i * 37) % 50, i);
+        expected.push_back(i);
+    }
+
+    auto findNode = [&](int key) { return tree.search(key); };
+
+    // Middle of the tree
+    auto* replacement = new LinkedNode<int, int>(25);
+    LinkedNode<int, int>* cut = tree.replaceRange(findNode(20), findNode(29), replacement);
+    assert(cut != nullptr && cut->parent == nullptr);
+    assert(cut->leftmost()->key == 21 && cut->rightmost()->key == 28);
+    expected.erase(expected.begin() + 20, expected.begin() + 30);
+    expected.insert(expected.begin() + 20, 25);
+    checkLinkedTree(tree.root, expected);
+
+    // Both ends
+    tree.replaceRange(findNode(0), findNode(4), new LinkedNode<int, int>(2));
+    tree.splitRange(findNode(45), findNode(49));
+    expected.erase(expected.end() - 5, expected.end());
+    expected.erase(expected.begin(), expected.begin() + 5);
+    expected.insert(expected.begin(), 2);
+    checkLinkedTree(tree.root, expected);
+
+    // Everything
+    tree.replaceRange(tree.root->leftmost(), tree.root->rightmost(), new LinkedNode<int, int>(7));
+    checkLinkedTree(tree.root, {7});
+    tree.splitRange(tree.root, tree.root);
+    assert(tree.root == nullptr);
+}
+
+void linkedSplayTreeBenchmark() {
+    std::cout << "Benchmarking LinkedSplayTree range removal" << std::endl;
+
+    for (int runLength: {3, 8, 32}) {
+        double perNodeMs = 0;
+        double rangeMs = 0;
+
+        for (bool useRange: {false, true}) {
+            const int n = 200000;
+            LinkedSplayTree<int, int> tree;
+            std::vector<LinkedNode<int, int>*> nodes;
+            for (int i = 0; i < n; i++) nodes.push_back(tree.add(i, 0));
+
+            std::mt19937 rng(99);
+            auto start = std::chrono::steady_clock::now();
+
+            // Repeatedly collapse a run of nodes into its first key, like a cocircular event does to the beach line
+            for (int iteration = 0; iteration < n / (2 * runLength); iteration++) {
+                LinkedNode<int, int>* first = tree.root;
+                for (int steps = static_cast<int>(rng() % 64); steps > 0 && first->next; steps--) first = first->next;
+                LinkedNode<int, int>* last = first;
+                for (int i = 1; i < runLength && last->next; i++) last = last->next;
+
+                if (useRange) {
+                    nodes.push_back(new LinkedNode<int, int>(first->key));
+                    tree.replaceRange(first, last, nodes.back());
+                } else {
+                    int key = first->key;
+                    LinkedNode<int, int>* end = last->next;
+                    for (LinkedNode<int, int>* node = first; node != end;) {
+                        LinkedNode<int, int>* next = node->next;
+                        tree.removeNode(node, false);
+                        node = next;
+                    }
+                    nodes.push_back(tree.add(key, 0));
+                }
+            }
+
+            auto end = std::chrono::steady_clock::now();
+            (useRange ? rangeMs : perNodeMs) = std::chrono::duration<double, std::milli>(end - start).count();
+            for (auto* node: nodes) delete node;
+        }
+
+        printf("    run of %2d: per-node %8.3f ms, range %8.3f ms\n", runLength, perNodeMs, rangeMs);
+    }
+}
+
+void linkedSplayTreeTest5() {
+    std::cout << "Testing LinkedSplayTree, case 5" << std::endl;
+    for (int n: {0, 1, 2, 7, 100, 257}) {
+        for (bool evenNodesAsLeaves: {false, true}) {
+            if (evenNodesAsLeaves && n % 2 == 0) continue;
+
+            LinkedSplayTree<int, int> tree;
+            std::vector<LinkedNode<int, int>*> nodes;
+            std::vector<int> expected;
+            for (int i = 0; i < n; i++) {
+                nodes.push_back(new LinkedNode<int, int>(i));
+                expected.push_back(i);
+            }
+
+            tree.buildBalanced(nodes, evenNodesAsLeaves);
+            checkLinkedTree(tree.root, expected);
+
+            // Logarithmic depth, and leaves where they were asked for
+            std::function<int(LinkedNode<int, int>*)> depth = [&](LinkedNode<int, int>* node) {
+                return node == nullptr ? 0 : 1 + std::max(depth(node->leftChild), depth(node->rightChild));
+            };
+            int bound = 2;
+            while ((1 << (bound - 2)) < n) bound++;
+            assert(depth(tree.root) <= bound);
+            if (evenNodesAsLeaves) {
+                for (int i = 0; i < n; i += 2) assert(!nodes[i]->leftChild && !nodes[i]->rightChild);
+            }
+
+            // The result is a regular splay tree
+            if (n > 0) {
+                nodes.push_back(tree.add(n, 0));
+                expected.push_back(n);
+                checkLinkedTree(tree.root, expected);
+            }
+
+            for (auto* node: nodes) delete node;
+        }
+    }
+}
@@ -0,0 +1,618 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <unistd.h>
+#include "utils/Npy.hpp"
+
+// Zip record signatures
+#define ZIP_LOCAL_HEADER 0x04034b50
+#define ZIP_CENTRAL_HEADER 0x02014b50
+#define ZIP_END_OF_DIRECTORY 0x06054b50
+#define ZIP64_END_OF_DIRECTORY 0x06064b50
+#define ZIP64_END_LOCATOR 0x07064b50
+#define ZIP64_EXTRA_FIELD 0x0001
+
+// Placeholder of the 32-bit zip fields whose value is in the zip64 records
+#define ZIP64_MARKER 0xffffffffu
+
+// 1980-01-01, the earliest date a zip entry can have
+#define ZIP_DOS_DATE 0x21
+
+static uint64_t readLittleEndian(const char* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) value = (value << 8) | static_cast<unsigned char>(p[i]);
+    return value;
+}
+
+static void appendLittleEndian(std::string &out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+static uint32_t crc32(uint32_t crc, const char* data, size_t length) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+
+size_t NpyArray::numElements() const {
+    size_t count = 1;
+    for (size_t extent: shape) count *= extent;
+    return count;
+}
+
+double NpyArray::getDouble(size_t i) const {
+    if (kind == 'i') return static_cast<double>(getInt(i));
+    if (itemSize == 4) {
+        float value;
+        memcpy(&value, data + i * 4, 4);
+        return value;
+    }
+    double value;
+    memcpy(&value, data + i * 8, 8);
+    return value;
+}
+
+int64_t NpyArray::getInt(size_t i) const {
+    if (kind == 'f') return static_cast<int64_t>(getDouble(i));
+    if (itemSize == 4) {
+        int32_t value;
+        memcpy(&value, data + i * 4, 4);
+        return value;
+    }
+    int64_t value;
+    memcpy(&value, data + i * 8, 8);
+    return value;
+}
+
+
+// Returns the text following key in the header dictionary, or nullptr
+static const char* findHeaderValue(const std::string &header, const char* key) {
+    size_t position = header.find(key);
+    if (position == std::string::npos) return nullptr;
+    const char* p = header.c_str() + position + strlen(key);
+    while (*p == ' ' || *p == ':') p++;
+    return p;
+}
+
+NpyArray parseNpy(const char* begin, const char* end) {
+    size_t size = end - begin;
+    if (size < 10 || memcmp(begin, NPY_MAGIC, NPY_MAGIC_LENGTH) != 0) throw std::runtime_error("Not a .npy array");
+
+    // Version 1 has a 16-bit header length, and versions 2 and 3 a 32-bit one
+    int major = static_cast<unsigned char>(begin[6]);
+    if (major < 1 || major > 3) throw std::runtime_error("Unsupported .npy version " + std::to_string(major));
+    size_t prefix = major == 1 ? 10 : 12;
+    if (size < prefix) throw std::runtime_error("Truncated .npy header");
+    size_t headerLength = readLittleEndian(begin + 8, major == 1 ? 2 : 4);
+    if (prefix + headerLength > size) throw std::runtime_error("Truncated .npy header");
+    std::string header(begin + prefix, headerLength);
+
+    NpyArray array;
+    const char* descr = findHeaderValue(header, "'descr'");
+    if (descr == nullptr || (*descr != '\'' && *descr != '"')) throw std::runtime_error("No type in .npy header");
+    std::string type(descr + 1, std::min(strcspn(descr + 1, "'\""), static_cast<size_t>(8)));
+    if (type == "<f8") {
+        array.kind = 'f';
+        array.itemSize = 8;
+    } else if (type == "<f4") {
+        array.kind = 'f';
+        array.itemSize = 4;
+    } else if (type == "<i8") {
+        array.kind = 'i';
+        array.itemSize = 8;
+    } else if (type == "<i4") {
+        array.kind = 'i';
+        array.itemSize = 4;
+    } else {
+        throw std::runtime_error("Unsupported .npy type " + type);
+    }
+
+    const char* fortranOrder = findHeaderValue(header, "'fortran_order'");
+    if (fortranOrder == nullptr) throw std::runtime_error("No order in .npy header");
+    bool columnMajor = strncmp(fortranOrder, "True", 4) == 0;
+
+    const char* shape = findHeaderValue(header, "'shape'");
+    if (shape == nullptr || *shape != '(') throw std::runtime_error("No shape in .npy header");
+    for (const char* p = shape + 1; *p != ')'; p++) {
+        if (*p >= '0' && *p <= '9') {
+            char* extentEnd;
+            array.shape.push_back(strtoull(p, &extentEnd, 10));
+            p = extentEnd - 1;
+        } else if (*p != ',' && *p != ' ' && *p != 'L') {
+            throw std::runtime_error("Malformed shape in .npy header");
+        }
+    }
+    if (columnMajor && array.shape.size() > 1) throw std::runtime_error("Unsupported Fortran-ordered .npy array");
+
+    // The extents come from the file, so their product is checked before anything is sized by it
+    size_t numElements = 1;
+    for (size_t extent: array.shape) {
+        if (extent != 0 && numElements > SIZE_MAX / extent) throw std::runtime_error("Oversized shape in .npy header");
+        numElements *= extent;
+    }
+
+    array.data = begin + prefix + headerLength;
+    if (numElements > (size - prefix - headerLength) / array.itemSize) {
+        throw std::runtime_error("Truncated .npy data");
+    }
+    return array;
+}
+
+
+NumpyFile::NumpyFile(const std::string &path) : file(path) {
+    if (file.size() >= NPY_MAGIC_LENGTH && memcmp(file.data(), NPY_MAGIC, NPY_MAGIC_LENGTH) == 0) {
+        names.emplace_back("");
+        arrays.push_back(parseNpy(file.data(), file.data() + file.size()));
+    } else {
+        readArchive(path);
+    }
+}
+
+void NumpyFile::readArchive(const std::string &path) {
+    const char* data = file.data();
+    size_t size = file.size();
+
+    // The end of directory record is the last thing in the file, before a comment of up to 64 KiB
+    size_t endRecord = SIZE_MAX;
+    for (size_t p = size - 22; size >= 22 && size - p <= 22 + 0xffff; p--) {
+        if (readLittleEndian(data + p, 4) == ZIP_END_OF_DIRECTORY) {
+            endRecord = p;
+            break;
+        }
+        if (p == 0) break;
+    }
+    if (endRecord == SIZE_MAX) throw std::runtime_error("Not a .npy file or .npz archive: " + path);
+
+    // Offsets and sizes come from the file, and may be anything up to 2^64 - 1, so ranges are checked by subtraction,
+    // which can't wrap around
+    auto inFile = [&](uint64_t offset, uint64_t length) { return offset <= size && length <= size - offset; };
+
+    uint64_t numEntries = readLittleEndian(data + endRecord + 10, 2);
+    uint64_t directoryOffset = readLittleEndian(data + endRecord + 16, 4);
+    if ((numEntries == 0xffff || directoryOffset == ZIP64_MARKER) && endRecord >= 20
+        && readLittleEndian(data + endRecord - 20, 4) == ZIP64_END_LOCATOR) {
+        uint64_t zip64Record = readLittleEndian(data + endRecord - 12, 8);
+        if (!inFile(zip64Record, 56) || readLittleEndian(data + zip64Record, 4) != ZIP64_END_OF_DIRECTORY) {
+            throw std::runtime_error("Corrupt zip64 directory in " + path);
+        }
+        numEntries = readLittleEndian(data + zip64Record + 32, 8);
+        directoryOffset = readLittleEndian(data + zip64Record + 48, 8);
+    }
+
+    uint64_t p = directoryOffset;
+    for (uint64_t entry = 0; entry < numEntries; entry++) {
+        if (!inFile(p, 46) || readLittleEndian(data + p, 4) != ZIP_CENTRAL_HEADER) {
+            throw std::runtime_error("Corrupt zip directory in " + path);
+        }
+        uint64_t method = readLittleEndian(data + p + 10, 2);
+        uint64_t compressedSize = readLittleEndian(data + p + 20, 4);
+        uint64_t nameLength = readLittleEndian(data + p + 28, 2);
+        uint64_t extraLength = readLittleEndian(data + p + 30, 2);
+        uint64_t commentLength = readLittleEndian(data + p + 32, 2);
+        uint64_t localOffset = readLittleEndian(data + p + 42, 4);
+        if (!inFile(p, 46 + nameLength + extraLength)) throw std::runtime_error("Corrupt zip directory in " + path);
+        std::string name(data + p + 46, nameLength);
+
+        // Fields too large for 32 bits are in the zip64 extra field, in this order, and only if marked. Each one read
+        // must lie within the field, which lies within the extra data of the entry.
+        uint64_t uncompressedSize = readLittleEndian(data + p + 24, 4);
+        uint64_t extraEnd = p + 46 + nameLength + extraLength;
+        for (uint64_t q = p + 46 + nameLength; q + 4 <= extraEnd;) {
+            uint64_t id = readLittleEndian(data + q, 2);
+            uint64_t length = readLittleEndian(data + q + 2, 2);
+            uint64_t fieldEnd = q + 4 + length;
+            if (fieldEnd > extraEnd) throw std::runtime_error("Corrupt zip extra field of " + name + " in " + path);
+            if (id == ZIP64_EXTRA_FIELD) {
+                uint64_t field = q + 4;
+                auto next = [&]() {
+                    if (field + 8 > fieldEnd) {
+                        throw std::runtime_error("Short zip64 extra field of " + name + " in " + path);
+                    }
+                    field += 8;
+                    return readLittleEndian(data + field - 8, 8);
+                };
+                if (uncompressedSize == ZIP64_MARKER) next();
+                if (compressedSize == ZIP64_MARKER) compressedSize = next();
+                if (localOffset == ZIP64_MARKER) localOffset = next();
+            }
+            q = fieldEnd;
+        }
+
+        if (method != 0) throw std::runtime_error("Compressed .npz member " + name + " is not supported");
+        if (!inFile(localOffset, 30) || readLittleEndian(data + localOffset, 4) != ZIP_LOCAL_HEADER) {
+            throw std::runtime_error("Corrupt zip entry " + name + " in " + path);
+        }
+        uint64_t dataOffset = localOffset + 30 + readLittleEndian(data + localOffset + 26, 2)
+                              + readLittleEndian(data + localOffset + 28, 2);
+        if (!inFile(dataOffset, compressedSize)) {
+            throw std::runtime_error("Truncated zip entry " + name + " in " + path);
+        }
+
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0) name.resize(name.size() - 4);
+        names.push_back(name);
+        arrays.push_back(parseNpy(data + dataOffset, data + dataOffset + compressedSize));
+
+        p += 46 + nameLength + extraLength + commentLength;
+    }
+}
+
+const NpyArray* NumpyFile::find(const std::string &name) const {
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) return &arrays[i];
+    }
+    return nullptr;
+}
+
+
+bool isNumpyFile(const std::string &path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return false;
+    char magic[NPY_MAGIC_LENGTH];
+    bool matches = false;
+    if (fread(magic, 1, sizeof(magic), in) == sizeof(magic)) {
+        matches = memcmp(magic, NPY_MAGIC, NPY_MAGIC_LENGTH) == 0 || readLittleEndian(magic, 4) == ZIP_LOCAL_HEADER;
+    }
+    fclose(in);
+    return matches;
+}
+
+
+// Version 1.0 header of an array, padded so that the data starts aligned
+static std::string npyHeader(const char* descr, const std::vector<size_t> &shape) {
+    std::string dictionary = std::string("{'descr': '") + descr + "', 'fortran_order': False, 'shape': (";
+    for (size_t extent: shape) dictionary += std::to_string(extent) + ", ";
+    if (shape.size() > 1) dictionary.resize(dictionary.size() - 2);
+    if (shape.size() == 1) dictionary.resize(dictionary.size() - 1);
+    dictionary += "), }";
+
+    size_t unpadded = 10 + dictionary.size() + 1;
+    dictionary.append((NPY_HEADER_ALIGNMENT - unpadded % NPY_HEADER_ALIGNMENT) % NPY_HEADER_ALIGNMENT, ' ');
+    dictionary += '\n';
+
+    std::string header(NPY_MAGIC, NPY_MAGIC_LENGTH);
+    header += '\x01';
+    header += '\x00';
+    appendLittleEndian(header, dictionary.size(), 2);
+    return header + dictionary;
+}
+
+static size_t npyDataSize(const char* descr, const std::vector<size_t> &shape) {
+    size_t count = 1;
+    for (size_t extent: shape) count *= extent;
+    return count * static_cast<size_t>(descr[2] - '0');
+}
+
+
+void writeNpy(const std::string &path, const char* descr, const std::vector<size_t> &shape, const void* data) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (out == nullptr) throw std::runtime_error("Cannot open file for writing: " + path);
+    std::string header = npyHeader(descr, shape);
+    size_t dataSize = npyDataSize(descr, shape);
+    bool ok = fwrite(header.data(), 1, header.size(), out) == header.size()
+              && (dataSize == 0 || fwrite(data, 1, dataSize, out) == dataSize);
+    if (fclose(out) != 0 || !ok) throw std::runtime_error("Cannot write file: " + path);
+}
+
+
+NpzWriter::NpzWriter(const std::string &path) : path(path) {
+    out = fopen(path.c_str(), "wb");
+    if (out == nullptr) throw std::runtime_error("Cannot open file for writing: " + path);
+}
+
+NpzWriter::~NpzWriter() {
+    if (out != nullptr) fclose(out);
+}
+
+void NpzWriter::write(const void* bytes, size_t length) {
+    if (length > 0 && fwrite(bytes, 1, length, out) != length) failed = true;
+    written += length;
+}
+
+void NpzWriter::add(const std::string &name, const char* descr, const std::vector<size_t> &shape, const void* data) {
+    std::string header = npyHeader(descr, shape);
+    size_t dataSize = npyDataSize(descr, shape);
+    if (header.size() + dataSize >= ZIP64_MARKER || written + header.size() + dataSize >= ZIP64_MARKER) {
+        throw std::runtime_error("Array " + name + " is too large for a .npz archive");
+    }
+
+    Entry entry {name + ".npy", 0, static_cast<uint32_t>(header.size() + dataSize), static_cast<uint32_t>(written)};
+    entry.crc = crc32(0, header.data(), header.size());
+    entry.crc = crc32(entry.crc, static_cast<const char*>(data), dataSize);
+
+    std::string local;
+    appendLittleEndian(local, ZIP_LOCAL_HEADER, 4);
+    appendLittleEndian(local, 20, 2);
+    appendLittleEndian(local, 0, 2);
+    appendLittleEndian(local, 0, 2);
+    appendLittleEndian(local, 0, 2);
+    appendLittleEndian(local, ZIP_DOS_DATE, 2);
+    appendLittleEndian(local, entry.crc, 4);
+    appendLittleEndian(local, entry.size, 4);
+    appendLittleEndian(local, entry.size, 4);
+    appendLittleEndian(local, entry.name.size(), 2);
+    appendLittleEndian(local, 0, 2);
+    local += entry.name;
+
+    write(local.data(), local.size());
+    write(header.data(), header.size());
+    write(data, dataSize);
+    entries.push_back(entry);
+}
+
+void NpzWriter::close() {
+    if (out == nullptr) return;
+
+    std::string directory;
+    for (const Entry &entry: entries) {
+        appendLittleEndian(directory, ZIP_CENTRAL_HEADER, 4);
+        appendLittleEndian(directory, 20, 2);
+        appendLittleEndian(directory, 20, 2);
+        appendLittleEndian(directory, 0, 2);
+        appendLittleEndian(directory, 0, 2);
+        appendLittleEndian(directory, 0, 2);
+        appendLittleEndian(directory, ZIP_DOS_DATE, 2);
+        appendLittleEndian(directory, entry.crc, 4);
+        appendLittleEndian(directory, entry.size, 4);
+        appendLittleEndian(directory, entry.size, 4);
+        appendLittleEndian(directory, entry.name.size(), 2);
+        appendLittleEndian(directory, 0, 2);
+        appendLittleEndian(directory, 0, 2);
+        appendLittleEndian(directory, 0, 2);
+        appendLittleEndian(directory, 0, 2);
+        appendLittleEndian(directory, 0, 4);
+        appendLittleEndian(directory, entry.offset, 4);
+        directory += entry.name;
+    }
+
+    size_t directorySize = directory.size();
+    appendLittleEndian(directory, ZIP_END_OF_DIRECTORY, 4);
+    appendLittleEndian(directory, 0, 2);
+    appendLittleEndian(directory, 0, 2);
+    appendLittleEndian(directory, entries.size(), 2);
+    appendLittleEndian(directory, entries.size(), 2);
+    appendLittleEndian(directory, directorySize, 4);
+    appendLittleEndian(directory, written, 4);
+    appendLittleEndian(directory, 0, 2);
+    write(directory.data(), directory.size());
+
+    bool closed = fclose(out) == 0;
+    out = nullptr;
+    if (!closed || failed) throw std::runtime_error("Cannot write file: " + path);
+}
+
+
+std::vector<Vec2> readSitesNumpy(const std::string &path) {
+    NumpyFile file(path);
+    const NpyArray* coordinates = file.find("");
+    if (coordinates == nullptr) coordinates = file.find("sites");
+    if (coordinates == nullptr) throw std::runtime_error("No sites array in " + path);
+    if (coordinates->shape.size() != 2 || coordinates->shape[1] != 2) {
+        throw std::runtime_error("Sites in " + path + " must have shape (n, 2)");
+    }
+
+    size_t n = coordinates->shape[0];
+    const NpyArray* ids = file.find("ids");
+    if (ids != nullptr && (ids->shape.size() != 1 || ids->shape[0] != n || ids->kind != 'i')) {
+        throw std::runtime_error("Identifiers in " + path + " must be integers of shape (n,)");
+    }
+
+    if (n > INT32_MAX) throw std::runtime_error("Too many sites in " + path);
+
+    std::vector<Vec2> sites;
+    sites.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        int64_t identifier = ids == nullptr ? static_cast<int64_t>(i) + 1 : ids->getInt(i);
+        if (identifier < 0 || identifier > INT32_MAX) {
+            throw std::runtime_error("Identifier " + std::to_string(identifier) + " out of range in " + path);
+        }
+        double x = coordinates->getDouble(2 * i);
+        sites.emplace_back(x, coordinates->getDouble(2 * i + 1), static_cast<int>(identifier));
+    }
+    return sites;
+}
+
+
+void writeSitesNpy(const std::string &path, const std::vector<Vec2> &sites) {
+    std::vector<double> coordinates;
+    coordinates.reserve(2 * sites.size());
+    for (const Vec2 &s: sites) {
+        coordinates.push_back(s.x);
+        coordinates.push_back(s.y);
+    }
+    writeNpy(path, "<f8", {sites.size(), 2}, coordinates.data());
+}
+
+
+static void addDCEL(NpzWriter &writer, const std::string &prefix, const DCEL* dcel) {
+    size_t numVertices = dcel->numVertices();
+    std::vector<double> vertices(2 * numVertices);
+    for (size_t v = 0; v < numVertices; v++) {
+        vertices[2 * v] = dcel->vertexX[v];
+        vertices[2 * v + 1] = dcel->vertexY[v];
+    }
+    writer.add(prefix + "vertices", "<f8", {numVertices, 2}, vertices.data());
+
+    // Twins are adjacent, so every even half-edge stands for one edge
+    size_t numEdges = dcel->numHalfEdges() / 2;
+    std::vector<int32_t> edges(2 * numEdges);
+    for (size_t e = 0; e < numEdges; e++) {
+        edges[2 * e] = dcel->edgeOrigin[2 * e];
+        edges[2 * e + 1] = dcel->edgeOrigin[2 * e + 1];
+    }
+    writer.add(prefix + "edges", "<i4", {numEdges, 2}, edges.data());
+
+    size_t numFaces = dcel->numFaces();
+    FaceRings rings(dcel);
+    std::vector<int32_t> faceOffsets = {0};
+    std::vector<int32_t> faceVertices;
+    faceOffsets.reserve(numFaces + 1);
+    faceVertices.reserve(dcel->numHalfEdges());
+    for (size_t f = 0; f < numFaces; f++) {
+        rings.forEachVertex(static_cast<int32_t>(f), [&](int32_t v) { faceVertices.push_back(v); });
+        faceOffsets.push_back(static_cast<int32_t>(faceVertices.size()));
+    }
+    writer.add(prefix + "face_offsets", "<i4", {numFaces + 1}, faceOffsets.data());
+    writer.add(prefix + "face_vertices", "<i4", {faceVertices.size()}, faceVertices.data());
+    writer.add(prefix + "face_labels", "<i4", {numFaces}, dcel->faceLabel.data());
+}
+
+void writeDiagramNpz(
+    const std::string &path,
+    const std::vector<Vec2> &sites,
+    const DCEL* voronoi,
+    const DCEL* delaunay
+) {
+    NpzWriter writer(path);
+
+    std::vector<double> coordinates;
+    std::vector<int32_t> identifiers;
+    coordinates.reserve(2 * sites.size());
+    identifiers.reserve(sites.size());
+    for (const Vec2 &s: sites) {
+        coordinates.push_back(s.x);
+        coordinates.push_back(s.y);
+        identifiers.push_back(s.identifier);
+    }
+    writer.add("sites", "<f8", {sites.size(), 2}, coordinates.data());
+    writer.add("site_ids", "<i4", {sites.size()}, identifiers.data());
+
+    addDCEL(writer, "", voronoi);
+    if (delaunay != nullptr) addDCEL(writer, "delaunay_", delaunay);
+    writer.close();
+}
+
+
+void npyTest1() {
+    std::cout << "Testing .npy arrays, case 1" << std::endl;
+
+    // Headers round-trip through the parser, with the data aligned
+    std::vector<std::vector<size_t>> shapes = {{0}, {7}, {3, 2}, {2, 3, 4}};
+    for (const std::vector<size_t> &shape: shapes) {
+        std::string header = npyHeader("<i4", shape);
+        assert(header.size() % NPY_HEADER_ALIGNMENT == 0);
+        std::string file = header + std::string(npyDataSize("<i4", shape), '\0');
+        NpyArray array = parseNpy(file.data(), file.data() + file.size());
+        assert(array.shape == shape && array.kind == 'i' && array.itemSize == 4);
+        assert(array.data == file.data() + header.size());
+    }
+
+    // Older NumPy versions only pad headers to 16 bytes
+    std::string dictionary = "{'descr': '<f4', 'fortran_order': False, 'shape': (2, 2), }";
+    dictionary += std::string(80 - 10 - dictionary.size() - 1, ' ') + "\n";
+    std::string legacy = std::string(NPY_MAGIC, NPY_MAGIC_LENGTH) + "\x01" + std::string(1, '\0');
+    appendLittleEndian(legacy, dictionary.size(), 2);
+    legacy += dictionary;
+    float values[4] = {1.5f, -2, 0.25f, 8};
+    legacy.append(reinterpret_cast<const char*>(values), sizeof(values));
+    NpyArray array = parseNpy(legacy.data(), legacy.data() + legacy.size());
+    assert(array.shape.size() == 2 && array.kind == 'f' && array.itemSize == 4);
+    for (int i = 0; i < 4; i++) assert(array.getDouble(i) == values[i]);
+
+    std::vector<std::string> malformed = {
+        legacy.substr(0, legacy.size() - 1),
+        std::string(legacy).replace(legacy.find("<f4"), 3, ">f4"),
+        std::string(legacy).replace(legacy.find("False"), 5, "True "),
+        "not an array",
+        // Extents whose product wraps around to a small size
+        npyHeader("<i4", {size_t(1) << 40, size_t(1) << 40, 16}) + std::string(16, '\0'),
+    };
+    for (const std::string &text: malformed) {
+        try {
+            parseNpy(text.data(), text.data() + text.size());
+            assert(false);
+        } catch (std::runtime_error &e) {}
+    }
+}
+
+void npyTest2() {
+    std::cout << "Testing .npz archives, case 2" << std::endl;
+
+    char path[] = "/tmp/voronoi-npz-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    // Sites with explicit identifiers, and a diagram-shaped array, round-trip through an archive
+    double coordinates[6] = {0, 2, 2, 0, -1.5, 0.25};
+    int64_t ids[3] = {4, 9, 2};
+    NpzWriter writer(path);
+    writer.add("sites", "<f8", {3, 2}, coordinates);
+    writer.add("ids", "<i8", {3}, ids);
+    writer.add("empty", "<i4", {0, 2}, nullptr);
+    writer.close();
+
+    assert(isNumpyFile(path));
+    std::vector<Vec2> sites = readSitesNumpy(path);
+    assert(sites.size() == 3);
+    for (int i = 0; i < 3; i++) {
+        assert(sites[i].x == coordinates[2 * i] && sites[i].y == coordinates[2 * i + 1]);
+        assert(sites[i].identifier == ids[i]);
+    }
+    NumpyFile archive(path);
+    assert(archive.find("empty") != nullptr && archive.find("empty")->numElements() == 0);
+    assert(archive.find("missing") == nullptr);
+
+    // And through a plain .npy file, numbered in order
+    writeSitesNpy(path, sites);
+    std::vector<Vec2> reread = readSitesNumpy(path);
+    assert(reread.size() == 3 && reread[2].x == -1.5 && reread[2].identifier == 3);
+
+    // Identifiers that don't fit a site are refused, rather than wrapped
+    for (int64_t bad: {int64_t(-1), int64_t(INT32_MAX) + 1}) {
+        ids[1] = bad;
+        NpzWriter badWriter(path);
+        badWriter.add("sites", "<f8", {3, 2}, coordinates);
+        badWriter.add("ids", "<i8", {3}, ids);
+        badWriter.close();
+        try {
+            readSitesNumpy(path);
+            assert(false);
+        } catch (std::runtime_error &e) {}
+    }
+
+    // A zip64 extra field that is shorter than it claims, or shorter than the sizes it's marked to hold, or that
+    // holds a size running past the end of the file, is refused rather than read past the mapping
+    NpzWriter oneWriter(path);
+    oneWriter.add("sites", "<f8", {3, 2}, coordinates);
+    oneWriter.close();
+    std::ifstream in(path, std::ios::binary);
+    std::string archiveBytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    size_t central = archiveBytes.find("PK\x01\x02");
+    assert(central != std::string::npos);
+    size_t nameLength = readLittleEndian(archiveBytes.data() + central + 28, 2);
+    for (int malformed = 0; malformed < 3; malformed++) {
+        std::string extra;
+        appendLittleEndian(extra, ZIP64_EXTRA_FIELD, 2);
+        appendLittleEndian(extra, malformed == 0 ? 40 : malformed == 1 ? 4 : 8, 2);
+        appendLittleEndian(extra, 0xffffffffffffff00ull, malformed == 1 ? 4 : 8);
+
+        std::string patched = archiveBytes;
+        patched.insert(central + 46 + nameLength, extra);
+        patched.replace(central + 30, 2, std::string(1, char(extra.size())) + '\0');
+        patched.replace(central + 20, 4, std::string(4, '\xff'));
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(patched.data(), static_cast<std::streamsize>(patched.size()));
+        out.close();
+        try {
+            NumpyFile broken(path);
+            assert(false);
+        } catch (std::runtime_error &e) {}
+    }
+
+    remove(path);
+}
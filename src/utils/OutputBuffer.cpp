@@ -0,0 +1,116 @@
+#include <iostream>
+#include <cassert>
+#include <charconv>
+#include <string>
+#include <cmath>
+#include <vector>
+#include "utils/OutputBuffer.hpp"
+
+OutputBuffer::OutputBuffer(FILE* out) : out(out) {}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+void OutputBuffer::drain() {
+    if (used > 0 && fwrite(buffer, 1, used, out) != used) failed = true;
+    used = 0;
+}
+
+void OutputBuffer::flush() {
+    drain();
+    if (fflush(out) != 0) failed = true;
+}
+
+bool OutputBuffer::good() const {
+    return !failed;
+}
+
+void OutputBuffer::put(const char* text, size_t length) {
+    if (used + length > OUTPUT_BUFFER_SIZE) {
+        drain();
+
+        // Too long to be worth copying
+        if (length > OUTPUT_BUFFER_SIZE) {
+            if (fwrite(text, 1, length, out) != length) failed = true;
+            return;
+        }
+    }
+    memcpy(buffer + used, text, length);
+    used += length;
+}
+
+void OutputBuffer::putInt(int64_t value) {
+    if (used + OUTPUT_BUFFER_MAX_ITEM > OUTPUT_BUFFER_SIZE) drain();
+    used = std::to_chars(buffer + used, buffer + OUTPUT_BUFFER_SIZE, value).ptr - buffer;
+}
+
+void OutputBuffer::putFixed(double value) {
+    if (used + OUTPUT_BUFFER_MAX_ITEM > OUTPUT_BUFFER_SIZE) drain();
+    used = std::to_chars(buffer + used, buffer + OUTPUT_BUFFER_SIZE, value, std::chars_format::fixed, 6).ptr - buffer;
+}
+
+void OutputBuffer::putShortest(double value) {
+    if (used + OUTPUT_BUFFER_MAX_ITEM > OUTPUT_BUFFER_SIZE) drain();
+    used = std::to_chars(buffer + used, buffer + OUTPUT_BUFFER_SIZE, value).ptr - buffer;
+}
+
+void OutputBuffer::putVarint(uint64_t value) {
+    if (used + VARINT_MAX_BYTES > OUTPUT_BUFFER_SIZE) drain();
+    while (value >= 0x80) {
+        buffer[used++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer[used++] = static_cast<char>(value);
+}
+
+void OutputBuffer::putSignedVarint(int64_t value) {
+    putVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void OutputBuffer::putPoint(double x, double y) {
+    put('(');
+    putFixed(x);
+    put(", ", 2);
+    putFixed(y);
+    put(')');
+}
+
+
+void outputBufferTest1() {
+    std::cout << "Testing OutputBuffer, case 1" << std::endl;
+
+    // Numbers come out the same as through printf, across the buffer boundary
+    std::vector<double> values = {0, -0.0, 1.5, -2.0000005, 1e-7, 123456789.123456789, 1e300, -1e-300, 0.1234565,
+                                  3.0 / 7, INFINITY, -INFINITY, 1.234567e8};
+    FILE* ours = tmpfile();
+    FILE* reference = tmpfile();
+    {
+        OutputBuffer out(ours);
+        for (int round = 0; round < 2000; round++) {
+            for (double v: values) {
+                out.putFixed(v * (round + 1));
+                out.put(' ');
+                fprintf(reference, "%f ", v * (round + 1));
+            }
+            out.putPoint(values[round % values.size()], round);
+            out.putInt(-round * 1000003LL);
+            out.put("\n");
+            fprintf(reference, "(%f, %f)%lld\n", values[round % values.size()], static_cast<double>(round),
+                    -round * 1000003LL);
+        }
+    }
+
+    assert(ftell(ours) == ftell(reference));
+    rewind(ours);
+    rewind(reference);
+    int a;
+    int b;
+    do {
+        a = fgetc(ours);
+        b = fgetc(reference);
+        assert(a == b);
+    } while (a != EOF);
+    fclose(ours);
+    fclose(reference);
+}
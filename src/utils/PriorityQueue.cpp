@@ -129,3 +129,34 @@ void priorityQueueTest8() {
     assert(pq.peek().label == 1);
     assert(pq.poll().pos.y == 1);
 }
+
+void priorityQueueTest9() {
+    std::cout << "Testing PriorityQueue, case 9" << std::endl;
+    std::vector<int> values = {42, 7, 19, 3, 88, 3, 64, 21, 5, 50, 13, 1, 77};
+
+    // Bulk-built heaps of several arities must drain in sorted order
+    auto binary = PriorityQueue<int, std::less<>, 2>(values);
+    auto quaternary = PriorityQueue<int>(values);
+    auto octonary = PriorityQueue<int, std::less<>, 8>(values);
+    assert(binary.size() == values.size());
+
+    std::vector<int> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    for (int expected: sorted) {
+        assert(binary.poll() == expected);
+        assert(quaternary.poll() == expected);
+        assert(octonary.poll() == expected);
+    }
+    assert(binary.empty() && quaternary.empty() && octonary.empty());
+
+    // emplace constructs in place, and interleaves with bulk-built contents
+    auto pq = PriorityQueue<Vertex, VertexMaxHeapTestComparator, 3>();
+    pq.build({Vertex(1, Vec2(1, 0)), Vertex(2, Vec2(0, 4))});
+    pq.emplace(3, Vec2(2, 0));
+    pq.push(Vertex(4, Vec2(5, 0)));
+    assert(pq.poll().label == 4);
+    assert(pq.poll().label == 2);
+    assert(pq.poll().label == 3);
+    assert(pq.poll().label == 1);
+    assert(pq.empty());
+}
@@ -0,0 +1,43 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include "utils/RadixHeap.hpp"
+
+void radixHeapTest1() {
+    std::cout << "Testing RadixHeap, case 1" << std::endl;
+    std::vector<double> values = {-1e300, -3.5, -1, -1e-300, -0.0, 0.0, 1e-300, 0.25, 1, 2, 1e300};
+    for (size_t i = 1; i < values.size(); i++) {
+        assert(orderPreservingBits(values[i - 1]) <= orderPreservingBits(values[i]));
+        if (values[i - 1] < values[i]) assert(orderPreservingBits(values[i - 1]) < orderPreservingBits(values[i]));
+    }
+}
+
+void radixHeapTest2() {
+    std::cout << "Testing RadixHeap, case 2" << std::endl;
+    RadixHeap<int> heap;
+    for (uint64_t key: {40, 7, 19, 7, 1000, 3}) heap.push(key, static_cast<int>(key));
+    assert(heap.size() == 6);
+
+    assert(heap.poll() == 3);
+    assert(heap.peekKey() == 7);
+    assert(heap.poll() == 7);
+
+    // Monotone pushes, at and after the last polled key
+    heap.push(7, 8);
+    heap.push(500, 500);
+    heap.push(20, 20);
+    assert(heap.lastKey() == 7);
+    std::vector<int> polled;
+    while (!heap.empty()) polled.push_back(heap.poll());
+
+    std::vector<int> expected = {7, 8, 19, 20, 40, 500, 1000};
+    std::sort(polled.begin(), polled.begin() + 2);
+    assert(polled == expected);
+
+    try {
+        heap.push(3, 3);
+        assert(false);
+    } catch (std::invalid_argument &e) {
+        assert(true);
+    }
+}
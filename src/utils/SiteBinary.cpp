@@ -0,0 +1,306 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <chrono>
+#include <random>
+#include <unistd.h>
+#include "utils/SiteBinary.hpp"
+#include "utils/ByteOrder.hpp"
+#include "fortune/Fortune.hpp"
+#include "benchmarks.hpp"
+
+static_assert(sizeof(SiteBinaryHeader) == SITE_BINARY_HEADER_SIZE, "Binary site header must be packed");
+
+// The header goes through the file field by field in little-endian order, rather than as the struct in host order
+static void encodeHeader(const SiteBinaryHeader &header, char* bytes) {
+    memcpy(bytes, header.magic, sizeof(header.magic));
+    storeLittleEndian(bytes + 8, header.version);
+    storeLittleEndian(bytes + 12, header.flags);
+    storeLittleEndian(bytes + 16, header.numSites);
+}
+
+static SiteBinaryHeader decodeHeader(const char* bytes) {
+    SiteBinaryHeader header {};
+    memcpy(header.magic, bytes, sizeof(header.magic));
+    header.version = loadLittleEndian<uint32_t>(bytes + 8);
+    header.flags = loadLittleEndian<uint32_t>(bytes + 12);
+    header.numSites = loadLittleEndian<uint64_t>(bytes + 16);
+    return header;
+}
+
+
+MappedSites::MappedSites(const std::string &path) : file(path) {
+    if (file.size() < SITE_BINARY_HEADER_SIZE) throw std::runtime_error("Truncated binary site file: " + path);
+
+    SiteBinaryHeader header = decodeHeader(file.data());
+    if (memcmp(header.magic, SITE_BINARY_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a binary site file: " + path);
+    }
+    if (header.version != SITE_BINARY_VERSION) {
+        std::string version = std::to_string(header.version);
+        throw std::runtime_error("Unsupported version " + version + " of binary site file: " + path);
+    }
+    if ((header.flags & ~static_cast<uint32_t>(SITE_BINARY_FLOAT32 | SITE_BINARY_IDS)) != 0) {
+        throw std::runtime_error("Unknown flags in binary site file: " + path);
+    }
+    if (header.numSites > INT32_MAX) throw std::runtime_error("Too many sites in binary site file: " + path);
+
+    flags = header.flags;
+    numSites = static_cast<int>(header.numSites);
+    size_t coordinateSize = (flags & SITE_BINARY_FLOAT32) ? sizeof(float) : sizeof(double);
+    size_t expectedSize = SITE_BINARY_HEADER_SIZE + numSites * 2 * coordinateSize;
+    if (flags & SITE_BINARY_IDS) expectedSize += numSites * sizeof(int32_t);
+    if (file.size() != expectedSize) throw std::runtime_error("Binary site file has the wrong size: " + path);
+
+    xs = file.data() + SITE_BINARY_HEADER_SIZE;
+    ys = xs + numSites * coordinateSize;
+    if (flags & SITE_BINARY_IDS) ids = ys + numSites * coordinateSize;
+
+    // The sweep trusts its input, so the sites are checked here, once, rather than on every access
+    bool sequential = true;
+    for (int i = 0; i < numSites; i++) {
+        if (!std::isfinite(x(i)) || !std::isfinite(y(i))) {
+            throw std::runtime_error("Site " + std::to_string(i + 1) + " is not finite in binary site file: " + path);
+        }
+        if (identifier(i) < 0) throw std::runtime_error("Negative identifier in binary site file: " + path);
+        sequential &= identifier(i) == i + 1;
+    }
+    if (sequential) return;
+
+    std::vector<int32_t> sortedIds(numSites);
+    for (int i = 0; i < numSites; i++) sortedIds[i] = identifier(i);
+    std::sort(sortedIds.begin(), sortedIds.end());
+    if (std::adjacent_find(sortedIds.begin(), sortedIds.end()) != sortedIds.end()) {
+        throw std::runtime_error("Duplicate identifiers in binary site file: " + path);
+    }
+}
+
+int MappedSites::size() const {
+    return numSites;
+}
+
+double MappedSites::x(int i) const {
+    if (flags & SITE_BINARY_FLOAT32) return loadLittleEndian<float>(xs + i * sizeof(float));
+    return loadLittleEndian<double>(xs + i * sizeof(double));
+}
+
+double MappedSites::y(int i) const {
+    if (flags & SITE_BINARY_FLOAT32) return loadLittleEndian<float>(ys + i * sizeof(float));
+    return loadLittleEndian<double>(ys + i * sizeof(double));
+}
+
+int MappedSites::identifier(int i) const {
+    return ids == nullptr ? i + 1 : loadLittleEndian<int32_t>(ids + i * sizeof(int32_t));
+}
+
+bool MappedSites::singlePrecision() const {
+    return flags & SITE_BINARY_FLOAT32;
+}
+
+
+bool isSiteBinaryFile(const std::string &path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return false;
+    char magic[8];
+    bool matches = fread(magic, 1, sizeof(magic), in) == sizeof(magic)
+                   && memcmp(magic, SITE_BINARY_MAGIC, sizeof(magic)) == 0;
+    fclose(in);
+    return matches;
+}
+
+
+void writeSiteBinary(const std::string &path, const std::vector<Vec2> &sites, bool singlePrecision) {
+    SiteBinaryHeader header {};
+    memcpy(header.magic, SITE_BINARY_MAGIC, sizeof(header.magic));
+    header.version = SITE_BINARY_VERSION;
+    header.numSites = sites.size();
+    if (singlePrecision) header.flags |= SITE_BINARY_FLOAT32;
+    for (size_t i = 0; i < sites.size(); i++) {
+        if (sites[i].identifier != static_cast<int>(i) + 1) {
+            header.flags |= SITE_BINARY_IDS;
+            break;
+        }
+    }
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (out == nullptr) throw std::runtime_error("Cannot open file for writing: " + path);
+
+    // Each array goes out in one write, from a buffer of its little-endian bytes
+    char headerBytes[SITE_BINARY_HEADER_SIZE];
+    encodeHeader(header, headerBytes);
+    bool ok = fwrite(headerBytes, SITE_BINARY_HEADER_SIZE, 1, out) == 1;
+    size_t coordinateSize = singlePrecision ? sizeof(float) : sizeof(double);
+    std::vector<char> bytes(sites.size() * coordinateSize);
+    for (int axis = 0; axis < 2 && ok; axis++) {
+        for (size_t i = 0; i < sites.size(); i++) {
+            double value = axis == 0 ? sites[i].x : sites[i].y;
+            if (singlePrecision) storeLittleEndian(bytes.data() + i * sizeof(float), static_cast<float>(value));
+            else storeLittleEndian(bytes.data() + i * sizeof(double), value);
+        }
+        ok = fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+    }
+    if (ok && (header.flags & SITE_BINARY_IDS)) {
+        bytes.resize(sites.size() * sizeof(int32_t));
+        for (size_t i = 0; i < sites.size(); i++) {
+            storeLittleEndian(bytes.data() + i * sizeof(int32_t), static_cast<int32_t>(sites[i].identifier));
+        }
+        ok = fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+    }
+
+    if (fclose(out) != 0 || !ok) throw std::runtime_error("Cannot write file: " + path);
+}
+
+
+int convertSitesToBinary(const std::string &textPath, const std::string &binaryPath, bool singlePrecision) {
+    std::vector<Vec2> sites = parseSites(textPath);
+    writeSiteBinary(binaryPath, sites, singlePrecision);
+    return static_cast<int>(sites.size());
+}
+
+
+static std::string temporaryPath() {
+    char path[] = "/tmp/voronoi-sites-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) throw std::runtime_error("Cannot create a temporary file");
+    close(fd);
+    return path;
+}
+
+
+void siteBinaryTest1() {
+    std::cout << "Testing binary site files, case 1" << std::endl;
+
+    std::string textPath = temporaryPath();
+    std::string binaryPath = temporaryPath();
+    FILE* text = fopen(textPath.c_str(), "w");
+    fprintf(text, "(0, 2) (2, 0) (-2, 0)\n(0, -2) (0.1, 0.3)\n");
+    fclose(text);
+
+    // Text to double precision keeps every coordinate, and the implicit numbering
+    assert(convertSitesToBinary(textPath, binaryPath) == 5);
+    assert(isSiteBinaryFile(binaryPath) && !isSiteBinaryFile(textPath));
+    std::vector<Vec2> parsed = parseSites(textPath);
+    {
+        MappedSites mapped(binaryPath);
+        assert(mapped.size() == 5 && !mapped.singlePrecision());
+        for (int i = 0; i < 5; i++) {
+            assert(mapped.x(i) == parsed[i].x && mapped.y(i) == parsed[i].y);
+            assert(mapped.identifier(i) == i + 1);
+        }
+
+        // The sweep comes out the same from either input
+        FortuneSweeper fromText(parsed);
+        FortuneSweeper fromBinary;
+        fromBinary.reset(mapped);
+        muteStdout();
+        DCEL* a = fromText.computeAll();
+        DCEL* b = fromBinary.computeAll();
+        unmuteStdout();
+        assert(a->numVertices() == b->numVertices() && a->numHalfEdges() == b->numHalfEdges());
+    }
+
+    // Explicit identifiers, in single precision
+    std::vector<Vec2> sites = {Vec2(0.1, -3, 7), Vec2(1e6, 2.5, 3), Vec2(-4, 1.0 / 3, 12)};
+    writeSiteBinary(binaryPath, sites, true);
+    {
+        MappedSites mapped(binaryPath);
+        assert(mapped.size() == 3 && mapped.singlePrecision());
+        for (int i = 0; i < 3; i++) {
+            assert(mapped.x(i) == static_cast<float>(sites[i].x) && mapped.y(i) == static_cast<float>(sites[i].y));
+            assert(mapped.identifier(i) == sites[i].identifier);
+        }
+    }
+
+    // The bytes on disk are little-endian, whatever the host
+    writeSiteBinary(binaryPath, {Vec2(1.5, -2, 1), Vec2(0, 0, 258)});
+    FILE* written = fopen(binaryPath.c_str(), "rb");
+    unsigned char bytes[SITE_BINARY_HEADER_SIZE + 40];
+    size_t numRead = fread(bytes, 1, sizeof(bytes), written);
+    assert(numRead == sizeof(bytes) && fgetc(written) == EOF);
+    fclose(written);
+    const unsigned char expected[][8] = {
+        {1, 0, 0, 0, SITE_BINARY_IDS, 0, 0, 0},
+        {2, 0, 0, 0, 0, 0, 0, 0},
+        {0, 0, 0, 0, 0, 0, 0xf8, 0x3f},
+        {0, 0, 0, 0, 0, 0, 0, 0},
+        {0, 0, 0, 0, 0, 0, 0, 0xc0},
+        {0, 0, 0, 0, 0, 0, 0, 0},
+        {1, 0, 0, 0, 2, 1, 0, 0},
+    };
+    assert(memcmp(bytes + 8, expected, sizeof(expected)) == 0);
+
+    // Sites the sweep can't handle are rejected: repeated or negative identifiers, and coordinates that aren't finite
+    std::vector<std::vector<Vec2>> invalid = {
+        {Vec2(0, 0, 4), Vec2(1, 1, 9), Vec2(2, 0, 4)},
+        {Vec2(0, 0, 4), Vec2(1, 1, -9)},
+        {Vec2(0, 0, 1), Vec2(NAN, 1, 2)},
+    };
+    for (const std::vector<Vec2> &bad: invalid) {
+        writeSiteBinary(binaryPath, bad);
+        try {
+            MappedSites mapped(binaryPath);
+            assert(false);
+        } catch (std::runtime_error &e) {}
+    }
+
+    // Truncated files are rejected
+    truncate(binaryPath.c_str(), SITE_BINARY_HEADER_SIZE + 4);
+    try {
+        MappedSites mapped(binaryPath);
+        assert(false);
+    } catch (std::runtime_error &e) {}
+
+    remove(textPath.c_str());
+    remove(binaryPath.c_str());
+}
+
+
+void siteBinaryBenchmark() {
+    std::cout << "Benchmarking binary site files against text" << std::endl;
+
+    const int numSites = 1000000;
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    std::vector<Vec2> sites;
+    sites.reserve(numSites);
+    for (int i = 0; i < numSites; i++) {
+        double x = coordinate(rng);
+        double y = coordinate(rng);
+        sites.emplace_back(x, y, i + 1);
+    }
+
+    std::string textPath = temporaryPath();
+    std::string doublePath = temporaryPath();
+    std::string floatPath = temporaryPath();
+    FILE* text = fopen(textPath.c_str(), "w");
+    for (const Vec2 &s: sites) fprintf(text, "%.17g %.17g\n", s.x, s.y);
+    fclose(text);
+    writeSiteBinary(doublePath, sites, false);
+    writeSiteBinary(floatPath, sites, true);
+
+    // Time from the path to sites the sweep can use, the mapped ones being read the way FortuneSweeper::reset does
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Vec2> parsed = parseSites(textPath);
+    double textMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(static_cast<int>(parsed.size()) == numSites);
+    printf("    %d sites, text:            %8.3f ms\n", numSites, textMs);
+
+    for (const std::string &path: {doublePath, floatPath}) {
+        start = std::chrono::steady_clock::now();
+        MappedSites mapped(path);
+        std::vector<Vec2> loaded;
+        loaded.reserve(mapped.size());
+        for (int i = 0; i < mapped.size(); i++) loaded.emplace_back(mapped.x(i), mapped.y(i), mapped.identifier(i));
+        double mappedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        assert(static_cast<int>(loaded.size()) == numSites);
+        printf("    %d sites, mapped %s: %8.3f ms (%.1fx faster)\n", numSites,
+               mapped.singlePrecision() ? "float32" : "float64", mappedMs, textMs / mappedMs);
+    }
+
+    remove(textPath.c_str());
+    remove(doublePath.c_str());
+    remove(floatPath.c_str());
+}
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include "utils/ThreadPool.hpp"
+
+ThreadPool::ThreadPool(int numThreads) {
+    // The calling thread always takes part in parallelFor, so spawn one less worker
+    for (int i = 1; i < numThreads; i++) workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto &w: workers) w.join();
+}
+
+int ThreadPool::size() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+int ThreadPool::defaultThreadCount() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : static_cast<int>(hardware);
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+int ThreadPool::numChunks(int n, int minChunk) const {
+    if (n <= 0) return 0;
+    minChunk = std::max(minChunk, 1);
+    return std::max(1, std::min(size(), n / minChunk));
+}
+
+void ThreadPool::parallelFor(int n, const std::function<void(int, int, int)> &fn, int minChunk) {
+    int chunks = numChunks(n, minChunk);
+    if (chunks == 0) return;
+    if (chunks == 1) {
+        fn(0, n, 0);
+        return;
+    }
+
+    // Spread the remainder over the first chunks, so that chunk sizes differ by at most one
+    int base = n / chunks;
+    int remainder = n % chunks;
+    auto chunkBegin = [&](int chunk) { return chunk * base + std::min(chunk, remainder); };
+
+    // A chunk that throws must not take the process down from a worker, nor leave the others running on this frame,
+    // so the first exception of any chunk is kept, and rethrown here once every chunk is done
+    std::mutex doneMutex;
+    std::condition_variable doneSignal;
+    int remaining = chunks - 1;
+    std::exception_ptr firstError;
+
+    int queued = 0;
+    try {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (; queued < chunks - 1; queued++) {
+            int chunk = queued + 1;
+            tasks.emplace([&, chunk]() {
+                std::exception_ptr error;
+                try {
+                    fn(chunkBegin(chunk), chunkBegin(chunk + 1), chunk);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> doneLock(doneMutex);
+                if (error && !firstError) firstError = error;
+                if (--remaining == 0) doneSignal.notify_one();
+            });
+        }
+    } catch (...) {
+        // Only the chunks that made it into the queue are waited for
+        std::lock_guard<std::mutex> doneLock(doneMutex);
+        remaining -= chunks - 1 - queued;
+        if (!firstError) firstError = std::current_exception();
+    }
+    taskAvailable.notify_all();
+
+    if (queued == chunks - 1) {
+        try {
+            fn(0, chunkBegin(1), 0);
+        } catch (...) {
+            std::lock_guard<std::mutex> doneLock(doneMutex);
+            if (!firstError) firstError = std::current_exception();
+        }
+    }
+
+    std::unique_lock<std::mutex> doneLock(doneMutex);
+    doneSignal.wait(doneLock, [&]() { return remaining == 0; });
+    if (firstError) std::rethrow_exception(firstError);
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+
+void threadPoolTest1() {
+    std::cout << "Testing ThreadPool, case 1" << std::endl;
+    ThreadPool pool(4);
+    assert(pool.size() == 4);
+
+    // Every index must be visited exactly once, by chunks that tile the range in order
+    for (int n: {0, 1, 3, 4, 5, 17, 1000}) {
+        std::vector<std::atomic<int>> visits(n);
+        std::vector<int> chunkStarts(pool.size(), -1);
+        pool.parallelFor(n, [&](int begin, int end, int chunk) {
+            chunkStarts[chunk] = begin;
+            for (int i = begin; i < end; i++) visits[i]++;
+        });
+        for (int i = 0; i < n; i++) assert(visits[i] == 1);
+        for (int c = 1; c < pool.numChunks(n); c++) assert(chunkStarts[c - 1] < chunkStarts[c]);
+    }
+
+    // A throw from a worker's chunk, or from the calling thread's, comes out of parallelFor, and only once every other
+    // chunk is done. The pool keeps working afterwards.
+    for (int failing: {2, 0}) {
+        std::vector<std::atomic<int>> visits(4000);
+        bool thrown = false;
+        try {
+            pool.parallelFor(4000, [&](int begin, int end, int chunk) {
+                if (chunk == failing) throw std::runtime_error("chunk failed");
+                for (int i = begin; i < end; i++) visits[i]++;
+            });
+        } catch (std::runtime_error &e) {
+            thrown = std::string(e.what()) == "chunk failed";
+        }
+        assert(thrown);
+        int visited = 0;
+        for (auto &v: visits) visited += v;
+        assert(visited == 3000);
+    }
+    std::atomic<int> sum {0};
+    pool.parallelFor(100, [&](int begin, int end, int) { for (int i = begin; i < end; i++) sum += i; });
+    assert(sum == 4950);
+}
+
+void threadPoolTest2() {
+    std::cout << "Testing ThreadPool, case 2" << std::endl;
+    ThreadPool pool(3);
+
+    std::vector<std::pair<int, int>> values;
+    for (int i = 0; i < 10007; i++) values.emplace_back((i * 7919) % 101, i);
+    std::vector<std::pair<int, int>> expected(values);
+    std::sort(expected.begin(), expected.end());
+
+    parallelSort(values.begin(), values.end(), std::less<>(), pool, 16);
+    assert(values == expected);
+}
@@ -2,6 +2,17 @@
 #include <iostream>
 #include <sstream>
 #include <cstring>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <chrono>
+#include <random>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "utils/files.hpp"
 
 const char* readFile(const std::string &filePath) {
@@ -20,27 +31,312 @@ const char* readFile(const std::string &filePath) {
     return resultCStr;
 }
 
-std::vector<Vec2> parseSites(const std::string &filepath) {
-    std::ifstream file(filepath);
 
-    if (!file.is_open()) {
-        std::cerr << "ERROR: Cannot open provided input file: " << filepath << std::endl;
-        exit(1);
+MappedFile::MappedFile(const std::string &path) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    std::stringstream ss(content);
+    length = static_cast<size_t>(info.st_size);
+    if (length == 0) return;
 
-    char ignored;
-    double x, y;
+    mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL);
+}
 
-    std::vector<Vec2> sites;
-    int id = 0;
-    while (ss >> ignored >> x >> ignored >> y >> ignored) {
-        sites.emplace_back(x, y, ++id);
+MappedFile::~MappedFile() {
+    if (mapping != nullptr) munmap(mapping, length);
+    if (fd >= 0) close(fd);
+}
+
+const char* MappedFile::data() const {
+    return static_cast<const char*>(mapping);
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+
+SiteParseError::SiteParseError(int line, const std::string &reason)
+    : std::runtime_error("line " + std::to_string(line) + ": " + reason), line(line), reason(reason) {}
+
+
+void parseSiteText(const char* begin, const char* end, std::vector<Vec2> &sites, int firstLine, bool allowHeader) {
+    int line = firstLine;
+    const char* p = begin;
+
+    // A first line starting with a letter is a CSV header
+    while (allowHeader && p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    if (allowHeader && p < end && std::isalpha(static_cast<unsigned char>(*p))) {
+        while (p < end && *p != '\n') p++;
+    } else {
+        p = begin;
     }
 
+    double coordinates[2];
+    int numCoordinates = 0;
+    bool inParentheses = false;
+
+    while (p < end) {
+        char c = *p;
+        switch (c) {
+            case '\n':
+                // Records never span lines, which lets large inputs be split at any line break
+                if (inParentheses) throw SiteParseError(line, "expected ')'");
+                if (numCoordinates != 0) throw SiteParseError(line, "expected two coordinates");
+                line++;
+                p++;
+                continue;
+            case ' ':
+            case '\t':
+            case '\r':
+            case ',':
+                p++;
+                continue;
+            case '(':
+                if (inParentheses || numCoordinates != 0) throw SiteParseError(line, "unexpected '('");
+                inParentheses = true;
+                p++;
+                continue;
+            case ')':
+                // The pair was already emitted when its second coordinate was read
+                if (!inParentheses || numCoordinates != 0) throw SiteParseError(line, "expected two coordinates");
+                inParentheses = false;
+                p++;
+                continue;
+            default:
+                break;
+        }
+
+        // from_chars doesn't take a leading plus sign
+        if (c == '+') p++;
+        double value;
+        auto [next, error] = std::from_chars(p, end, value);
+        if (error == std::errc::result_out_of_range) throw SiteParseError(line, "coordinate out of range");
+        if (error != std::errc() || next == p) {
+            throw SiteParseError(line, std::string("unexpected character '") + c + "'");
+        }
+        if (!std::isfinite(value)) throw SiteParseError(line, "coordinates must be finite");
+        p = next;
+
+        coordinates[numCoordinates++] = value;
+        if (numCoordinates == 2) {
+            sites.emplace_back(coordinates[0], coordinates[1], static_cast<int>(sites.size()) + 1);
+            numCoordinates = 0;
+            if (inParentheses) {
+                // Only the closing parenthesis may follow
+                while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+                if (p == end || *p != ')') throw SiteParseError(line, "expected ')'");
+            }
+        }
+    }
+
+    if (inParentheses) throw SiteParseError(line, "expected ')'");
+    if (numCoordinates != 0) throw SiteParseError(line, "expected two coordinates");
+}
+
+
+void parseSiteTextParallel(const char* begin, const char* end, std::vector<Vec2> &sites, ThreadPool &pool) {
+    size_t size = end - begin;
+    int numChunks = std::min(static_cast<int>(size / PARALLEL_PARSE_MIN_CHUNK_BYTES), pool.size());
+    if (numChunks <= 1) {
+        parseSiteText(begin, end, sites);
+        return;
+    }
+
+    // Cut the text into roughly equal chunks, moving every cut to just after a line break
+    std::vector<const char*> cuts(numChunks + 1);
+    cuts[0] = begin;
+    cuts[numChunks] = end;
+    for (int i = 1; i < numChunks; i++) {
+        const char* cut = std::max(begin + size / numChunks * i, cuts[i - 1]);
+        const char* lineBreak = static_cast<const char*>(memchr(cut, '\n', end - cut));
+        cuts[i] = lineBreak == nullptr ? end : lineBreak + 1;
+    }
+
+    // Chunks are parsed with line numbers relative to their start, and errors are rebased once the lines of the
+    // chunks before them have been counted
+    struct ChunkOutput {
+        std::vector<Vec2> sites;
+        int errorLine = 0;
+        std::string errorReason;
+    };
+    std::vector<ChunkOutput> chunks(numChunks);
+
+    pool.parallelFor(numChunks, [&](int chunkBegin, int chunkEnd, int) {
+        for (int c = chunkBegin; c < chunkEnd; c++) {
+            ChunkOutput &out = chunks[c];
+
+            // Most records take at least 16 bytes, e.g. "(0.25, -1.5)\n"
+            out.sites.reserve((cuts[c + 1] - cuts[c]) / 16);
+            try {
+                parseSiteText(cuts[c], cuts[c + 1], out.sites, 1, c == 0);
+            } catch (SiteParseError &e) {
+                out.errorLine = e.line;
+                out.errorReason = e.reason;
+            }
+        }
+    });
+
+    // Concatenate in file order, renumbering the sites to continue the sequence of the chunks before them
+    size_t total = sites.size();
+    for (int c = 0; c < numChunks; c++) {
+        if (chunks[c].errorLine > 0) {
+            int line = chunks[c].errorLine;
+            for (const char* p = begin; p < cuts[c]; p++) line += *p == '\n';
+            throw SiteParseError(line, chunks[c].errorReason);
+        }
+        total += chunks[c].sites.size();
+    }
+
+    sites.reserve(total);
+    for (ChunkOutput &out: chunks) {
+        int offset = static_cast<int>(sites.size());
+        for (Vec2 &site: out.sites) site.identifier += offset;
+        sites.insert(sites.end(), out.sites.begin(), out.sites.end());
+        std::vector<Vec2>().swap(out.sites);
+    }
+}
+
+
+std::vector<Vec2> parseSites(const std::string &filepath, ThreadPool &pool) {
+    MappedFile file(filepath);
+    std::vector<Vec2> sites;
+    parseSiteTextParallel(file.data(), file.data() + file.size(), sites, pool);
     return sites;
 }
+
+
+void siteParserTest1() {
+    std::cout << "Testing site parser, case 1" << std::endl;
+
+    auto parse = [](const std::string &text) {
+        std::vector<Vec2> sites;
+        parseSiteText(text.data(), text.data() + text.size(), sites);
+        return sites;
+    };
+
+    // All three formats give the same sites, numbered in order
+    std::vector<std::string> formats = {
+        "(1, 2) (3.5, -4)\n(+5e-1, 6)\n",
+        "1 2\n3.5 -4\r\n0.5 6",
+        "x,y\n1,2\n3.5,-4\n\n0.5,6\n",
+    };
+    for (const std::string &text: formats) {
+        std::vector<Vec2> sites = parse(text);
+        assert(sites.size() == 3);
+        assert(sites[0].x == 1 && sites[0].y == 2 && sites[0].identifier == 1);
+        assert(sites[1].x == 3.5 && sites[1].y == -4 && sites[1].identifier == 2);
+        assert(sites[2].x == 0.5 && sites[2].y == 6 && sites[2].identifier == 3);
+    }
+
+    // Errors carry the line they were found on
+    std::vector<std::pair<std::string, int>> malformed = {
+        {"(1, 2)\n(3, 4\n", 2},
+        {"1 2\n3\n5 6\n", 2},
+        {"1 2\n3 4\n5 abc\n", 3},
+        {"(1, 2, 3)", 1},
+        {"1 2\n\n\n(1, 2) 1e999 0", 4},
+        {"(1,\n2)", 1},
+    };
+    for (auto &[text, line]: malformed) {
+        try {
+            parse(text);
+            assert(false);
+        } catch (SiteParseError &e) {
+            assert(e.line == line);
+        }
+    }
+}
+
+
+void siteParserTest2() {
+    std::cout << "Testing site parser, case 2" << std::endl;
+
+    // A few megabytes of mixed formats, enough for several chunks
+    std::string text = "x,y\n";
+    for (int i = 0; i < 300000; i++) {
+        if (i % 3 == 0) text += "(" + std::to_string(i) + ", " + std::to_string(-i) + ") (0.5, 1)\n";
+        else if (i % 3 == 1) text += std::to_string(i) + " 2.25\n";
+        else text += std::to_string(i) + ",-7\n";
+    }
+
+    std::vector<Vec2> sequential;
+    parseSiteText(text.data(), text.data() + text.size(), sequential);
+
+    ThreadPool pool(4);
+    std::vector<Vec2> parallel;
+    parseSiteTextParallel(text.data(), text.data() + text.size(), parallel, pool);
+    assert(parallel.size() == sequential.size());
+    for (size_t i = 0; i < parallel.size(); i++) {
+        assert(parallel[i].x == sequential[i].x && parallel[i].y == sequential[i].y);
+        assert(parallel[i].identifier == static_cast<int>(i) + 1);
+    }
+
+    // Errors deep into the text still report the absolute line
+    text += "1 2 3\n";
+    try {
+        parallel.clear();
+        parseSiteTextParallel(text.data(), text.data() + text.size(), parallel, pool);
+        assert(false);
+    } catch (SiteParseError &e) {
+        assert(e.line == 300002);
+    }
+}
+
+
+void siteParserBenchmark() {
+    std::cout << "Benchmarking the site parser" << std::endl;
+
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    std::string text;
+    const int numSites = 1000000;
+    char pair[96];
+    for (int i = 0; i < numSites; i++) {
+        double x = coordinate(rng);
+        double y = coordinate(rng);
+        int length = snprintf(pair, sizeof(pair), "(%.17g, %.17g)\n", x, y);
+        text.append(pair, length);
+    }
+    double megabytes = static_cast<double>(text.size()) / (1 << 20);
+
+    // The stream extraction the parser used to do
+    auto start = std::chrono::steady_clock::now();
+    std::stringstream ss(text);
+    char ignored;
+    double x, y;
+    std::vector<Vec2> streamed;
+    int id = 0;
+    while (ss >> ignored >> x >> ignored >> y >> ignored) streamed.emplace_back(x, y, ++id);
+    double streamMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Vec2> parsed;
+    parseSiteText(text.data(), text.data() + text.size(), parsed);
+    double parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(parsed.size() == streamed.size());
+
+    printf("    %d sites, %.1f MB: stringstream %8.3f ms (%6.1f MB/s), from_chars %8.3f ms (%6.1f MB/s)\n",
+           numSites, megabytes, streamMs, megabytes / streamMs * 1000, parseMs, megabytes / parseMs * 1000);
+
+    ThreadPool &pool = ThreadPool::shared();
+    start = std::chrono::steady_clock::now();
+    parsed.clear();
+    parseSiteTextParallel(text.data(), text.data() + text.size(), parsed, pool);
+    double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(parsed.size() == streamed.size() && parsed.back().identifier == numSites);
+
+    printf("    %d sites, %.1f MB: chunked over %d thread(s) %8.3f ms (%6.1f MB/s)\n",
+           numSites, megabytes, pool.size(), parallelMs, megabytes / parallelMs * 1000);
+}
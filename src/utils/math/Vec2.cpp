@@ -1,4 +1,5 @@
 #include <cmath>
+#include <cstdio>
 #include <string>
 #include "utils/math/Vec2.hpp"
 
@@ -39,11 +40,15 @@ Vec2 Vec2::normalized() const {
 }
 
 const char* Vec2::toString() const {
-    char* result = new char[64];  // %d can only be <11 bytes
+    // A ring of buffers, so that a few strings can go into one printf, and none of them has to be freed
+    static thread_local char buffers[VEC2_STRING_BUFFERS][VEC2_STRING_SIZE];
+    static thread_local int next = 0;
+    char* result = buffers[next];
+    next = (next + 1) % VEC2_STRING_BUFFERS;
 
 //    if (identifier == VEC2_NO_IDENTIFIER) sprintf(result, "(%f, %f)", x, y);
 //    else sprintf(result, "%d=(%f, %f)", identifier, x, y);
-    sprintf(result, "(%f, %f)", x, y);
+    snprintf(result, VEC2_STRING_SIZE, "(%f, %f)", x, y);
 
     return result;
 }
@@ -1,5 +1,8 @@
 #include <cmath>
 #include <cassert>
+#include <algorithm>
+#include <climits>
+#include <tuple>
 #include "utils/math/mathematics.hpp"
 #include "fortune/Fortune.hpp"
 
@@ -29,14 +32,14 @@ double pointDirectrixParabola(double x, Vec2 focus, double directrix) {
     return result;
 }
 
-double pointDirectrixGradient(double x, Vec2 focus, double directrix) {
-    double dy = x - focus.x;
-    double dx = focus.y - directrix;
+// Direction of the tangent of the parabola at x, pointing towards +x (or straight up if the tangent is vertical)
+Vec2 pointDirectrixTangent(double x, Vec2 focus, double directrix) {
+    double rise = x - focus.x;
+    double run = focus.y - directrix;
 
-    assert(dx != 0 || dy != 0);
+    assert(run != 0 || rise != 0);
 
-    if (dx == 0) return DOUBLE_INFINITY;
-    else return dy / dx;
+    return rightwardDirection(run, rise);
 }
 
 double pointDirectrixIntersectionX(const Vec2 &leftParabolaFocus, const Vec2 &rightParabolaFocus, double directrix) {
@@ -64,14 +67,79 @@ Vec2 pointDirectrixIntersectionPos(const Vec2 &leftParabolaFocus, const Vec2 &ri
     return {x, leftValue};
 }
 
-double perpendicularBisectorSlope(const Vec2 &leftSite, const Vec2 &rightSite) {
-    double dy = rightSite.x - leftSite.x;
-    double dx = leftSite.y - rightSite.y;
+// Direction of the perpendicular bisector of the two sites, pointing towards +x (or straight up if it is vertical)
+Vec2 perpendicularBisectorDirection(const Vec2 &leftSite, const Vec2 &rightSite) {
+    double rise = rightSite.x - leftSite.x;
+    double run = leftSite.y - rightSite.y;
 
-    assert(dx != 0 || dy != 0);
+    assert(run != 0 || rise != 0);
 
-    if (dx == 0) return DOUBLE_INFINITY;
-    else return dy / dx;
+    return rightwardDirection(run, rise);
+}
+
+// Unnormalized direction of a line with the given run and rise, covering the same half-plane as atan(rise / run),
+// that is, pointing towards +x, or straight up when the line is vertical
+Vec2 rightwardDirection(double run, double rise) {
+    if (run == 0) return {0, 1};
+    if (run < 0) return {-run, -rise};
+    return {run, rise};
+}
+
+// Monotonic stand-in for atan2(direction.y, direction.x), ranging over (-2, 2] instead of (-pi, pi]
+double pseudoAngle(const Vec2 &direction) {
+    double manhattan = std::abs(direction.x) + std::abs(direction.y);
+    if (manhattan == 0) return 0;
+
+    double p = direction.x / manhattan;
+    return direction.y < 0 ? p - 1 : 1 - p;
+}
+
+// Whether every point lies within NUMERICAL_TOLERANCE of a single line, in one pass after the line is fixed
+bool allColinear(const std::vector<Vec2> &points) {
+    if (points.size() < 3) return true;
+
+    // The point furthest from the first one fixes the line, which keeps its direction well conditioned
+    const Vec2 &origin = points[0];
+    size_t furthest = 0;
+    double furthestDistance = 0;
+    for (size_t i = 1; i < points.size(); i++) {
+        double distance = sq(points[i].x - origin.x) + sq(points[i].y - origin.y);
+        if (distance > furthestDistance) {
+            furthest = i;
+            furthestDistance = distance;
+        }
+    }
+    if (furthestDistance == 0) return true;
+
+    Vec2 direction = points[furthest] - origin;
+    double length = sqrt(furthestDistance);
+    for (const Vec2 &p: points) {
+        if (std::abs(direction.cross(p - origin)) > NUMERICAL_TOLERANCE * length) return false;
+    }
+    return true;
+}
+
+std::pair<int, int> findCoincidentPoints(const std::vector<Vec2> &points) {
+    // Points by column of NUMERICAL_TOLERANCE width, then by y. The points softEquals to one are in its own column or
+    // the next, less than the tolerance away in y, so two short runs of the order hold them all.
+    std::vector<std::tuple<double, double, int>> order;
+    order.reserve(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        order.emplace_back(std::floor(points[i].x / NUMERICAL_TOLERANCE), points[i].y, static_cast<int>(i));
+    }
+    std::sort(order.begin(), order.end());
+
+    for (const auto &[column, y, i]: order) {
+        for (double other: {column, column + 1}) {
+            auto first = std::make_tuple(other, y - NUMERICAL_TOLERANCE, INT_MIN);
+            auto j = std::lower_bound(order.begin(), order.end(), first);
+            for (; j != order.end() && std::get<0>(*j) == other && std::get<1>(*j) < y + NUMERICAL_TOLERANCE; ++j) {
+                int k = std::get<2>(*j);
+                if (k != i && softEquals(points[i], points[k])) return {std::min(i, k), std::max(i, k)};
+            }
+        }
+    }
+    return {-1, -1};
 }
 
 bool softEquals(double x, double y, double tolerance) {
@@ -111,66 +179,30 @@ std::array<float, 16> orthographicProjection(
     return mat;
 }
 
-Vec2 rayIntersectBox(Vec2 pos, double angle, Vec2 bottomLeft, Vec2 topRight) {
-    double cosTheta = cos(angle);
-    double sinTheta = sin(angle);
-
-    std::vector<Vec2> intersections = {};
-
-    // Check vertical boundaries
-    if (cosTheta != 0) {
-        double t1 = (bottomLeft.x - pos.x) / cosTheta;
-        double y1 = pos.y + t1 * sinTheta;
-        if (t1 >= 0 && y1 >= bottomLeft.y && y1 <= topRight.y) {
-            intersections.emplace_back(bottomLeft.x, y1);
-        }
-
-        double t2 = (topRight.x - pos.x) / cosTheta;
-        double y2 = pos.y + t2 * sinTheta;
-        if (t2 >= 0 && y2 >= bottomLeft.y && y2 <= topRight.y) {
-            intersections.emplace_back(topRight.x, y2);
-        }
-    }
-
-    // Check horizontal boundaries
-    if (sinTheta != 0) {
-        double t3 = (bottomLeft.y - pos.y) / sinTheta;
-        double x3 = pos.x + t3 * cosTheta;
-        if (t3 >= 0 && x3 >= bottomLeft.x && x3 <= topRight.x) {
-            intersections.emplace_back(x3, bottomLeft.y);
-        }
+// Liang-Barsky clipping of a batch of rays against the box. Every ray must start inside the box, so that the entry
+// parameter is always 0, and only the exit parameter needs to be found. The coordinate of the side being hit is
+// copied exactly, so that the exit point lies on the box.
+void clipRaysToBox(
+    const std::vector<Vec2> &origins,
+    const std::vector<Vec2> &directions,
+    Vec2 bottomLeft,
+    Vec2 topRight,
+    std::vector<Vec2> &exits
+) {
+    assert(origins.size() == directions.size());
+    exits.resize(origins.size(), Vec2(0, 0));
 
-        double t4 = (topRight.y - pos.y) / sinTheta;
-        double x4 = pos.x + t4 * cosTheta;
-        if (t4 >= 0 && x4 >= bottomLeft.x && x4 <= topRight.x) {
-            intersections.emplace_back(x4, topRight.y);
-        }
-    }
+    for (size_t i = 0; i < origins.size(); i++) {
+        const Vec2 &o = origins[i];
+        const Vec2 &d = directions[i];
+        assert(d.x != 0 || d.y != 0);
 
-    // Find the closest intersection point
-    Vec2 closest = intersections[0];
-    double minT = std::hypot(intersections[0].x - pos.x, intersections[0].y - pos.y);
+        double boundX = d.x > 0 ? topRight.x : bottomLeft.x;
+        double boundY = d.y > 0 ? topRight.y : bottomLeft.y;
+        double tx = d.x != 0 ? (boundX - o.x) / d.x : DOUBLE_INFINITY;
+        double ty = d.y != 0 ? (boundY - o.y) / d.y : DOUBLE_INFINITY;
 
-    for (Vec2 &interxn : intersections) {
-        double dist = std::hypot(interxn.x - pos.x, interxn.y - pos.y);
-        if (dist < minT) {
-            closest = interxn;
-            minT = dist;
-        }
+        if (tx <= ty) exits[i] = Vec2(boundX, o.y + tx * d.y);
+        else exits[i] = Vec2(o.x + ty * d.x, boundY);
     }
-
-    return closest;
-}
-
-double normalizeRadians(double angle) {
-    angle = fmod(angle + M_PI, 2 * M_PI);
-    if (angle <= 0) angle += 2 * M_PI;
-    return angle - M_PI;
 }
-
-double addRadians(double angle1, double angle2) {
-    double sum = angle1 + angle2;
-    return normalizeRadians(sum);
-}
-
-